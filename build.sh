@@ -10,6 +10,7 @@ PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 BUILD_PRESET="linux-rel"
 RUN_AFTER_BUILD=0
 RUN_ARG_VIDEO=""
+RUN_EXTRA_ARGS=()
 DO_CLEAN=0
 JOBS="${JOBS:-$(nproc || echo 4)}"
 
@@ -23,12 +24,14 @@ Options:
   -r, --run <file|uri>  Run the player after build using the provided video file or URI
   -j, --jobs <N>        Number of parallel build jobs (default: number of cores)
   -h, --help            Show this help message
+  -- <player args>      Extra arguments passed to the player with --run (e.g. --audio-only)
 
 Examples:
   $0 --clean --preset linux-rel
   $0 --preset linux-rel
   $0 --preset linux-rel --run /absolute/path/video.mp4
   $0 --preset win-rel -j 12
+  $0 --preset linux-rel --run /absolute/path/audio.mp4 -- --audio-only
 EOF
 }
 
@@ -43,6 +46,7 @@ while [[ $# -gt 0 ]]; do
     -r|--run)    RUN_AFTER_BUILD=1; RUN_ARG_VIDEO="${2:-}"; shift 2;;
     -j|--jobs)   JOBS="${2:-}"; shift 2;;
     -h|--help)   usage; exit 0;;
+    --)          shift; RUN_EXTRA_ARGS=("$@"); break;;
     *) err "Unknown option: $1"; usage; exit 2;;
   esac
 done
@@ -93,5 +97,5 @@ if [[ $RUN_AFTER_BUILD -eq 1 ]]; then
   export GST_PLUGIN_FEATURE_RANK="${GST_PLUGIN_FEATURE_RANK:-vaapidecodebin:0,vaapih264dec:0}"
 
   log "Launching player with: ${RUN_ARG_VIDEO}"
-  exec "${BIN}" "${RUN_ARG_VIDEO}"
+  exec "${BIN}" ${RUN_EXTRA_ARGS[@]+"${RUN_EXTRA_ARGS[@]}"} "${RUN_ARG_VIDEO}"
 fi
@@ -0,0 +1,231 @@
+// File: src/alloc_tracer.cpp
+#include "alloc_tracer.h"
+
+#include <algorithm>
+
+struct AllocTracerObject {
+  GstTracer parent;
+};
+
+struct AllocTracerObjectClass {
+  GstTracerClass parent_class;
+};
+
+G_DEFINE_TYPE(AllocTracerObject, alloc_tracer_object, GST_TYPE_TRACER)
+
+namespace {
+
+// Elements whose chain/getrange is running on this thread, innermost last;
+// nullptr entries stand for pushes into proxy pads (ghost pads of bins)
+thread_local std::vector<GstElement*> t_running;
+
+GQuark seenQuark() {
+  static const GQuark quark = g_quark_from_static_string("alloc-tracer-seen");
+  return quark;
+}
+
+// Element serving pad's peer (the one about to run), nullptr for proxies
+GstElement* peerElement(GstPad* pad) {
+  GstPad* peer = GST_PAD_PEER(pad);
+  if (!peer) return nullptr;
+  GstObject* parent = GST_OBJECT_PARENT(peer);
+  return parent && GST_IS_ELEMENT(parent) ? GST_ELEMENT_CAST(parent) : nullptr;
+}
+
+void onPushPre(GObject*, GstClockTime, GstPad* pad, GstBuffer* buffer) {
+#if GST_CHECK_VERSION(1, 22, 0)
+  GstObject* parent = GST_OBJECT_PARENT(pad);
+  if (buffer && buffer->pool && parent && GST_IS_ELEMENT(parent)) {
+    AllocTracer::instance().poolBufferPushed(GST_ELEMENT_CAST(parent), buffer);
+  }
+#else
+  (void)buffer;
+#endif
+  AllocTracer::instance().pushed(peerElement(pad));
+}
+
+void onPushListPre(GObject*, GstClockTime, GstPad* pad, GstBufferList*) {
+  AllocTracer::instance().pushed(peerElement(pad));
+}
+
+void onPushPost(GObject*, GstClockTime, GstPad*, GstFlowReturn) {
+  AllocTracer::instance().popped();
+}
+
+void onPullPre(GObject*, GstClockTime, GstPad* pad, guint64, guint) {
+  AllocTracer::instance().pushed(peerElement(pad));
+}
+
+void onPullPost(GObject*, GstClockTime, GstPad*, GstBuffer*, GstFlowReturn) {
+  AllocTracer::instance().popped();
+}
+
+void onObjectCreated(GObject*, GstClockTime, GstMiniObject* object) {
+  if (GST_IS_BUFFER(object)) {
+    AllocTracer::instance().bufferCreated();
+#if !GST_CHECK_VERSION(1, 20, 0)
+  } else if (GST_MINI_OBJECT_TYPE(object) == GST_TYPE_MEMORY) {
+    AllocTracer::instance().memoryCreated(GST_MEMORY_CAST(object), false);
+#endif
+  }
+}
+
+void onObjectDestroyed(GObject*, GstClockTime, GstMiniObject* object) {
+  if (GST_IS_BUFFER(object)) {
+    AllocTracer::instance().bufferFreed();
+  } else if (GST_MINI_OBJECT_TYPE(object) == GST_TYPE_MEMORY) {
+    AllocTracer::instance().memoryFreed(GST_MEMORY_CAST(object));
+  }
+}
+
+#if GST_CHECK_VERSION(1, 20, 0)
+void onMemoryInit(GObject*, GstClockTime, GstMemory* mem) {
+  AllocTracer::instance().memoryCreated(mem, true);
+}
+#endif
+
+#if GST_CHECK_VERSION(1, 22, 0)
+void onPoolDequeued(GObject*, GstClockTime, GstBufferPool*, GstBuffer* buffer) {
+  AllocTracer::instance().poolDequeued(buffer);
+}
+
+void onPoolQueued(GObject*, GstClockTime, GstBufferPool*, GstBuffer*) {
+  AllocTracer::instance().poolQueued();
+}
+#endif
+
+}  // namespace
+
+static void alloc_tracer_object_class_init(AllocTracerObjectClass*) {}
+
+static void alloc_tracer_object_init(AllocTracerObject* self) {
+  GstTracer* tracer = GST_TRACER(self);
+  gst_tracing_register_hook(tracer, "pad-push-pre", G_CALLBACK(onPushPre));
+  gst_tracing_register_hook(tracer, "pad-push-post", G_CALLBACK(onPushPost));
+  gst_tracing_register_hook(tracer, "pad-push-list-pre", G_CALLBACK(onPushListPre));
+  gst_tracing_register_hook(tracer, "pad-push-list-post", G_CALLBACK(onPushPost));
+  gst_tracing_register_hook(tracer, "pad-pull-range-pre", G_CALLBACK(onPullPre));
+  gst_tracing_register_hook(tracer, "pad-pull-range-post", G_CALLBACK(onPullPost));
+  gst_tracing_register_hook(tracer, "mini-object-created", G_CALLBACK(onObjectCreated));
+  gst_tracing_register_hook(tracer, "mini-object-destroyed", G_CALLBACK(onObjectDestroyed));
+#if GST_CHECK_VERSION(1, 20, 0)
+  gst_tracing_register_hook(tracer, "memory-init", G_CALLBACK(onMemoryInit));
+#endif
+#if GST_CHECK_VERSION(1, 22, 0)
+  gst_tracing_register_hook(tracer, "pool-buffer-dequeued", G_CALLBACK(onPoolDequeued));
+  gst_tracing_register_hook(tracer, "pool-buffer-queued", G_CALLBACK(onPoolQueued));
+#endif
+}
+
+AllocTracer& AllocTracer::instance() {
+  static AllocTracer tracer;
+  return tracer;
+}
+
+void AllocTracer::install() {
+  if (tracer_) return;
+  // The hooks hold their own references; ours only marks installation
+  tracer_ = GST_OBJECT(g_object_new(alloc_tracer_object_get_type(), nullptr));
+  gst_object_ref_sink(tracer_);
+}
+
+void AllocTracer::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  elements_.clear();
+  for (auto* c : {&totals_.buffersCreated, &totals_.buffersFreed, &totals_.memoriesCreated,
+                  &totals_.memoriesFreed, &totals_.bytesFreed, &totals_.poolReleases, &totals_.unattributed,
+                  &totals_.unattributedPoolHits}) {
+    *c = 0;
+  }
+}
+
+std::vector<std::pair<std::string, ElementAllocStats>> AllocTracer::perElement() const {
+  std::vector<std::pair<std::string, ElementAllocStats>> out;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.assign(elements_.begin(), elements_.end());
+  }
+  std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+    if (a.second.freshBytes != b.second.freshBytes) return a.second.freshBytes > b.second.freshBytes;
+    return a.second.buffers > b.second.buffers;
+  });
+  return out;
+}
+
+GstElement* AllocTracer::current() {
+  for (auto it = t_running.rbegin(); it != t_running.rend(); ++it) {
+    if (*it) return *it;
+  }
+  return nullptr;
+}
+
+template <typename F>
+void AllocTracer::update(GstElement* element, F&& f) {
+  if (!element) {
+    totals_.unattributed++;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  f(elements_[GST_ELEMENT_NAME(element)]);
+}
+
+void AllocTracer::pushed(GstElement* element) {
+  t_running.push_back(element);
+}
+
+void AllocTracer::popped() {
+  // Hooks installed mid-push see the post without its pre
+  if (!t_running.empty()) t_running.pop_back();
+}
+
+void AllocTracer::bufferCreated() {
+  totals_.buffersCreated++;
+  update(current(), [](ElementAllocStats& s) { s.buffers++; });
+}
+
+void AllocTracer::bufferFreed() {
+  totals_.buffersFreed++;
+}
+
+void AllocTracer::memoryCreated(GstMemory* mem, bool sized) {
+  totals_.memoriesCreated++;
+  const bool share = sized && mem->parent;
+  const uint64_t bytes = sized && !share ? mem->maxsize : 0;
+  update(current(), [share, bytes](ElementAllocStats& s) {
+    if (share) {
+      s.shares++;
+    } else {
+      s.memories++;
+      s.freshBytes += bytes;
+    }
+  });
+}
+
+void AllocTracer::memoryFreed(GstMemory* mem) {
+  totals_.memoriesFreed++;
+  if (!mem->parent) totals_.bytesFreed += mem->maxsize;
+}
+
+void AllocTracer::poolDequeued(GstBuffer* buffer) {
+  gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(buffer), seenQuark(), GINT_TO_POINTER(1), nullptr);
+  // A reuse, not an allocation: kept out of the unattributed allocation count
+  GstElement* element = current();
+  if (!element) {
+    totals_.unattributedPoolHits++;
+    return;
+  }
+  update(element, [](ElementAllocStats& s) { s.poolHits++; });
+}
+
+void AllocTracer::poolQueued() {
+  totals_.poolReleases++;
+}
+
+// A pool buffer pushed without ever having been on the pool's free list was
+// allocated by the acquire of the element pushing it
+void AllocTracer::poolBufferPushed(GstElement* pusher, GstBuffer* buffer) {
+  GstMiniObject* obj = GST_MINI_OBJECT_CAST(buffer);
+  if (gst_mini_object_get_qdata(obj, seenQuark())) return;
+  gst_mini_object_set_qdata(obj, seenQuark(), GINT_TO_POINTER(1), nullptr);
+  update(pusher, [](ElementAllocStats& s) { s.poolMisses++; });
+}
@@ -0,0 +1,80 @@
+// File: src/alloc_tracer.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+// What one element did to memory while its chain (or getrange) function ran
+struct ElementAllocStats {
+  uint64_t buffers{0};       // GstBuffers created
+  uint64_t memories{0};      // fresh GstMemory blocks (not shares)
+  uint64_t freshBytes{0};    // their size: allocations and the copies filling them
+  uint64_t shares{0};        // sub-memories sharing an existing block
+  uint64_t poolHits{0};      // buffers taken from a pool's free list
+  uint64_t poolMisses{0};    // pool buffers allocated on demand
+};
+
+struct AllocTotals {
+  std::atomic<uint64_t> buffersCreated{0};
+  std::atomic<uint64_t> buffersFreed{0};
+  std::atomic<uint64_t> memoriesCreated{0};
+  std::atomic<uint64_t> memoriesFreed{0};
+  std::atomic<uint64_t> bytesFreed{0};
+  std::atomic<uint64_t> poolReleases{0};
+  std::atomic<uint64_t> unattributed{0};   // allocations outside any element's push/pull
+  std::atomic<uint64_t> unattributedPoolHits{0};   // pool reuse outside any push/pull
+};
+
+// Process-wide allocation tracer built on GStreamer's tracing hooks
+// (mini-object lifecycle, memory-init, pool-buffer-queued/dequeued and the
+// pad push/pull hooks for attribution). Work is attributed to the element
+// whose sink (or pulled src) pad is currently being served on the calling
+// thread. Installing adds a cost to every buffer, so it is opt-in. Memory
+// byte counts need GStreamer 1.20, pool hit/miss counts 1.22; older
+// versions report the buffer and memory counts only.
+class AllocTracer {
+public:
+  static AllocTracer& instance();
+
+  AllocTracer(const AllocTracer&) = delete;
+  AllocTracer& operator=(const AllocTracer&) = delete;
+
+  // After gst_init(); idempotent. Hooks stay installed for the process lifetime.
+  void install();
+  bool installed() const { return tracer_ != nullptr; }
+
+  // Starts a new measurement window (per play session)
+  void reset();
+  const AllocTotals& totals() const { return totals_; }
+  // Elements sorted by fresh bytes, then buffers created
+  std::vector<std::pair<std::string, ElementAllocStats>> perElement() const;
+
+  // Hook entry points
+  void pushed(GstElement* element);
+  void popped();
+  void bufferCreated();
+  void bufferFreed();
+  void memoryCreated(GstMemory* mem, bool sized);
+  void memoryFreed(GstMemory* mem);
+  void poolDequeued(GstBuffer* buffer);
+  void poolQueued();
+  void poolBufferPushed(GstElement* pusher, GstBuffer* buffer);
+
+private:
+  AllocTracer() = default;
+
+  // Current element on this thread, nullptr outside any push/pull
+  static GstElement* current();
+  template <typename F> void update(GstElement* element, F&& f);
+
+  GstObject* tracer_{nullptr};
+  AllocTotals totals_;
+  mutable std::mutex mutex_;
+  std::map<std::string, ElementAllocStats> elements_;
+};
@@ -0,0 +1,190 @@
+// File: src/control_socket.cpp
+#include "control_socket.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define CONTROL_SOCKET_UNIX 1
+#endif
+
+namespace {
+
+constexpr size_t kMaxLine = 64 * 1024;
+constexpr int kSendTimeoutMs = 1000;
+
+#ifdef CONTROL_SOCKET_UNIX
+bool setNonBlocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 &&
+         fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+// True when nobody is accepting on the socket at path
+bool isStaleSocket(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode)) return false;
+  const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (probe < 0) return false;
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  const bool live = connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  ::close(probe);
+  return !live;
+}
+#endif
+
+}  // namespace
+
+ControlSocket::~ControlSocket() {
+  close();
+}
+
+bool ControlSocket::listen(const std::string& path, std::string& error) {
+  close();
+#ifdef CONTROL_SOCKET_UNIX
+  sockaddr_un addr{};
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    error = "socket path is empty or too long";
+    return false;
+  }
+  if (isStaleSocket(path)) unlink(path.c_str());
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    error = std::strerror(errno);
+    return false;
+  }
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  // Owner-only from the start: no window where others could connect
+  const mode_t oldMask = umask(0077);
+  const bool bound = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  umask(oldMask);
+  if (!bound || ::listen(fd, 16) != 0 || !setNonBlocking(fd)) {
+    error = std::strerror(errno);
+    ::close(fd);
+    if (bound) unlink(path.c_str());
+    return false;
+  }
+  listenFd_ = fd;
+  path_ = path;
+  return true;
+#else
+  (void)path;
+  error = "control sockets need a Unix platform";
+  return false;
+#endif
+}
+
+void ControlSocket::close() {
+#ifdef CONTROL_SOCKET_UNIX
+  for (auto& kv : partial_) ::close(kv.first);
+  partial_.clear();
+  if (listenFd_ >= 0) {
+    ::close(listenFd_);
+    unlink(path_.c_str());
+  }
+#endif
+  listenFd_ = -1;
+  path_.clear();
+}
+
+int ControlSocket::acceptClient() {
+#ifdef CONTROL_SOCKET_UNIX
+  if (listenFd_ < 0) return -1;
+  const int fd = accept(listenFd_, nullptr, nullptr);
+  if (fd < 0) return -1;
+  if (!setNonBlocking(fd)) {
+    ::close(fd);
+    return -1;
+  }
+#ifdef SO_NOSIGPIPE
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+  partial_[fd];
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+bool ControlSocket::readLines(int client, std::vector<std::string>& lines) {
+#ifdef CONTROL_SOCKET_UNIX
+  auto it = partial_.find(client);
+  if (it == partial_.end()) return false;
+  std::string& buf = it->second;
+  char chunk[4096];
+  while (true) {
+    const ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+    if (n > 0) {
+      buf.append(chunk, size_t(n));
+      size_t start = 0;
+      for (size_t nl; (nl = buf.find('\n', start)) != std::string::npos; start = nl + 1) {
+        std::string line = buf.substr(start, nl - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) {
+          lines.push_back(std::move(line));
+          linesRead_++;
+        }
+      }
+      buf.erase(0, start);
+      if (buf.size() > kMaxLine) return false;
+      continue;
+    }
+    if (n == 0) return false;
+    if (errno == EINTR) continue;
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+#else
+  (void)client;
+  (void)lines;
+  return false;
+#endif
+}
+
+bool ControlSocket::sendLine(int client, const std::string& line) {
+#ifdef CONTROL_SOCKET_UNIX
+  if (!partial_.count(client)) return false;
+  const std::string out = line + '\n';
+  size_t sent = 0;
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while (sent < out.size()) {
+    const ssize_t n = send(client, out.data() + sent, out.size() - sent, flags);
+    if (n > 0) {
+      sent += size_t(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      pollfd p{client, POLLOUT, 0};
+      if (poll(&p, 1, kSendTimeoutMs) > 0) continue;
+    }
+    return false;
+  }
+  return true;
+#else
+  (void)client;
+  (void)line;
+  return false;
+#endif
+}
+
+void ControlSocket::dropClient(int client) {
+#ifdef CONTROL_SOCKET_UNIX
+  if (partial_.erase(client)) ::close(client);
+#else
+  (void)client;
+#endif
+}
@@ -0,0 +1,46 @@
+// File: src/control_socket.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Line-oriented Unix-domain stream server: one request per line in, one
+// response per line out. Every descriptor is non-blocking; the owner watches
+// fd() and each client with its own event loop and calls acceptClient() /
+// readLines() when they become readable. The socket file is created 0600
+// and removed again by close(). Unix only; elsewhere listen() fails.
+class ControlSocket {
+public:
+  ControlSocket() = default;
+  ~ControlSocket();
+  ControlSocket(const ControlSocket&) = delete;
+  ControlSocket& operator=(const ControlSocket&) = delete;
+
+  // Replaces a stale socket file left by a crashed process
+  bool listen(const std::string& path, std::string& error);
+  void close();
+  bool isListening() const { return listenFd_ >= 0; }
+  int fd() const { return listenFd_; }
+  const std::string& path() const { return path_; }
+
+  // Next pending connection, -1 when there is none
+  int acceptClient();
+  // Appends the complete lines received so far. False once the peer has
+  // closed, failed or sent an over-long line: the caller drops the client.
+  bool readLines(int client, std::vector<std::string>& lines);
+  // Writes line + '\n', waiting briefly for a slow reader; false on failure
+  bool sendLine(int client, const std::string& line);
+  void dropClient(int client);
+
+  size_t   clients() const { return partial_.size(); }
+  uint64_t linesRead() const { return linesRead_; }
+
+private:
+  int listenFd_{-1};
+  std::string path_;
+  std::map<int, std::string> partial_;   // client fd → bytes after the last newline
+  uint64_t linesRead_{0};
+};
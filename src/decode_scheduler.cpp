@@ -0,0 +1,214 @@
+// File: src/decode_scheduler.cpp
+#include "decode_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Thread-count property of a decoder or video converter, nullptr otherwise
+const char* threadProperty(GstElement* element) {
+  GstElementFactory* factory = gst_element_get_factory(element);
+  if (!factory) return nullptr;
+  const char* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+  if (!klass || (!strstr(klass, "Decoder") && !(strstr(klass, "Converter") && strstr(klass, "Video")))) {
+    return nullptr;
+  }
+  GObjectClass* cls = G_OBJECT_GET_CLASS(element);
+  for (const char* name : {"max-threads", "n-threads", "threads"}) {
+    if (g_object_class_find_property(cls, name)) return name;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+DecodeScheduler& DecodeScheduler::instance() {
+  static DecodeScheduler scheduler;
+  return scheduler;
+}
+
+void DecodeScheduler::setTotalThreads(unsigned total) {
+  std::vector<Assignment> assignments;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_ = total;
+    assignments = rebalanceLocked();
+  }
+  apply(assignments);
+}
+
+unsigned DecodeScheduler::totalThreads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_;
+}
+
+void DecodeScheduler::attach(GstElement* pipeline) {
+  std::vector<Assignment> assignments;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Member& m : members_) {
+      if (m.pipeline == pipeline) return;
+    }
+    members_.push_back(Member{pipeline, 0, 0, {}});
+    Member& member = members_.back();
+    member.handler = g_signal_connect(pipeline, "deep-element-added",
+                                      G_CALLBACK(&DecodeScheduler::onDeepElementAdded), this);
+    // Elements that were already in the bin
+    GstIterator* it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      auto* element = GST_ELEMENT(g_value_get_object(&item));
+      if (const char* property = threadProperty(element)) {
+        member.elements.emplace_back();
+        g_weak_ref_init(&member.elements.back().element, element);
+        member.elements.back().property = property;
+      }
+      g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    assignments = rebalanceLocked();
+  }
+  apply(assignments);
+}
+
+void DecodeScheduler::detach(GstElement* pipeline) {
+  std::vector<Assignment> assignments;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(members_.begin(), members_.end(),
+                           [pipeline](const Member& m) { return m.pipeline == pipeline; });
+    if (it == members_.end()) return;
+    g_signal_handler_disconnect(pipeline, it->handler);
+    for (Tracked& t : it->elements) g_weak_ref_clear(&t.element);
+    members_.erase(it);
+    assignments = rebalanceLocked();
+  }
+  apply(assignments);
+}
+
+void DecodeScheduler::onDeepElementAdded(GstBin* bin, GstBin*, GstElement* element, gpointer userData) {
+  auto* self = static_cast<DecodeScheduler*>(userData);
+  const char* property = threadProperty(element);
+  if (!property) return;
+  std::vector<Assignment> assignments;
+  {
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    size_t rank = 0;
+    for (Member& m : self->members_) {
+      if (m.pipeline == GST_ELEMENT(bin)) {
+        m.elements.emplace_back();
+        g_weak_ref_init(&m.elements.back().element, element);
+        m.elements.back().property = property;
+        // One more element: the pipeline's share is split again
+        if (self->threadsLocked(m, rank)) self->capped_++;
+        self->splitLocked(m, rank, assignments);
+        break;
+      }
+      rank++;
+    }
+  }
+  apply(assignments);
+}
+
+unsigned DecodeScheduler::shareLocked(size_t rank) const {
+  if (!total_ || members_.empty()) return 0;
+  const size_t n = members_.size();
+  const unsigned share = unsigned(total_ / n) + (rank < total_ % n ? 1 : 0);
+  return std::max(1u, share);
+}
+
+unsigned DecodeScheduler::threadsLocked(const Member& member, size_t rank) const {
+  const unsigned share = shareLocked(rank);
+  if (!member.limit) return share;
+  return share ? std::min(share, member.limit) : member.limit;
+}
+
+void DecodeScheduler::setPipelineLimit(GstElement* pipeline, unsigned maxThreads) {
+  std::vector<Assignment> assignments;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(members_.begin(), members_.end(),
+                           [pipeline](const Member& m) { return m.pipeline == pipeline; });
+    if (it == members_.end() || it->limit == maxThreads) return;
+    it->limit = maxThreads;
+    assignments = rebalanceLocked();
+  }
+  apply(assignments);
+}
+
+void DecodeScheduler::splitLocked(Member& member, size_t rank, std::vector<Assignment>& assignments) {
+  std::vector<Assignment> live;
+  for (auto it = member.elements.begin(); it != member.elements.end();) {
+    auto* element = static_cast<GstElement*>(g_weak_ref_get(&it->element));
+    if (!element) {
+      g_weak_ref_clear(&it->element);
+      it = member.elements.erase(it);
+      continue;
+    }
+    live.push_back({element, it->property, 0});
+    ++it;
+  }
+  const unsigned share = threadsLocked(member, rank);
+  const size_t n = live.size();
+  for (size_t i = 0; i < n; ++i) {
+    Assignment& a = live[i];
+    if (share) {
+      a.threads = std::max(1u, unsigned(share / n) + (i < share % n ? 1 : 0));
+    } else if (a.property != "max-threads") {
+      // An uncapped scheduler hands "auto" (0) back where the element allows it
+      gst_object_unref(a.element);
+      continue;
+    }
+    assignments.push_back(a);
+  }
+}
+
+std::vector<DecodeScheduler::Assignment> DecodeScheduler::rebalanceLocked() {
+  std::vector<Assignment> assignments;
+  rebalances_++;
+  size_t rank = 0;
+  for (Member& m : members_) splitLocked(m, rank++, assignments);
+  return assignments;
+}
+
+void DecodeScheduler::apply(std::vector<Assignment>& assignments) {
+  for (Assignment& a : assignments) {
+    gst_util_set_object_arg(G_OBJECT(a.element), a.property.c_str(), std::to_string(a.threads).c_str());
+    gst_object_unref(a.element);
+  }
+  assignments.clear();
+}
+
+unsigned DecodeScheduler::shareFor(GstElement* pipeline) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t rank = 0;
+  for (const Member& m : members_) {
+    if (m.pipeline == pipeline) return threadsLocked(m, rank);
+    rank++;
+  }
+  return 0;
+}
+
+size_t DecodeScheduler::pipelines() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return members_.size();
+}
+
+size_t DecodeScheduler::trackedElements() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t n = 0;
+  for (const Member& m : members_) n += m.elements.size();
+  return n;
+}
+
+uint64_t DecodeScheduler::elementsCapped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capped_;
+}
+
+uint64_t DecodeScheduler::rebalances() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return rebalances_;
+}
@@ -0,0 +1,77 @@
+// File: src/decode_scheduler.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Process-wide cap on decoder and converter worker threads. Every attached
+// pipeline gets an equal share of the total (earlier pipelines take the
+// remainder, never less than one thread). That share is split across the
+// pipeline's decoders (max-threads / n-threads / threads) and video
+// converters (n-threads), at least one thread each, and split again as
+// elements are added. Shares are recomputed when pipelines come and go;
+// elements already running pick up a new value at their next
+// (re)negotiation. A pipeline may also carry its own limit (e.g. from a
+// memory budget), which applies whether or not a process-wide total is set.
+class DecodeScheduler {
+public:
+  static DecodeScheduler& instance();
+
+  DecodeScheduler(const DecodeScheduler&) = delete;
+  DecodeScheduler& operator=(const DecodeScheduler&) = delete;
+
+  // 0 = no cap: elements are only counted and keep their own defaults
+  void setTotalThreads(unsigned total);
+  unsigned totalThreads() const;
+
+  void attach(GstElement* pipeline);
+  void detach(GstElement* pipeline);
+  // 0 = no per-pipeline limit
+  void setPipelineLimit(GstElement* pipeline, unsigned maxThreads);
+
+  unsigned shareFor(GstElement* pipeline) const;   // 0 when uncapped or unknown
+  size_t   pipelines() const;
+  size_t   trackedElements() const;
+  uint64_t elementsCapped() const;
+  uint64_t rebalances() const;
+
+private:
+  DecodeScheduler() = default;
+
+  struct Tracked {
+    GWeakRef    element;
+    std::string property;
+  };
+  struct Member {
+    GstElement* pipeline;
+    gulong      handler;
+    unsigned    limit;
+    std::list<Tracked> elements;   // stable addresses for the weak refs
+  };
+  struct Assignment {
+    GstElement* element;   // ref'd
+    std::string property;
+    unsigned    threads;
+  };
+
+  static void onDeepElementAdded(GstBin* bin, GstBin* subBin, GstElement* element, gpointer userData);
+  unsigned shareLocked(size_t rank) const;
+  unsigned threadsLocked(const Member& member, size_t rank) const;   // share within the member's limit
+  // Splits the member's share across its live elements (dropping dead ones)
+  void splitLocked(Member& member, size_t rank, std::vector<Assignment>& assignments);
+  // Collects new values for every live element; applied outside the lock
+  std::vector<Assignment> rebalanceLocked();
+  static void apply(std::vector<Assignment>& assignments);
+
+  mutable std::mutex mutex_;
+  std::list<Member> members_;   // registration order
+  unsigned total_{0};
+  uint64_t capped_{0};
+  uint64_t rebalances_{0};
+};
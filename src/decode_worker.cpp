@@ -0,0 +1,269 @@
+// File: src/decode_worker.cpp
+#include "decode_worker.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <gst/gst.h>
+
+#if defined(__linux__)
+#include <csignal>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define DECODE_WORKER_FORK 1
+#endif
+
+namespace {
+
+constexpr int kPullTimeoutMs = 100;
+
+#ifdef DECODE_WORKER_FORK
+double procCpuMs(int pid) {
+  char path[64];
+  std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+  FILE* f = std::fopen(path, "r");
+  if (!f) return 0.0;
+  char buf[1024];
+  const size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+  std::fclose(f);
+  buf[n] = '\0';
+  // Fields after the parenthesised comm: state is field 3, utime/stime 14/15
+  const char* p = std::strrchr(buf, ')');
+  unsigned long utime = 0, stime = 0;
+  if (!p || std::sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2) {
+    return 0.0;
+  }
+  return double(utime + stime) * 1000.0 / double(sysconf(_SC_CLK_TCK));
+}
+#endif
+
+}  // namespace
+
+DecodeWorker::~DecodeWorker() {
+  stop();
+}
+
+bool DecodeWorker::start(const std::string& exe, const std::string& location, int64_t startNs,
+                         uint32_t slots, uint32_t slotBytes) {
+  stop();
+  std::lock_guard<std::mutex> lock(mutex_);
+  exe_ = exe;
+  location_ = location;
+  slots_ = slots;
+  slotBytes_ = slotBytes;
+  return spawnLocked(startNs);
+}
+
+bool DecodeWorker::spawnLocked(int64_t startNs) {
+#ifdef DECODE_WORKER_FORK
+  auto ring = std::make_shared<SharedFrameRing>();
+  if (!ring->create(slots_, slotBytes_)) return false;
+  // Everything the child needs is prepared before fork(): only
+  // async-signal-safe calls run between fork() and exec
+  const std::string fdArg = std::to_string(ring->fd());
+  const std::string startArg = std::to_string(startNs);
+  std::vector<const char*> argv = {exe_.c_str(), "--decode-worker", "--worker-fd", fdArg.c_str(),
+                                   "--worker-start", startArg.c_str(), location_.c_str(), nullptr};
+  const pid_t parent = getpid();
+  const pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != parent) _exit(1);
+    execv(exe_.c_str(), const_cast<char* const*>(argv.data()));
+    _exit(127);
+  }
+  pid_ = pid;
+  ring_ = std::move(ring);
+  exitReason_.clear();
+  return true;
+#else
+  (void)startNs;
+  return false;
+#endif
+}
+
+void DecodeWorker::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+#ifdef DECODE_WORKER_FORK
+  if (pid_ > 0) {
+    kill(pid_, SIGTERM);
+    reapLocked(0);
+  }
+#endif
+  if (ring_) ring_->wakeAll();
+  ring_.reset();
+}
+
+void DecodeWorker::reapLocked(int options) {
+#ifdef DECODE_WORKER_FORK
+  int status = 0;
+  struct rusage ru{};
+  if (pid_ <= 0 || wait4(pid_, &status, options, &ru) != pid_) return;
+  reapedCpuMs_ += double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0 +
+                  double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+  char reason[64];
+  if (WIFSIGNALED(status)) std::snprintf(reason, sizeof(reason), "killed by signal %d", WTERMSIG(status));
+  else std::snprintf(reason, sizeof(reason), "exited with code %d", WEXITSTATUS(status));
+  exitReason_ = reason;
+  pid_ = -1;
+#else
+  (void)options;
+#endif
+}
+
+bool DecodeWorker::alive() {
+  std::lock_guard<std::mutex> lock(mutex_);
+#ifdef DECODE_WORKER_FORK
+  reapLocked(WNOHANG);
+#endif
+  return pid_ > 0;
+}
+
+bool DecodeWorker::respawn(int64_t startNs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+#ifdef DECODE_WORKER_FORK
+  if (pid_ > 0) {
+    kill(pid_, SIGKILL);
+    reapLocked(0);
+  }
+#endif
+  if (ring_) ring_->wakeAll();
+  restarts_++;
+  return spawnLocked(startNs);
+}
+
+std::shared_ptr<SharedFrameRing> DecodeWorker::ring() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ring_;
+}
+
+int DecodeWorker::pid() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pid_;
+}
+
+std::string DecodeWorker::exitReason() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return exitReason_;
+}
+
+double DecodeWorker::cpuMs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+#ifdef DECODE_WORKER_FORK
+  return reapedCpuMs_ + (pid_ > 0 ? procCpuMs(pid_) : 0.0);
+#else
+  return reapedCpuMs_;
+#endif
+}
+
+uint64_t DecodeWorker::restarts() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return restarts_;
+}
+
+int runDecodeWorkerProcess(int fd, const std::string& location, int64_t startNs) {
+  SharedFrameRing ring;
+  if (!ring.attach(fd)) return 2;
+  gst_init(nullptr, nullptr);
+  GError* err = nullptr;
+  // Raw I420 keeps slots small; the player converts for its sink
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin ! videoconvert ! video/x-raw,format=I420 ! "
+    "appsink name=sink sync=false max-buffers=2", &err);
+  if (!pipe) {
+    if (err) g_error_free(err);
+    ring.setState(SharedFrameRing::Failed);
+    return 3;
+  }
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  g_object_set(src, "location", location.c_str(), NULL);
+  gst_object_unref(src);
+  GstBus* bus = gst_element_get_bus(pipe);
+
+  gst_element_set_state(pipe, GST_STATE_PAUSED);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, 10 * GST_SECOND,
+                                               (GstMessageType)(GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR));
+  bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ASYNC_DONE;
+  if (msg) gst_message_unref(msg);
+  if (ok && startNs > 0) {
+    gst_element_seek_simple(pipe, GST_FORMAT_TIME,
+                            (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), startNs);
+  }
+  if (ok) ok = gst_element_set_state(pipe, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE;
+
+  uint32_t epoch = 0;
+  std::string caps;
+  while (ok) {
+    ring.heartbeat();
+    uint32_t seq = 0;
+    int64_t target = 0;
+    if (ring.pendingSeek(seq, target)) {
+      gst_element_seek_simple(pipe, GST_FORMAT_TIME,
+                              (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), target);
+      epoch = seq;
+      ring.setEpoch(epoch);
+      ring.setState(SharedFrameRing::Running);
+    }
+    if (GstMessage* m = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) {
+      gst_message_unref(m);
+      ring.setState(SharedFrameRing::Failed);
+      break;
+    }
+    GstSample* sample = nullptr;
+    g_signal_emit_by_name(sink, "try-pull-sample", GstClockTime(kPullTimeoutMs * GST_MSECOND), &sample);
+    if (!sample) {
+      gboolean eos = FALSE;
+      g_object_get(sink, "eos", &eos, NULL);
+      // Stay around after EOS: the player may seek back
+      if (eos && ring.state() != SharedFrameRing::Eos) ring.setState(SharedFrameRing::Eos);
+      continue;
+    }
+    if (GstCaps* sc = gst_sample_get_caps(sample)) {
+      gchar* str = gst_caps_to_string(sc);
+      if (caps != str) {
+        caps = str;
+        ring.setCaps(caps);
+      }
+      g_free(str);
+    }
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+      if (map.size > ring.slotBytes()) {
+        gst_buffer_unmap(buf, &map);
+        gst_sample_unref(sample);
+        ring.setState(SharedFrameRing::Failed);
+        break;
+      }
+      uint8_t* dst = nullptr;
+      // Wait for a free slot, but let a seek request preempt the frame
+      while (!(dst = ring.beginWrite(kPullTimeoutMs)) && !ring.pendingSeek(seq, target)) {
+        ring.heartbeat();
+      }
+      if (dst) {
+        std::memcpy(dst, map.data, map.size);
+        SharedFrameRing::Frame frame;
+        frame.pts = GST_BUFFER_PTS_IS_VALID(buf) ? int64_t(GST_BUFFER_PTS(buf)) : -1;
+        frame.duration = GST_BUFFER_DURATION_IS_VALID(buf) ? int64_t(GST_BUFFER_DURATION(buf)) : -1;
+        frame.producedNs = monotonicNs();
+        frame.epoch = epoch;
+        frame.size = uint32_t(map.size);
+        ring.commit(frame);
+        if (ring.state() == SharedFrameRing::Starting) ring.setState(SharedFrameRing::Running);
+      }
+      gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+  }
+  if (!ok) ring.setState(SharedFrameRing::Failed);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(sink);
+  gst_object_unref(pipe);
+  return ring.state() == SharedFrameRing::Failed ? 1 : 0;
+}
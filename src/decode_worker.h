@@ -0,0 +1,53 @@
+// File: src/decode_worker.h
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "frame_ring.h"
+
+// Player side of process-isolated decoding: runs `<exe> --decode-worker`
+// as a child that decodes `location` into a SharedFrameRing. A crashed or
+// failed worker is replaced by a fresh one on a new ring (buffers still
+// wrapping the old ring keep it mapped through the shared_ptr).
+class DecodeWorker {
+public:
+  DecodeWorker() = default;
+  ~DecodeWorker();
+  DecodeWorker(const DecodeWorker&) = delete;
+  DecodeWorker& operator=(const DecodeWorker&) = delete;
+
+  bool start(const std::string& exe, const std::string& location, int64_t startNs,
+             uint32_t slots, uint32_t slotBytes);
+  void stop();
+  // Reaps an exited worker; false once it is gone
+  bool alive();
+  bool respawn(int64_t startNs);
+
+  std::shared_ptr<SharedFrameRing> ring() const;
+  int         pid() const;
+  std::string exitReason() const;   // how the last worker ended
+  double      cpuMs() const;        // running worker + every reaped one
+  uint64_t    restarts() const;
+
+private:
+  bool spawnLocked(int64_t startNs);
+  void reapLocked(int options);
+
+  mutable std::mutex mutex_;
+  std::string exe_;
+  std::string location_;
+  uint32_t slots_{0};
+  uint32_t slotBytes_{0};
+  std::shared_ptr<SharedFrameRing> ring_;
+  int      pid_{-1};
+  std::string exitReason_;
+  double   reapedCpuMs_{0.0};
+  uint64_t restarts_{0};
+};
+
+// Child side: decodes video into the inherited ring until EOS is served and
+// the parent goes away. Returns the process exit code.
+int runDecodeWorkerProcess(int fd, const std::string& location, int64_t startNs);
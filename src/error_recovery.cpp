@@ -0,0 +1,96 @@
+// File: src/error_recovery.cpp
+#include "error_recovery.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+// True when obj is element or sits anywhere inside it (auto*sink children,
+// decodebin's autoplugged decoders)
+bool within(GstObject* obj, GstElement* element) {
+  if (!obj || !element) return false;
+  gst_object_ref(obj);
+  while (obj) {
+    if (obj == GST_OBJECT(element)) {
+      gst_object_unref(obj);
+      return true;
+    }
+    GstObject* parent = gst_object_get_parent(obj);
+    gst_object_unref(obj);
+    obj = parent;
+  }
+  return false;
+}
+
+bool isSinkElement(GstObject* obj) {
+  return obj && GST_IS_ELEMENT(obj) && GST_OBJECT_FLAG_IS_SET(obj, GST_ELEMENT_FLAG_SINK);
+}
+}  // namespace
+
+ErrorClass classifyError(GstMessage* msg, const ErrorContext& ctx, GstElement** failingSink) {
+  GError* err = nullptr;
+  gst_message_parse_error(msg, &err, nullptr);
+  GstObject* src = GST_MESSAGE_SRC(msg);
+  ErrorClass cls = ErrorClass::Other;
+  if (failingSink) *failingSink = nullptr;
+
+  if ((err && err->domain == GST_STREAM_ERROR &&
+       (err->code == GST_STREAM_ERROR_DECRYPT || err->code == GST_STREAM_ERROR_DECRYPT_NOKEY)) ||
+      within(src, ctx.decrypt)) {
+    cls = ErrorClass::Decrypt;
+  } else if (within(src, ctx.videoSink) || within(src, ctx.audioSink) ||
+             (err && err->domain == GST_RESOURCE_ERROR && isSinkElement(src))) {
+    cls = ErrorClass::Sink;
+    if (failingSink) {
+      *failingSink = within(src, ctx.videoSink) ? ctx.videoSink
+                   : within(src, ctx.audioSink) ? ctx.audioSink : nullptr;
+    }
+  } else if (within(src, ctx.source) ||
+             (err && err->domain == GST_RESOURCE_ERROR &&
+              (err->code == GST_RESOURCE_ERROR_NOT_FOUND || err->code == GST_RESOURCE_ERROR_OPEN_READ ||
+               err->code == GST_RESOURCE_ERROR_READ || err->code == GST_RESOURCE_ERROR_SEEK))) {
+    cls = ErrorClass::Source;
+  } else if (within(src, ctx.decodebin) ||
+             (err && err->domain == GST_STREAM_ERROR &&
+              (err->code == GST_STREAM_ERROR_DECODE || err->code == GST_STREAM_ERROR_CODEC_NOT_FOUND ||
+               err->code == GST_STREAM_ERROR_FORMAT || err->code == GST_STREAM_ERROR_DEMUX))) {
+    cls = ErrorClass::Decoder;
+  }
+  if (err) g_error_free(err);
+  return cls;
+}
+
+const char* errorClassName(ErrorClass c) {
+  switch (c) {
+    case ErrorClass::Decoder: return "decoder";
+    case ErrorClass::Sink:    return "sink";
+    case ErrorClass::Source:  return "source";
+    case ErrorClass::Decrypt: return "decrypt";
+    case ErrorClass::Stall:   return "stall";
+    case ErrorClass::Other:   return "other";
+  }
+  return "?";
+}
+
+int RecoveryBackoff::nextDelayMs(int64_t nowMs) {
+  if (recoveredAtMs_ >= 0 && nowMs - recoveredAtMs_ >= stableMs_) {
+    attempts_ = 0;
+  }
+  recoveredAtMs_ = -1;
+  const int shift = std::min(attempts_, 16);
+  attempts_++;
+  return int(std::min<int64_t>(maxMs_, int64_t(baseMs_) << shift));
+}
+
+bool RecoveryBackoff::exhausted(int64_t nowMs) const {
+  const bool reset = recoveredAtMs_ >= 0 && nowMs - recoveredAtMs_ >= stableMs_;
+  return !reset && attempts_ >= maxAttempts_;
+}
+
+double RecoveryStats::mean() const {
+  return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size());
+}
+
+double RecoveryStats::max() const {
+  return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
@@ -0,0 +1,60 @@
+// File: src/error_recovery.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Stall is not a GStreamer error: raised by the stall watchdog
+enum class ErrorClass { Decoder, Sink, Source, Decrypt, Stall, Other };
+
+// Elements the classifier needs to attribute an error to a branch
+struct ErrorContext {
+  GstElement* source{nullptr};
+  GstElement* decodebin{nullptr};
+  GstElement* decrypt{nullptr};
+  GstElement* videoSink{nullptr};
+  GstElement* audioSink{nullptr};
+};
+
+// Classifies a GST_MESSAGE_ERROR by its GError domain/code and by which
+// element (or bin child) posted it. For sink errors, failingSink receives
+// ctx.videoSink or ctx.audioSink (nullptr when it can't be told apart).
+ErrorClass classifyError(GstMessage* msg, const ErrorContext& ctx, GstElement** failingSink = nullptr);
+const char* errorClassName(ErrorClass c);
+
+// Exponential backoff between recovery attempts. The attempt counter only
+// resets after playback has stayed healthy for stableMs; once maxAttempts
+// have been made without that, recovery gives up.
+class RecoveryBackoff {
+public:
+  RecoveryBackoff(int baseMs = 500, int maxMs = 30000, int64_t stableMs = 60000, int maxAttempts = 8)
+    : baseMs_(baseMs), maxMs_(maxMs), stableMs_(stableMs), maxAttempts_(maxAttempts) {}
+
+  // Delay before the next attempt; counts the attempt
+  int nextDelayMs(int64_t nowMs);
+  void recovered(int64_t nowMs) { recoveredAtMs_ = nowMs; }
+  // Forget earlier attempts (a new file starts with a clean slate)
+  void reset() { attempts_ = 0; recoveredAtMs_ = -1; }
+  int attempts() const { return attempts_; }
+  // True when the next attempt would exceed the limit
+  bool exhausted(int64_t nowMs) const;
+
+private:
+  int     baseMs_;
+  int     maxMs_;
+  int64_t stableMs_;
+  int     maxAttempts_;
+  int     attempts_{0};
+  int64_t recoveredAtMs_{-1};
+};
+
+// Time-to-recover statistics
+struct RecoveryStats {
+  void add(double ms) { samples.push_back(ms); }
+  double mean() const;
+  double max() const;
+  std::vector<double> samples;
+  uint64_t failedAttempts{0};
+};
@@ -0,0 +1,148 @@
+// File: src/frame_cache.cpp
+#include "frame_cache.h"
+
+#include <gst/video/video.h>
+
+FrameCache::~FrameCache() {
+  clear();
+  if (caps_) gst_caps_unref(caps_);
+}
+
+void FrameCache::setBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_ = bytes;
+  evictLocked();
+}
+
+size_t FrameCache::budget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+void FrameCache::setCaps(GstCaps* caps) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gst_caps_replace(&caps_, caps);
+  GstVideoInfo info;
+  if (caps && gst_video_info_from_caps(&info, caps) && info.fps_n > 0) {
+    frameDur_ = gst_util_uint64_scale_int(GST_SECOND, info.fps_d, info.fps_n);
+  }
+}
+
+GstCaps* FrameCache::caps() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return caps_ ? gst_caps_ref(caps_) : nullptr;
+}
+
+GstClockTime FrameCache::frameDuration() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frameDur_;
+}
+
+void FrameCache::insert(GstBuffer* buf) {
+  const GstClockTime pts = GST_BUFFER_PTS(buf);
+  if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+  const size_t size = gst_buffer_get_size(buf);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!budget_ || !caps_ || size > budget_ || frames_.count(pts)) return;
+  }
+  // Deep copy: upstream buffers belong to bounded pools (often the sink's
+  // own shm pool); holding them would starve the pipeline.
+  GstBuffer* copy = gst_buffer_copy_deep(buf);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (frames_.count(pts) || !caps_) {
+    gst_buffer_unref(copy);
+    return;
+  }
+  lru_.push_front(pts);
+  frames_.emplace(pts, Entry{gst_sample_new(copy, caps_, nullptr, nullptr), size, lru_.begin()});
+  gst_buffer_unref(copy);
+  bytes_ += size;
+  evictLocked();
+}
+
+void FrameCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& kv : frames_) gst_sample_unref(kv.second.sample);
+  frames_.clear();
+  lru_.clear();
+  bytes_ = 0;
+}
+
+void FrameCache::evictLocked() {
+  while (bytes_ > budget_ && !lru_.empty()) {
+    auto it = frames_.find(lru_.back());
+    lru_.pop_back();
+    if (it == frames_.end()) continue;
+    bytes_ -= it->second.size;
+    gst_sample_unref(it->second.sample);
+    frames_.erase(it);
+  }
+}
+
+GstSample* FrameCache::hitLocked(std::map<GstClockTime, Entry>::iterator it) {
+  if (it == frames_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  return gst_sample_ref(it->second.sample);
+}
+
+GstSample* FrameCache::next(GstClockTime pts) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = frames_.upper_bound(pts);
+  // Only the immediately following frame counts as a hit
+  if (it != frames_.end() && it->first - pts > frameDur_ + frameDur_ / 2) it = frames_.end();
+  return hitLocked(it);
+}
+
+GstSample* FrameCache::prev(GstClockTime pts) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = frames_.lower_bound(pts);
+  if (it == frames_.begin()) return hitLocked(frames_.end());
+  --it;
+  if (pts - it->first > frameDur_ + frameDur_ / 2) it = frames_.end();
+  return hitLocked(it);
+}
+
+GstSample* FrameCache::atOrAfter(GstClockTime pts) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = frames_.lower_bound(pts);
+  if (it != frames_.end() && it->first - pts > frameDur_ + frameDur_ / 2) it = frames_.end();
+  return hitLocked(it);
+}
+
+bool FrameCache::covers(GstClockTime a, GstClockTime b) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const GstClockTime maxGap = frameDur_ + frameDur_ / 2;
+  auto it = frames_.lower_bound(a);
+  if (it == frames_.end() || it->first - a > maxGap) return false;
+  GstClockTime last = it->first;
+  for (++it; it != frames_.end() && it->first <= b; ++it) {
+    if (it->first - last > maxGap) return false;
+    last = it->first;
+  }
+  return b <= last || b - last <= maxGap;
+}
+
+uint64_t FrameCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+uint64_t FrameCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+size_t FrameCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+size_t FrameCache::frames() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frames_.size();
+}
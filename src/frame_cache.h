@@ -0,0 +1,66 @@
+// File: src/frame_cache.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+
+#include <gst/gst.h>
+
+// Bounded cache of decoded video frames keyed by PTS, evicted LRU once the
+// memory budget is exceeded. Frames are inserted from the streaming thread
+// and looked up from the GUI thread. Returned samples carry their own caps
+// and must be released with gst_sample_unref().
+class FrameCache {
+public:
+  FrameCache() = default;
+  ~FrameCache();
+  FrameCache(const FrameCache&) = delete;
+  FrameCache& operator=(const FrameCache&) = delete;
+
+  void setBudget(size_t bytes);
+  size_t budget() const;
+
+  // Caps for subsequent inserts (from the CAPS event on the tapped pad)
+  void setCaps(GstCaps* caps);
+  GstCaps* caps() const;   // ref'd; nullptr before the first CAPS event
+  GstClockTime frameDuration() const;
+
+  void insert(GstBuffer* buf);
+  void clear();
+
+  // Neighbours of pts; nullptr is a miss
+  GstSample* next(GstClockTime pts);
+  GstSample* prev(GstClockTime pts);
+  GstSample* atOrAfter(GstClockTime pts);
+
+  // True when [a, b] is present without gaps larger than 1.5 frames
+  bool covers(GstClockTime a, GstClockTime b) const;
+
+  uint64_t hits() const;
+  uint64_t misses() const;
+  size_t   bytes() const;
+  size_t   frames() const;
+
+private:
+  struct Entry {
+    GstSample* sample;
+    size_t     size;
+    std::list<GstClockTime>::iterator lru;
+  };
+
+  GstSample* hitLocked(std::map<GstClockTime, Entry>::iterator it);
+  void evictLocked();
+
+  mutable std::mutex mutex_;
+  std::map<GstClockTime, Entry> frames_;
+  std::list<GstClockTime> lru_;   // front = most recently used
+  GstCaps*     caps_{nullptr};
+  GstClockTime frameDur_{40 * GST_MSECOND};
+  size_t       budget_{0};
+  size_t       bytes_{0};
+  uint64_t     hits_{0};
+  uint64_t     misses_{0};
+};
@@ -0,0 +1,324 @@
+// File: src/frame_ring.cpp
+#include "frame_ring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define FRAME_RING_SHM 1
+#endif
+
+namespace {
+constexpr uint32_t kMagic = 0x46524d52;   // "FRMR"
+constexpr size_t   kCapsBytes = 1024;
+constexpr size_t   kSlotAlign = 4096;
+constexpr int      kCapsRetries = 10000;
+}  // namespace
+
+// Shared layout: header, then `slots` × (SlotHeader + payload), page aligned
+struct SharedFrameRing::Header {
+  uint32_t magic;
+  uint32_t slots;
+  uint32_t slotBytes;
+  uint32_t slotStride;
+  std::atomic<uint32_t> written;    // futex: producer commits
+  std::atomic<uint32_t> released;   // futex: consumer frees (in ring order)
+  std::atomic<uint32_t> state;
+  std::atomic<uint32_t> epoch;
+  std::atomic<uint32_t> seekSeq;
+  std::atomic<int64_t>  seekTarget;
+  std::atomic<int64_t>  heartbeatNs;
+  std::atomic<uint32_t> capsSeq;    // odd while caps are being written
+  char caps[kCapsBytes];
+};
+
+struct SharedFrameRing::SlotHeader {
+  Frame frame;
+  std::atomic<uint32_t> free;   // consumer side: released, waiting for its turn
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free,
+              "shared counters must be address-free");
+
+int64_t monotonicNs() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+#ifdef FRAME_RING_SHM
+namespace {
+// Shared (not PRIVATE) futex ops: waiter and waker live in different processes
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+  timespec ts{timeoutMs / 1000, long(timeoutMs % 1000) * 1000000};
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+}  // namespace
+#endif
+
+SharedFrameRing::~SharedFrameRing() {
+  close();
+}
+
+bool SharedFrameRing::create(uint32_t slots, uint32_t slotBytes) {
+  close();
+#ifdef FRAME_RING_SHM
+  if (!slots || !slotBytes) return false;
+  const size_t headerBytes = (sizeof(Header) + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+  const size_t stride = (sizeof(SlotHeader) + slotBytes + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+  const size_t total = headerBytes + stride * slots;
+  // No MFD_CLOEXEC: the worker inherits the descriptor across exec
+  fd_ = int(syscall(SYS_memfd_create, "frame-ring", 0u));
+  if (fd_ < 0) return false;
+  if (ftruncate(fd_, off_t(total)) != 0) {
+    close();
+    return false;
+  }
+  void* mem = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (mem == MAP_FAILED) {
+    close();
+    return false;
+  }
+  mapBytes_ = total;
+  base_ = static_cast<uint8_t*>(mem);
+  header_ = new (mem) Header();
+  header_->slots = slots;
+  header_->slotBytes = slotBytes;
+  header_->slotStride = uint32_t(stride);
+  header_->seekTarget = -1;
+  slots_ = slots;
+  slotBytes_ = slotBytes;
+  slotStride_ = uint32_t(stride);
+  for (uint32_t i = 0; i < slots; i++) new (slotHeader(i)) SlotHeader();
+  header_->magic = kMagic;
+  readCount_ = 0;
+  createdNs_ = monotonicNs();
+  return true;
+#else
+  (void)slots;
+  (void)slotBytes;
+  return false;
+#endif
+}
+
+bool SharedFrameRing::attach(int fd) {
+  close();
+#ifdef FRAME_RING_SHM
+  const off_t size = lseek(fd, 0, SEEK_END);
+  if (size < off_t(sizeof(Header))) return false;
+  void* mem = mmap(nullptr, size_t(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mem == MAP_FAILED) return false;
+  fd_ = fd;
+  mapBytes_ = size_t(size);
+  base_ = static_cast<uint8_t*>(mem);
+  header_ = static_cast<Header*>(mem);
+  const size_t headerBytes = (sizeof(Header) + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+  if (header_->magic != kMagic || !header_->slots ||
+      header_->slotStride < sizeof(SlotHeader) + size_t(header_->slotBytes) ||
+      headerBytes + size_t(header_->slotStride) * header_->slots > mapBytes_) {
+    close();
+    return false;
+  }
+  slots_ = header_->slots;
+  slotBytes_ = header_->slotBytes;
+  slotStride_ = header_->slotStride;
+  createdNs_ = monotonicNs();
+  return true;
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+void SharedFrameRing::close() {
+#ifdef FRAME_RING_SHM
+  if (base_) munmap(base_, mapBytes_);
+  if (fd_ >= 0) ::close(fd_);
+#endif
+  base_ = nullptr;
+  header_ = nullptr;
+  mapBytes_ = 0;
+  slots_ = slotBytes_ = slotStride_ = 0;
+  fd_ = -1;
+}
+
+uint32_t SharedFrameRing::slots() const {
+  return slots_;
+}
+
+uint32_t SharedFrameRing::slotBytes() const {
+  return slotBytes_;
+}
+
+SharedFrameRing::SlotHeader* SharedFrameRing::slotHeader(uint32_t slot) const {
+  const size_t headerBytes = (sizeof(Header) + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+  return reinterpret_cast<SlotHeader*>(base_ + headerBytes + size_t(slotStride_) * (slot % slots_));
+}
+
+uint8_t* SharedFrameRing::beginWrite(int timeoutMs) {
+#ifdef FRAME_RING_SHM
+  if (!header_) return nullptr;
+  const uint32_t written = header_->written.load(std::memory_order_relaxed);
+  const int64_t deadline = monotonicNs() + int64_t(timeoutMs) * 1000000;
+  for (;;) {
+    const uint32_t released = header_->released.load(std::memory_order_acquire);
+    if (written - released < slots_) break;
+    const int64_t left = deadline - monotonicNs();
+    if (left <= 0) return nullptr;
+    futexWait(header_->released, released, int(std::max<int64_t>(1, left / 1000000)));
+  }
+  return reinterpret_cast<uint8_t*>(slotHeader(written % slots_) + 1);
+#else
+  (void)timeoutMs;
+  return nullptr;
+#endif
+}
+
+void SharedFrameRing::commit(const Frame& frame) {
+#ifdef FRAME_RING_SHM
+  const uint32_t written = header_->written.load(std::memory_order_relaxed);
+  SlotHeader* sh = slotHeader(written % slots_);
+  sh->frame = frame;
+  header_->written.store(written + 1, std::memory_order_release);
+  futexWake(header_->written);
+#else
+  (void)frame;
+#endif
+}
+
+void SharedFrameRing::setCaps(const std::string& caps) {
+  if (!header_) return;
+  header_->capsSeq.fetch_add(1, std::memory_order_acq_rel);
+  std::strncpy(header_->caps, caps.c_str(), kCapsBytes - 1);
+  header_->caps[kCapsBytes - 1] = '\0';
+  header_->capsSeq.fetch_add(1, std::memory_order_release);
+}
+
+bool SharedFrameRing::caps(std::string& caps) const {
+  if (!header_) return false;
+  for (int i = 0; i < kCapsRetries; i++) {
+    const uint32_t before = header_->capsSeq.load(std::memory_order_acquire);
+    if (before & 1) continue;
+    caps.assign(header_->caps, strnlen(header_->caps, kCapsBytes));
+    if (header_->capsSeq.load(std::memory_order_acquire) == before) return true;
+  }
+  return false;
+}
+
+void SharedFrameRing::setState(State state) {
+  if (!header_) return;
+  header_->state.store(state, std::memory_order_release);
+  wakeAll();
+}
+
+SharedFrameRing::State SharedFrameRing::state() const {
+  return header_ ? State(header_->state.load(std::memory_order_acquire)) : Failed;
+}
+
+void SharedFrameRing::heartbeat() {
+  if (header_) header_->heartbeatNs.store(monotonicNs(), std::memory_order_relaxed);
+}
+
+int64_t SharedFrameRing::lastHeartbeatNs() const {
+  return header_ ? header_->heartbeatNs.load(std::memory_order_relaxed) : 0;
+}
+
+bool SharedFrameRing::stalled(int64_t timeoutNs) const {
+  if (!header_) return false;
+  return monotonicNs() - std::max(lastHeartbeatNs(), createdNs_) > timeoutNs;
+}
+
+bool SharedFrameRing::pendingSeek(uint32_t& seq, int64_t& target) const {
+  if (!header_) return false;
+  seq = header_->seekSeq.load(std::memory_order_acquire);
+  if (seq == header_->epoch.load(std::memory_order_relaxed)) return false;
+  target = header_->seekTarget.load(std::memory_order_relaxed);
+  return true;
+}
+
+void SharedFrameRing::setEpoch(uint32_t epoch) {
+  if (header_) header_->epoch.store(epoch, std::memory_order_release);
+}
+
+uint32_t SharedFrameRing::requestSeek(int64_t target) {
+  if (!header_) return 0;
+  header_->seekTarget.store(target, std::memory_order_relaxed);
+  const uint32_t seq = header_->seekSeq.fetch_add(1, std::memory_order_acq_rel) + 1;
+  // A producer blocked on a full ring must see the request
+  futexWake(header_->released);
+  return seq;
+}
+
+uint32_t SharedFrameRing::epoch() const {
+  return header_ ? header_->seekSeq.load(std::memory_order_acquire) : 0;
+}
+
+int SharedFrameRing::beginRead(Frame& frame, int timeoutMs) {
+#ifdef FRAME_RING_SHM
+  if (!header_) return -1;
+  const int64_t deadline = monotonicNs() + int64_t(timeoutMs) * 1000000;
+  for (;;) {
+    const uint32_t written = header_->written.load(std::memory_order_acquire);
+    if (written != readCount_.load(std::memory_order_relaxed)) break;
+    const int64_t left = deadline - monotonicNs();
+    if (left <= 0 || header_->state.load(std::memory_order_acquire) >= Eos) return -1;
+    futexWait(header_->written, written, int(std::max<int64_t>(1, left / 1000000)));
+  }
+  const uint32_t slot = readCount_.fetch_add(1, std::memory_order_acq_rel) % slots_;
+  frame = slotHeader(slot)->frame;
+  return int(slot);
+#else
+  (void)frame;
+  (void)timeoutMs;
+  return -1;
+#endif
+}
+
+const uint8_t* SharedFrameRing::slotData(int slot) const {
+  return reinterpret_cast<const uint8_t*>(slotHeader(uint32_t(slot)) + 1);
+}
+
+void SharedFrameRing::release(int slot) {
+#ifdef FRAME_RING_SHM
+  std::lock_guard<std::mutex> lock(releaseMutex_);
+  slotHeader(uint32_t(slot))->free.store(1, std::memory_order_relaxed);
+  uint32_t released = header_->released.load(std::memory_order_relaxed);
+  const uint32_t before = released;
+  const uint32_t handedOut = readCount_.load(std::memory_order_acquire);
+  while (released != handedOut) {
+    SlotHeader* sh = slotHeader(released % slots_);
+    if (!sh->free.load(std::memory_order_relaxed)) break;
+    sh->free.store(0, std::memory_order_relaxed);
+    released++;
+  }
+  if (released != before) {
+    header_->released.store(released, std::memory_order_release);
+    futexWake(header_->released);
+  }
+#else
+  (void)slot;
+#endif
+}
+
+uint32_t SharedFrameRing::queued() const {
+  return header_ ? header_->written.load(std::memory_order_acquire) - readCount_.load() : 0;
+}
+
+void SharedFrameRing::wakeAll() {
+#ifdef FRAME_RING_SHM
+  if (!header_) return;
+  futexWake(header_->written);
+  futexWake(header_->released);
+#endif
+}
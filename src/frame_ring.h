@@ -0,0 +1,87 @@
+// File: src/frame_ring.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Ring of fixed-size decoded-frame slots in a memfd shared between a decode
+// worker process (single producer) and the player (single consumer). Counters
+// live in the mapping and double as futex words, so either side sleeps in
+// the kernel until the other commits or releases a slot. The consumer may
+// hold several slots at once (wrapped as GstBuffers) and release them in any
+// order; a slot is reused only once every slot before it is released too.
+// The ring geometry is fixed at create()/attach() and kept outside the
+// mapping, so a misbehaving worker can't make slot addressing go out of
+// bounds; frame metadata it commits still has to be checked by the consumer.
+// Linux only: create()/attach() fail elsewhere.
+class SharedFrameRing {
+public:
+  struct Frame {
+    int64_t  pts{-1};
+    int64_t  duration{-1};
+    int64_t  producedNs{0};   // CLOCK_MONOTONIC when the worker committed it
+    uint32_t epoch{0};        // seek generation the frame belongs to
+    uint32_t size{0};
+  };
+  enum State : uint32_t { Starting = 0, Running = 1, Eos = 2, Failed = 3 };
+
+  SharedFrameRing() = default;
+  ~SharedFrameRing();
+  SharedFrameRing(const SharedFrameRing&) = delete;
+  SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+  bool create(uint32_t slots, uint32_t slotBytes);   // consumer side
+  bool attach(int fd);                               // producer side (inherited fd)
+  void close();
+  int  fd() const { return fd_; }
+  uint32_t slots() const;
+  uint32_t slotBytes() const;
+
+  // Producer: slot memory to fill, nullptr while the ring stays full
+  uint8_t* beginWrite(int timeoutMs);
+  void commit(const Frame& frame);
+  void setCaps(const std::string& caps);
+  void setState(State state);
+  void heartbeat();
+  // Latest seek request the producer has not served yet; false when none
+  bool pendingSeek(uint32_t& seq, int64_t& target) const;
+  void setEpoch(uint32_t epoch);
+
+  // Consumer: next committed slot index, -1 on timeout
+  int  beginRead(Frame& frame, int timeoutMs);
+  const uint8_t* slotData(int slot) const;
+  void release(int slot);   // any thread, any order
+  // False when the producer never finishes writing them (hung or corrupt)
+  bool caps(std::string& caps) const;
+  State state() const;
+  int64_t lastHeartbeatNs() const;
+  // No heartbeat for timeoutNs (counted from create() before the first one)
+  bool stalled(int64_t timeoutNs) const;
+  // Asks the producer to seek; frames of older epochs are stale afterwards
+  uint32_t requestSeek(int64_t target);
+  uint32_t epoch() const;   // epoch of frames produced from now on
+  void wakeAll();           // unblock both sides (shutdown / crash)
+
+  uint32_t queued() const;  // committed, not yet handed out
+
+private:
+  struct Header;
+  struct SlotHeader;
+  SlotHeader* slotHeader(uint32_t slot) const;
+
+  Header*  header_{nullptr};
+  uint8_t* base_{nullptr};
+  size_t   mapBytes_{0};
+  uint32_t slots_{0};
+  uint32_t slotBytes_{0};
+  uint32_t slotStride_{0};
+  int64_t  createdNs_{0};
+  int      fd_{-1};
+  std::atomic<uint32_t> readCount_{0};   // consumer: slots handed out
+  std::mutex releaseMutex_;
+};
+
+int64_t monotonicNs();
@@ -0,0 +1,197 @@
+// File: src/hugepage_allocator.cpp
+#include "hugepage_allocator.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define HUGEPAGE_MMAP 1
+#endif
+
+namespace {
+constexpr size_t kHugePage = 2 * 1024 * 1024;
+constexpr size_t kMinHugeRequest = 1024 * 1024;
+
+HugePageStats g_stats;
+
+struct AllocationHook {
+  GstAllocator* allocator;
+  bool onlyWithoutPool;
+};
+
+void freeHook(gpointer data) {
+  auto* hook = static_cast<AllocationHook*>(data);
+  gst_object_unref(hook->allocator);
+  delete hook;
+}
+
+GstPadProbeReturn onAllocationQuery(GstPad*, GstPadProbeInfo* info, gpointer userData) {
+  // Only the answered query (second pass) is rewritten
+  if (!(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_PULL)) return GST_PAD_PROBE_OK;
+  GstQuery* query = GST_PAD_PROBE_INFO_QUERY(info);
+  if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION) return GST_PAD_PROBE_OK;
+  auto* hook = static_cast<AllocationHook*>(userData);
+  if (hook->onlyWithoutPool && gst_query_get_n_allocation_pools(query) > 0) return GST_PAD_PROBE_OK;
+  GstAllocationParams params;
+  gst_allocation_params_init(&params);
+  if (gst_query_get_n_allocation_params(query) > 0) {
+    gst_query_parse_nth_allocation_param(query, 0, nullptr, &params);
+    gst_query_set_nth_allocation_param(query, 0, hook->allocator, &params);
+  } else {
+    gst_query_add_allocation_param(query, hook->allocator, &params);
+  }
+  g_stats.queriesAnswered++;
+  return GST_PAD_PROBE_OK;
+}
+}  // namespace
+
+#ifdef HUGEPAGE_MMAP
+struct HugePageMemory {
+  GstMemory mem;
+  uint8_t*  data;
+  size_t    mapped;   // 0 for shared sub-memories
+};
+
+struct HugePageAllocator {
+  GstAllocator parent;
+};
+
+struct HugePageAllocatorClass {
+  GstAllocatorClass parent_class;
+};
+
+G_DEFINE_TYPE(HugePageAllocator, huge_page_allocator, GST_TYPE_ALLOCATOR)
+
+namespace {
+
+uint8_t* mapHuge(size_t bytes) {
+  void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p != MAP_FAILED) {
+    g_stats.hugetlb++;
+    return static_cast<uint8_t*>(p);
+  }
+  // No reserved hugetlb pages: over-map, trim to a 2 MB boundary, advise THP
+  p = mmap(nullptr, bytes + kHugePage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) return nullptr;
+  auto* raw = static_cast<uint8_t*>(p);
+  const uintptr_t aligned = (uintptr_t(raw) + kHugePage - 1) & ~uintptr_t(kHugePage - 1);
+  auto* start = reinterpret_cast<uint8_t*>(aligned);
+  if (start > raw) munmap(raw, size_t(start - raw));
+  const size_t tail = size_t(raw + bytes + kHugePage - (start + bytes));
+  if (tail) munmap(start + bytes, tail);
+  madvise(start, bytes, MADV_HUGEPAGE);
+  g_stats.transparent++;
+  return start;
+}
+
+void prefault(uint8_t* data, size_t bytes) {
+  const gint64 t0 = g_get_monotonic_time();
+  const size_t page = size_t(sysconf(_SC_PAGESIZE));
+  for (size_t off = 0; off < bytes; off += page) {
+    reinterpret_cast<volatile uint8_t*>(data)[off] = 0;
+  }
+  g_stats.prefaultNs += uint64_t(g_get_monotonic_time() - t0) * 1000;
+}
+
+GstMemory* hugeAlloc(GstAllocator* allocator, gsize size, GstAllocationParams* params) {
+  const gsize maxsize = size + params->prefix + params->padding;
+  if (maxsize < kMinHugeRequest) {
+    g_stats.fallbacks++;
+    return gst_allocator_alloc(nullptr, size, params);
+  }
+  const size_t mapped = (maxsize + kHugePage - 1) / kHugePage * kHugePage;
+  uint8_t* data = mapHuge(mapped);
+  if (!data) return nullptr;
+  prefault(data, mapped);
+  auto* mem = g_new0(HugePageMemory, 1);
+  mem->data = data;
+  mem->mapped = mapped;
+  // The mapping is page aligned, which covers any requested alignment
+  gst_memory_init(GST_MEMORY_CAST(mem), params->flags, allocator, nullptr, maxsize, params->align,
+                  params->prefix, size);
+  g_stats.allocations++;
+  g_stats.bytesMapped += mapped;
+  return GST_MEMORY_CAST(mem);
+}
+
+void hugeFree(GstAllocator*, GstMemory* memory) {
+  auto* mem = reinterpret_cast<HugePageMemory*>(memory);
+  if (mem->mapped) {
+    munmap(mem->data, mem->mapped);
+    g_stats.bytesMapped -= mem->mapped;
+    g_stats.frees++;
+  }
+  g_free(mem);
+}
+
+gpointer hugeMap(GstMemory* memory, gsize, GstMapFlags) {
+  return reinterpret_cast<HugePageMemory*>(memory)->data;
+}
+
+void hugeUnmap(GstMemory*) {}
+
+GstMemory* hugeShare(GstMemory* memory, gssize offset, gssize size) {
+  auto* src = reinterpret_cast<HugePageMemory*>(memory);
+  GstMemory* parent = memory->parent ? memory->parent : memory;
+  if (size == -1) size = gssize(memory->size) - offset;
+  auto* sub = g_new0(HugePageMemory, 1);
+  sub->data = src->data;
+  gst_memory_init(GST_MEMORY_CAST(sub),
+                  GstMemoryFlags(GST_MINI_OBJECT_FLAGS(parent) | GST_MINI_OBJECT_FLAG_LOCK_READONLY),
+                  memory->allocator, parent, memory->maxsize, memory->align,
+                  memory->offset + offset, gsize(size));
+  return GST_MEMORY_CAST(sub);
+}
+
+GstMemory* hugeCopy(GstMemory* memory, gssize offset, gssize size) {
+  if (size == -1) size = gssize(memory->size) - offset;
+  GstMemory* copy = gst_allocator_alloc(nullptr, gsize(size), nullptr);
+  GstMapInfo in, out;
+  if (gst_memory_map(memory, &in, GST_MAP_READ)) {
+    if (gst_memory_map(copy, &out, GST_MAP_WRITE)) {
+      std::memcpy(out.data, in.data + offset, gsize(size));
+      gst_memory_unmap(copy, &out);
+    }
+    gst_memory_unmap(memory, &in);
+  }
+  return copy;
+}
+
+}  // namespace
+
+static void huge_page_allocator_class_init(HugePageAllocatorClass* klass) {
+  GstAllocatorClass* allocator = GST_ALLOCATOR_CLASS(klass);
+  allocator->alloc = hugeAlloc;
+  allocator->free = hugeFree;
+}
+
+static void huge_page_allocator_init(HugePageAllocator* self) {
+  GstAllocator* allocator = GST_ALLOCATOR_CAST(self);
+  allocator->mem_type = "HugePageMemory";
+  allocator->mem_map = hugeMap;
+  allocator->mem_unmap = hugeUnmap;
+  allocator->mem_share = hugeShare;
+  allocator->mem_copy = hugeCopy;
+}
+#endif
+
+GstAllocator* hugePageAllocatorNew() {
+#ifdef HUGEPAGE_MMAP
+  auto* allocator = static_cast<GstAllocator*>(g_object_new(huge_page_allocator_get_type(), nullptr));
+  gst_object_ref_sink(allocator);
+  return allocator;
+#else
+  return nullptr;
+#endif
+}
+
+const HugePageStats& hugePageStats() {
+  return g_stats;
+}
+
+void installAllocation(GstPad* sinkPad, GstAllocator* allocator, bool onlyWithoutPool) {
+  if (!sinkPad || !allocator) return;
+  auto* hook = new AllocationHook{GST_ALLOCATOR(gst_object_ref(allocator)), onlyWithoutPool};
+  gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM, &onAllocationQuery, hook, &freeHook);
+}
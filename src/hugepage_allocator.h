@@ -0,0 +1,34 @@
+// File: src/hugepage_allocator.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <gst/gst.h>
+
+// GstAllocator for large video frames. Each memory is a private anonymous
+// mapping rounded up to 2 MB: explicit hugetlb pages when the system has
+// them reserved, otherwise 2 MB aligned and madvise(MADV_HUGEPAGE) for
+// transparent hugepages. Every page is touched at allocation so the faults
+// happen when the pool is (re)configured, not in the first conversions.
+// Small requests (< 1 MB) go to the system allocator. Linux only; elsewhere
+// hugePageAllocatorNew() returns nullptr.
+struct HugePageStats {
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> frees{0};
+  std::atomic<uint64_t> hugetlb{0};        // MAP_HUGETLB mappings
+  std::atomic<uint64_t> transparent{0};    // THP-advised mappings
+  std::atomic<uint64_t> fallbacks{0};      // small requests sent to sysmem
+  std::atomic<uint64_t> bytesMapped{0};    // currently mapped
+  std::atomic<uint64_t> prefaultNs{0};
+  std::atomic<uint64_t> queriesAnswered{0};
+};
+
+GstAllocator* hugePageAllocatorNew();   // full reference
+const HugePageStats& hugePageStats();
+
+// Makes `allocator` the preferred allocation param in every ALLOCATION query
+// answered through `sinkPad` (after the element answered). With
+// onlyWithoutPool, answers that already carry a buffer pool (e.g. a sink's
+// shared-memory pool) are left alone.
+void installAllocation(GstPad* sinkPad, GstAllocator* allocator, bool onlyWithoutPool);
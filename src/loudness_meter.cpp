@@ -0,0 +1,294 @@
+// File: src/loudness_meter.cpp
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LOUDNESS_SSE2 1
+#endif
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr float  kFloor = -200.f;
+
+double energyToLufs(double e) {
+  return e > 0.0 ? -0.691 + 10.0 * std::log10(e) : double(kFloor);
+}
+
+float toDb(double linear) {
+  return linear > 0.0 ? float(20.0 * std::log10(linear)) : kFloor;
+}
+
+// ---------- Vectorized kernels (contiguous single-channel float) ----------
+
+float peakAbs(const float* x, size_t n) {
+  size_t i = 0;
+  float peak = 0.f;
+#ifdef LOUDNESS_SSE2
+  const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 m0 = _mm_setzero_ps();
+  __m128 m1 = _mm_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    m0 = _mm_max_ps(m0, _mm_and_ps(_mm_loadu_ps(x + i), signMask));
+    m1 = _mm_max_ps(m1, _mm_and_ps(_mm_loadu_ps(x + i + 4), signMask));
+  }
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, _mm_max_ps(m0, m1));
+  peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+  for (; i < n; ++i) peak = std::max(peak, std::fabs(x[i]));
+  return peak;
+}
+
+double sumSquares(const float* x, size_t n) {
+  size_t i = 0;
+  double sum = 0.0;
+#ifdef LOUDNESS_SSE2
+  // Float lanes are fine for one hop (<= ~10k samples); reduce in double
+  __m128 s0 = _mm_setzero_ps();
+  __m128 s1 = _mm_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    const __m128 a = _mm_loadu_ps(x + i);
+    const __m128 b = _mm_loadu_ps(x + i + 4);
+    s0 = _mm_add_ps(s0, _mm_mul_ps(a, a));
+    s1 = _mm_add_ps(s1, _mm_mul_ps(b, b));
+  }
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, _mm_add_ps(s0, s1));
+  sum = double(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#endif
+  for (; i < n; ++i) sum += double(x[i]) * x[i];
+  return sum;
+}
+
+// Deinterleave one channel and convert to float
+template <typename T>
+void extractChannel(const T* in, size_t frames, int channels, int ch, float scale, float* out) {
+  const T* p = in + ch;
+  for (size_t f = 0; f < frames; ++f, p += channels) {
+    out[f] = float(*p) * scale;
+  }
+}
+
+}  // namespace
+
+void LoudnessMeter::configure(int rate, int channels) {
+  rate_ = rate;
+  channels_ = std::clamp(channels, 0, kMaxMeterChannels);
+  subBlockFrames_ = size_t(std::max(1, rate / 10));
+  publishFrames_ = size_t(std::max(1, rate / 60));
+  subBlockFill_ = publishFill_ = 0;
+  totalFrames_ = 0;
+  subBlockCount_ = 0;
+  momentary_ = shortTerm_ = maxMomentary_ = maxShortTerm_ = kFloor;
+  subBlockEnergy_.fill(0.0);
+  intervalPeak_.fill(0.f);
+  intervalSq_.fill(0.0);
+  runPeak_.fill(0.f);
+  runSq_.fill(0.0);
+  gateEnergy_.assign(kHistBins, 0.0);
+  gateCount_.assign(kHistBins, 0);
+  lraCount_.assign(kHistBins, 0);
+
+  // BS.1770 channel weights: 5.1 in GStreamer order (FL FR FC LFE RL RR)
+  weight_.fill(1.0);
+  if (channels_ == 6) {
+    weight_[3] = 0.0;
+    weight_[4] = weight_[5] = 1.41;
+  }
+
+  // K-weighting: high-shelf pre-filter + RLB high-pass, derived for any rate
+  // (same closed form as libebur128, matches the BS.1770 48 kHz table)
+  if (rate_ <= 0) return;
+  double K = std::tan(kPi * 1681.974450955533 / rate_);
+  const double Q1 = 0.7071752369554196;
+  const double Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+  const double Vb = std::pow(Vh, 0.4996667741545416);
+  double a0 = 1.0 + K / Q1 + K * K;
+  const Biquad shelf{(Vh + Vb * K / Q1 + K * K) / a0, 2.0 * (K * K - Vh) / a0,
+                     (Vh - Vb * K / Q1 + K * K) / a0, 2.0 * (K * K - 1.0) / a0,
+                     (1.0 - K / Q1 + K * K) / a0};
+  K = std::tan(kPi * 38.13547087602444 / rate_);
+  const double Q2 = 0.5003270373238773;
+  a0 = 1.0 + K / Q2 + K * K;
+  const Biquad highpass{1.0, -2.0, 1.0, 2.0 * (K * K - 1.0) / a0, (1.0 - K / Q2 + K * K) / a0};
+  for (int ch = 0; ch < kMaxMeterChannels; ++ch) {
+    kFilter_[ch] = {shelf, highpass};
+    scratch_[ch].clear();
+  }
+}
+
+int LoudnessMeter::histBin(double lufs) {
+  const int bin = int((lufs - kHistMin) * 10.0);
+  return std::clamp(bin, 0, kHistBins - 1);
+}
+
+void LoudnessMeter::process(const void* interleaved, size_t frames, SampleFormat fmt) {
+  if (!configured() || !interleaved) return;
+  size_t done = 0;
+  while (done < frames) {
+    // Never straddle a 100 ms hop or a publish interval
+    const size_t n = std::min({frames - done,
+                               subBlockFrames_ - subBlockFill_,
+                               publishFrames_ - publishFill_});
+    for (int ch = 0; ch < channels_; ++ch) {
+      std::vector<float>& buf = scratch_[ch];
+      if (buf.size() < n) buf.resize(std::max(n, subBlockFrames_));
+      float* x = buf.data();
+      switch (fmt) {
+        case SampleFormat::S16:
+          extractChannel(static_cast<const int16_t*>(interleaved) + done * channels_, n, channels_, ch, 1.f / 32768.f, x);
+          break;
+        case SampleFormat::S32:
+          extractChannel(static_cast<const int32_t*>(interleaved) + done * channels_, n, channels_, ch, 1.f / 2147483648.f, x);
+          break;
+        case SampleFormat::F32:
+          extractChannel(static_cast<const float*>(interleaved) + done * channels_, n, channels_, ch, 1.f, x);
+          break;
+        case SampleFormat::F64:
+          extractChannel(static_cast<const double*>(interleaved) + done * channels_, n, channels_, ch, 1.f, x);
+          break;
+      }
+
+      const float peak = peakAbs(x, n);
+      const double sq = sumSquares(x, n);
+      intervalPeak_[ch] = std::max(intervalPeak_[ch], peak);
+      runPeak_[ch] = std::max(runPeak_[ch], peak);
+      intervalSq_[ch] += sq;
+      runSq_[ch] += sq;
+
+      // K-weighting is recursive: scalar, in place
+      for (Biquad& bq : kFilter_[ch]) {
+        double z1 = bq.z1, z2 = bq.z2;
+        for (size_t i = 0; i < n; ++i) {
+          const double in = x[i];
+          const double out = bq.b0 * in + z1;
+          z1 = bq.b1 * in - bq.a1 * out + z2;
+          z2 = bq.b2 * in - bq.a2 * out;
+          x[i] = float(out);
+        }
+        bq.z1 = z1;
+        bq.z2 = z2;
+      }
+      subBlockEnergy_[ch] += sumSquares(x, n);
+    }
+
+    done += n;
+    totalFrames_ += n;
+    subBlockFill_ += n;
+    publishFill_ += n;
+    if (subBlockFill_ == subBlockFrames_) completeSubBlock();
+    if (publishFill_ == publishFrames_) publishSnapshot();
+  }
+}
+
+void LoudnessMeter::completeSubBlock() {
+  double weighted = 0.0;
+  for (int ch = 0; ch < channels_; ++ch) {
+    weighted += weight_[ch] * subBlockEnergy_[ch] / double(subBlockFrames_);
+    subBlockEnergy_[ch] = 0.0;
+  }
+  subBlockFill_ = 0;
+  // Ring of the last 30 hops (3 s)
+  std::memmove(subBlocks_.data(), subBlocks_.data() + 1, sizeof(double) * (subBlocks_.size() - 1));
+  subBlocks_.back() = weighted;
+  subBlockCount_ = std::min<int>(subBlockCount_ + 1, int(subBlocks_.size()));
+
+  if (subBlockCount_ >= 4) {
+    // 400 ms gating block, 75% overlap
+    const double e = (subBlocks_[26] + subBlocks_[27] + subBlocks_[28] + subBlocks_[29]) / 4.0;
+    momentary_ = energyToLufs(e);
+    maxMomentary_ = std::max(maxMomentary_, momentary_);
+    if (momentary_ > kHistMin) {
+      const int bin = histBin(momentary_);
+      gateEnergy_[bin] += e;
+      gateCount_[bin]++;
+    }
+  }
+  if (subBlockCount_ >= 30) {
+    double e = 0.0;
+    for (double v : subBlocks_) e += v;
+    shortTerm_ = energyToLufs(e / 30.0);
+    maxShortTerm_ = std::max(maxShortTerm_, shortTerm_);
+    if (shortTerm_ > kHistMin) lraCount_[histBin(shortTerm_)]++;
+  }
+}
+
+double LoudnessMeter::integratedLufs() const {
+  // Absolute gate already applied on insert; relative gate is -10 LU
+  double energy = 0.0;
+  uint64_t count = 0;
+  for (int i = 0; i < kHistBins; ++i) {
+    energy += gateEnergy_[i];
+    count += gateCount_[i];
+  }
+  if (!count) return kFloor;
+  const double relGate = energyToLufs(energy / double(count)) - 10.0;
+  energy = 0.0;
+  count = 0;
+  for (int i = std::max(0, histBin(relGate)); i < kHistBins; ++i) {
+    energy += gateEnergy_[i];
+    count += gateCount_[i];
+  }
+  return count ? energyToLufs(energy / double(count)) : double(kFloor);
+}
+
+double LoudnessMeter::loudnessRangeLu() const {
+  // EBU Tech 3342: short-term values, -20 LU relative gate, 10th..95th percentile
+  double energy = 0.0;
+  uint64_t count = 0;
+  for (int i = 0; i < kHistBins; ++i) {
+    if (!lraCount_[i]) continue;
+    const double lufs = kHistMin + (i + 0.5) / 10.0;
+    energy += std::pow(10.0, (lufs + 0.691) / 10.0) * double(lraCount_[i]);
+    count += lraCount_[i];
+  }
+  if (!count) return 0.0;
+  const int first = std::max(0, histBin(energyToLufs(energy / double(count)) - 20.0));
+  uint64_t gated = 0;
+  for (int i = first; i < kHistBins; ++i) gated += lraCount_[i];
+  if (!gated) return 0.0;
+  const uint64_t lowIdx = uint64_t(double(gated - 1) * 0.10);
+  const uint64_t highIdx = uint64_t(double(gated - 1) * 0.95);
+  double low = 0.0, high = 0.0;
+  uint64_t seen = 0;
+  bool haveLow = false;
+  for (int i = first; i < kHistBins; ++i) {
+    seen += lraCount_[i];
+    const double lufs = kHistMin + (i + 0.5) / 10.0;
+    if (!haveLow && seen > lowIdx) { low = lufs; haveLow = true; }
+    if (seen > highIdx) { high = lufs; break; }
+  }
+  return high - low;
+}
+
+double LoudnessMeter::channelPeakDb(int ch) const {
+  return ch >= 0 && ch < channels_ ? toDb(runPeak_[ch]) : double(kFloor);
+}
+
+double LoudnessMeter::channelRmsDb(int ch) const {
+  if (ch < 0 || ch >= channels_ || !totalFrames_) return kFloor;
+  return toDb(std::sqrt(runSq_[ch] / double(totalFrames_)));
+}
+
+void LoudnessMeter::publishSnapshot() {
+  LevelSnapshot snap;
+  snap.channels = channels_;
+  for (int ch = 0; ch < channels_; ++ch) {
+    snap.peakDb[ch] = toDb(intervalPeak_[ch]);
+    snap.rmsDb[ch] = toDb(std::sqrt(intervalSq_[ch] / double(publishFill_)));
+    intervalPeak_[ch] = 0.f;
+    intervalSq_[ch] = 0.0;
+  }
+  snap.momentaryLufs = float(momentary_);
+  snap.shortTermLufs = float(shortTerm_);
+  // Integrated walks two small histograms; cheap at display rate
+  snap.integratedLufs = float(integratedLufs());
+  snap.frames = totalFrames_;
+  publishFill_ = 0;
+  published_.publish(snap);
+}
@@ -0,0 +1,126 @@
+// File: src/loudness_meter.h
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr int kMaxMeterChannels = 8;
+
+// One published set of meter values (dBFS / LUFS; -inf reported as -200)
+struct LevelSnapshot {
+  int      channels{0};
+  std::array<float, kMaxMeterChannels> peakDb{};  // sample peak over the interval
+  std::array<float, kMaxMeterChannels> rmsDb{};   // RMS over the interval
+  float    momentaryLufs{-200.f};   // 400 ms window
+  float    shortTermLufs{-200.f};   // 3 s window
+  float    integratedLufs{-200.f};  // gated, since reset
+  uint64_t frames{0};               // total frames analysed
+};
+
+// Single-producer / single-consumer triple buffer: the writer never blocks
+// and the reader always gets the most recent complete value.
+template <typename T>
+class TripleBuffer {
+public:
+  void publish(const T& value) {
+    slots_[back_] = value;
+    const int prev = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel);
+    back_ = prev & kIndexMask;
+  }
+
+  // Returns false when nothing new was published since the last read
+  bool read(T& out) {
+    if (!(middle_.load(std::memory_order_relaxed) & kDirty)) return false;
+    const int prev = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = prev & kIndexMask;
+    out = slots_[front_];
+    return true;
+  }
+
+private:
+  static constexpr int kDirty = 4;
+  static constexpr int kIndexMask = 3;
+  std::array<T, 3> slots_{};
+  std::atomic<int> middle_{1};
+  int back_{0};   // writer-owned
+  int front_{2};  // reader-owned
+};
+
+// Peak/RMS per channel and EBU R128 (ITU-R BS.1770-4) loudness.
+// process() runs on the streaming thread; latest() may be called from any
+// single other thread (the GUI) without locking.
+class LoudnessMeter {
+public:
+  enum class SampleFormat { S16, S32, F32, F64 };
+
+  // Resets all state. channels is clamped to kMaxMeterChannels.
+  void configure(int rate, int channels);
+  bool configured() const { return rate_ > 0 && channels_ > 0; }
+
+  void process(const void* interleaved, size_t frames, SampleFormat fmt);
+
+  bool latest(LevelSnapshot& out) { return published_.read(out); }
+
+  // Whole-run results (call from the processing thread or after it stopped)
+  double integratedLufs() const;
+  double loudnessRangeLu() const;
+  double maxMomentaryLufs() const { return maxMomentary_; }
+  double maxShortTermLufs() const { return maxShortTerm_; }
+  double channelPeakDb(int ch) const;
+  double channelRmsDb(int ch) const;
+  int    channels() const { return channels_; }
+  int    rate() const { return rate_; }
+  uint64_t frames() const { return totalFrames_; }
+
+private:
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+    double z1{0}, z2{0};
+  };
+
+  // 0.1 LU bins from -70 LUFS (absolute gate) to +10 LUFS
+  static constexpr int    kHistBins = 800;
+  static constexpr double kHistMin  = -70.0;
+
+  void completeSubBlock();
+  void publishSnapshot();
+  static int histBin(double lufs);
+
+  int    rate_{0};
+  int    channels_{0};
+  size_t subBlockFrames_{0};   // 100 ms hop
+  size_t subBlockFill_{0};
+  size_t publishFrames_{0};    // ~display rate
+  size_t publishFill_{0};
+  uint64_t totalFrames_{0};
+
+  std::array<double, kMaxMeterChannels> weight_{};
+  std::array<std::array<Biquad, 2>, kMaxMeterChannels> kFilter_{};
+  std::array<std::vector<float>, kMaxMeterChannels> scratch_;
+
+  std::array<double, kMaxMeterChannels> subBlockEnergy_{};  // K-weighted sum of squares
+  std::array<double, 30> subBlocks_{};  // weighted mean square of each 100 ms hop
+  int    subBlockCount_{0};
+
+  // Interval (publish) accumulators
+  std::array<float,  kMaxMeterChannels> intervalPeak_{};
+  std::array<double, kMaxMeterChannels> intervalSq_{};
+  // Whole-run accumulators
+  std::array<float,  kMaxMeterChannels> runPeak_{};
+  std::array<double, kMaxMeterChannels> runSq_{};
+
+  double momentary_{-200.0};
+  double shortTerm_{-200.0};
+  double maxMomentary_{-200.0};
+  double maxShortTerm_{-200.0};
+
+  // Gating histograms: integrated keeps summed energies, LRA only counts
+  std::vector<double>   gateEnergy_;
+  std::vector<uint64_t> gateCount_;
+  std::vector<uint64_t> lraCount_;
+
+  TripleBuffer<LevelSnapshot> published_;
+};
@@ -6,6 +6,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSlider>
+#include <QLabel>
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QDebug>
@@ -18,29 +19,228 @@
 #include <QCoreApplication>
 #include <QIODevice>
 #include <QRegularExpression>
+#include <QCommandLineParser>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QWindow>
+#include <QSocketNotifier>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QJsonArray>
 
 #include <algorithm>
+#include <deque>
 #include <vector>
 #include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <ctime>
 #include <cmath>
 #include <chrono>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 #include <gst/gst.h>
 #include <gst/video/videooverlay.h>
+#include <gst/video/video.h>
+
+#include "loudness_meter.h"
+#include "timeshift_ring.h"
+#include "frame_cache.h"
+#include "reverse_decoder.h"
+#include "position_service.h"
+#include "player_state.h"
+#include "error_recovery.h"
+#include "pipeline_diagnostics.h"
+#include "thread_policy.h"
+#include "decode_scheduler.h"
+#include "decode_worker.h"
+#include "hugepage_allocator.h"
+#include "rendition_pools.h"
+#include "memory_budget.h"
+#include "alloc_tracer.h"
+#include "control_socket.h"
+#include "scenario.h"
+#include "soak_monitor.h"
+#include "percentile.h"
+
+// Process CPU time (user + system) in milliseconds
+static qint64 processCpuMs() {
+#ifdef Q_OS_UNIX
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+  return qint64(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000 +
+         qint64(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+#else
+  return qint64(std::clock()) * 1000 / CLOCKS_PER_SEC;
+#endif
+}
+
+// Page faults taken by this process so far
+static void processPageFaults(qint64& minor, qint64& major) {
+#ifdef Q_OS_UNIX
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0) {
+    minor = ru.ru_minflt;
+    major = ru.ru_majflt;
+    return;
+  }
+#endif
+  minor = major = 0;
+}
+
+// Threads in this process (Linux /proc; 0 when unknown)
+static int processThreadCount() {
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+  while (!status.atEnd()) {
+    const QByteArray line = status.readLine();
+    if (line.startsWith("Threads:")) return line.mid(8).trimmed().toInt();
+  }
+  return 0;
+}
+
+// Open file descriptors (Linux /proc; 0 when unknown)
+static int processFdCount() {
+  const QDir fds("/proc/self/fd");
+  if (!fds.exists()) return 0;
+  return int(fds.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+}
 
-// Simple percentile computation helpers
-static int percentile(std::vector<int>& v, double p) {
-  if (v.empty()) return 0;
-  size_t idx = static_cast<size_t>(std::floor((p/100.0) * (v.size()-1)));
-  std::nth_element(v.begin(), v.begin() + idx, v.end());
-  return v[idx];
+// Resident set size in bytes (Linux /proc; 0 when unknown)
+static qint64 processRssBytes() {
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+  while (!status.atEnd()) {
+    const QByteArray line = status.readLine();
+    if (line.startsWith("VmRSS:")) return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+  }
+  return 0;
+}
+
+// A live or network source (any URI other than file://). Local files are
+// read at disk speed, so a timeshift ring would wrap past their header.
+static bool isStreamSource(const QString& path) {
+  return path.contains("://") && !path.startsWith("file://", Qt::CaseInsensitive);
+}
+
+// RTSP / RTP sources hand out RTP packets, one pad per stream; a byte ring
+// loses the packet framing and decodebin cannot demux what comes back out
+static bool isPacketSource(const QString& uri) {
+  const QString scheme = uri.section("://", 0, 0).toLower();
+  return scheme.startsWith("rtsp") || scheme == "rtp" || scheme == "srtp";
+}
+
+// audioresample profiles: trade resampling quality for CPU per channel.
+//   low-cpu      linear interpolation, no sinc filter
+//   low-latency  short interpolated sinc filter
+//   default      element defaults (quality 4, Blackman-Nuttall, auto filter mode)
+//   high-quality Kaiser window, quality 10, full (non-interpolated) filter
+static bool applyResampleProfile(GstElement* ares, const QString& profile) {
+  if (profile == "low-cpu") {
+    gst_util_set_object_arg(G_OBJECT(ares), "resample-method", "linear");
+    g_object_set(ares, "quality", 0, NULL);
+  } else if (profile == "low-latency") {
+    gst_util_set_object_arg(G_OBJECT(ares), "resample-method", "kaiser");
+    gst_util_set_object_arg(G_OBJECT(ares), "sinc-filter-mode", "interpolated");
+    gst_util_set_object_arg(G_OBJECT(ares), "sinc-filter-interpolation", "linear");
+    g_object_set(ares, "quality", 2, NULL);
+  } else if (profile == "high-quality") {
+    gst_util_set_object_arg(G_OBJECT(ares), "resample-method", "kaiser");
+    gst_util_set_object_arg(G_OBJECT(ares), "sinc-filter-mode", "full");
+    g_object_set(ares, "quality", 10, NULL);
+  } else if (profile != "default") {
+    return false;
+  }
+  return true;
 }
 
+// True for caps a video decoder accepts, i.e. an elementary video stream
+// (containers such as video/quicktime have no decoder). The factory list is
+// built once and kept for the process lifetime.
+static bool isDecodableVideo(GstCaps* caps) {
+  static GList* decoders = gst_element_factory_list_get_elements(
+    GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO,
+    GST_RANK_MARGINAL);
+  GList* match = gst_element_factory_list_filter(decoders, caps, GST_PAD_SINK, FALSE);
+  const bool found = match != nullptr;
+  gst_plugin_feature_list_free(match);
+  return found;
+}
+
+// Maps a raw interleaved audio caps structure to a meter sample format
+static bool meterFormatFromCaps(GstCaps* caps, LoudnessMeter::SampleFormat& fmt, int& rate, int& channels) {
+  if (!caps || gst_caps_is_empty(caps)) return false;
+  const GstStructure* st = gst_caps_get_structure(caps, 0);
+  const gchar* format = gst_structure_get_string(st, "format");
+  const gchar* layout = gst_structure_get_string(st, "layout");
+  if (!format || (layout && g_strcmp0(layout, "interleaved") != 0) ||
+      !gst_structure_get_int(st, "rate", &rate) ||
+      !gst_structure_get_int(st, "channels", &channels) ||
+      channels <= 0 || channels > kMaxMeterChannels) {
+    return false;
+  }
+  if (!g_strcmp0(format, "S16LE"))      fmt = LoudnessMeter::SampleFormat::S16;
+  else if (!g_strcmp0(format, "S32LE")) fmt = LoudnessMeter::SampleFormat::S32;
+  else if (!g_strcmp0(format, "F32LE")) fmt = LoudnessMeter::SampleFormat::F32;
+  else if (!g_strcmp0(format, "F64LE")) fmt = LoudnessMeter::SampleFormat::F64;
+  else return false;
+  return true;
+}
+
+// Pixel throughput counter fed by a pad probe (buffers + CAPS events)
+struct PixelCounter {
+  std::atomic<quint64> pixels{0};
+  std::atomic<quint64> framePixels{0};
+  quint64 lastReported{0};
+};
+
+// Command-line selectable playback options
+struct PlayerOptions {
+  bool audioOnly{false};   // never autoplug/link video decoding
+  bool audioPassthrough{false}; // hand compressed audio to the sink when it accepts it
+  QString audioSink{"autoaudiosink"};
+  QString resampleProfile{"default"};
+  qint64  timeshiftBytes{0};    // >0: play through a timeshift ring of this size
+  QString timeshiftFile;        // mmap-backed ring file (empty: anonymous memory)
+  qint64  frameCacheBytes{0};  // decoded-frame cache budget (0 = off: every frame would be copied)
+  unsigned reverseWorkers{0};  // parallel GOP decoders for reverse playback (0 = auto)
+  bool    loopClip{false};     // seamless whole-clip looping via segment seeks
+  bool    recover{true};       // rebuild and resume after pipeline errors
+  int     stallFrames{15};     // watchdog: frame durations without a sink buffer (0 = off)
+  bool    stallRecover{false}; // watchdog triggers recovery after the dump
+  QString threadPolicy;        // "role:cpus@prio;..." for streaming threads (empty = default)
+  bool    isolatedDecode{false}; // decode video in a child process, present from shared memory
+  bool    hugePages{false};    // 2 MB-page allocator for the video branch's frame pools
+  unsigned renditionFrames{4}; // frames kept per rendition size across switches (0 = off)
+  qint64  renditionCacheBytes{64ll * 1024 * 1024}; // all sizes together; LRU sizes evicted first
+  qint64  memoryBudgetBytes{0}; // per-player memory budget (0 = unbounded)
+  bool    allocTrace{false};   // count buffer/memory allocations per element (tracing hooks)
+  QString controlSocket;       // JSON-RPC control socket path (empty = none)
+  std::vector<ScenarioAction> scenario; // replayed once the window is up (empty = none)
+  QString scenarioOut;         // per-action results, JSON lines
+  QString soakFile;            // soak mode: loop and sample into this CSV (empty = off)
+  double  soakHours{0.0};      // stop the soak and exit after this long (0 = until closed)
+  int     soakIntervalS{60};   // seconds between soak samples
+};
+
 class GstQtPlayer final : public QWidget {
   Q_OBJECT
 public:
-  explicit GstQtPlayer(const QString& filePath, QWidget* parent=nullptr)
-    : QWidget(parent), filePath_(filePath) {
+  explicit GstQtPlayer(const QString& filePath, const PlayerOptions& opts = PlayerOptions(), QWidget* parent=nullptr)
+    : QWidget(parent), filePath_(filePath), audioOnly_(opts.audioOnly),
+      audioPassthrough_(opts.audioPassthrough) {
 
     setWindowTitle("GStreamer + Qt PoC (EN + Metrics)");
     setMinimumSize(800, 480);
@@ -63,8 +263,31 @@ public:
 
     throttleBtn_ = new QPushButton("Simulate bitrate drop", this);
     h->addWidget(throttleBtn_);
+
+    levelLabel_ = new QLabel(this);
+    levelLabel_->setMinimumWidth(260);
+    h->addWidget(levelLabel_);
     vbox->addLayout(h);
 
+    // Frame stepping / A-B loop (served from the decoded-frame cache)
+    auto *h2 = new QHBoxLayout();
+    stepBackBtn_ = new QPushButton("◀ Step", this);
+    h2->addWidget(stepBackBtn_);
+    stepFwdBtn_ = new QPushButton("Step ▶", this);
+    h2->addWidget(stepFwdBtn_);
+    markABtn_ = new QPushButton("Set A", this);
+    h2->addWidget(markABtn_);
+    markBBtn_ = new QPushButton("Set B", this);
+    h2->addWidget(markBBtn_);
+    loopBtn_ = new QPushButton("A-B Loop", this);
+    loopBtn_->setCheckable(true);
+    h2->addWidget(loopBtn_);
+    reverseBtn_ = new QPushButton("◀◀ Reverse", this);
+    reverseBtn_->setCheckable(true);
+    h2->addWidget(reverseBtn_);
+    h2->addStretch();
+    vbox->addLayout(h2);
+
     // ---------- GStreamer init ----------
     static bool gstInitted = false;
     if (!gstInitted) {
@@ -72,13 +295,56 @@ public:
       gstInitted = true;
       qInfo() << "[INIT] GStreamer initialized";
     }
+    if (opts.allocTrace && !AllocTracer::instance().installed()) {
+      AllocTracer::instance().install();
+      qInfo() << "[ALLOC] allocation tracer installed";
+    }
 
     // ---------- Pipeline construction ----------
     pipeline_  = gst_pipeline_new("poc-pipeline");
-    filesrc_   = gst_element_factory_make("filesrc", "src");
+    // Decoder/converter threads come out of the process-wide share
+    DecodeScheduler::instance().attach(pipeline_);
+    // Timeshift feeds decodebin from the ring through appsrc. Only live or
+    // network sources are recorded: a local file fills the ring as fast as it
+    // can be read, and once the ring wraps, its header (the mp4 moov) is gone
+    // and seeking back fails.
+    timeshift_ = opts.timeshiftBytes > 0 && isStreamSource(filePath_);
+    if (opts.timeshiftBytes > 0 && !timeshift_) {
+      if (filePath_.startsWith("file://", Qt::CaseInsensitive)) {
+        gchar* path = gst_filename_from_uri(filePath_.toUtf8().constData(), nullptr);
+        if (path) filePath_ = QString::fromUtf8(path);
+        g_free(path);
+      }
+      qWarning() << "[TIMESHIFT] --timeshift is ignored for local files; playing" << filePath_ << "directly";
+    }
+    if (timeshift_ && isPacketSource(filePath_)) {
+      qFatal("[FATAL] --timeshift needs a byte-stream URI (udp://, tcp://, http://, srt://...); "
+             "RTSP/RTP sources are not supported");
+    }
+    clipLoop_ = opts.loopClip && !timeshift_;
+    isolated_ = opts.isolatedDecode && !timeshift_ && !audioOnly_;
+    recoveryEnabled_ = opts.recover;
+    stallFrames_ = opts.stallFrames;
+    stallRecover_ = opts.stallRecover;
+    if (!opts.threadPolicy.isEmpty()) {
+      std::string err;
+      if (threadPolicy_.parse(opts.threadPolicy.toStdString(), err)) {
+        qInfo().noquote() << "[THREADS] policy" << QString::fromStdString(threadPolicy_.describe());
+      } else {
+        qWarning().noquote() << "[THREADS] ignoring --thread-policy:" << QString::fromStdString(err);
+      }
+    }
+    if (opts.loopClip && timeshift_) {
+      qWarning() << "[CLIPLOOP] --loop is ignored with --timeshift";
+    }
+    if (opts.isolatedDecode && !isolated_) {
+      qWarning() << "[ISOLATE] --isolated-decode is ignored with --timeshift / --audio-only";
+    }
+    source_    = gst_element_factory_make(timeshift_ || isolated_ ? "appsrc" : "filesrc", "src");
     decodebin_ = gst_element_factory_make("decodebin", "dbin");
 
     qVideo_    = gst_element_factory_make("queue", "qv");
+    vselector_ = gst_element_factory_make("input-selector", "vsel");
     vconvert_  = gst_element_factory_make("videoconvert", "vconv");
     vscale_    = gst_element_factory_make("videoscale", "vscale");
     vcaps_     = gst_element_factory_make("capsfilter", "vcaps");
@@ -119,15 +385,22 @@ public:
     qAudio_    = gst_element_factory_make("queue", "qa");
     aconv_     = gst_element_factory_make("audioconvert", "aconv");
     ares_      = gst_element_factory_make("audioresample", "ares");
-    asink_     = gst_element_factory_make("autoaudiosink", "asink");
+    if (ares_ && !applyResampleProfile(ares_, opts.resampleProfile)) {
+      qWarning() << "[INIT] Unknown resample profile" << opts.resampleProfile << "- using element defaults";
+    } else if (ares_) {
+      qInfo() << "[INIT] Resample profile:" << opts.resampleProfile;
+    }
+    asink_     = gst_element_factory_make(opts.audioSink.toUtf8().constData(), "asink");
+    qInfo() << "[INIT] Audio sink:" << opts.audioSink << (audioPassthrough_ ? "(compressed passthrough allowed)" : "");
 
     if (!pipeline_ ||
-        !filesrc_ ||
+        !source_ ||
         !decodebin_ ||
         !qVideo_ ||
         !vconvert_ ||
         !vscale_ ||
         !vcaps_ ||
+        !vselector_ ||
         !vsink_ ||
         !qAudio_ ||
         !aconv_ ||
@@ -142,40 +415,82 @@ public:
       qInfo() << "[INIT] cencdec element created";
     }
 
-    // filesrc -> local path (native path; NOT a URI)
-    g_object_set(filesrc_, "location", filePath_.toUtf8().constData(), NULL);
-    qInfo() << "[PIPELINE] Source file:" << filePath_;
+    setupMemoryBudget(opts);
+
+    if (timeshift_) {
+      setupTimeshift(opts);
+    } else if (isolated_) {
+      setupIsolatedDecode();
+    } else {
+      // filesrc -> local path (native path; NOT a URI)
+      g_object_set(source_, "location", filePath_.toUtf8().constData(), NULL);
+      qInfo() << "[PIPELINE] Source file:" << filePath_;
+    }
 
     // Add elements to bin; gst_bin_add_many tolerates NULL pointers in practice
     gst_bin_add_many(
       GST_BIN(pipeline_),
-      filesrc_,
+      source_,
       decodebin_,
-      qVideo_,
-      vconvert_,
-      vscale_,
-      vcaps_,
-      vsink_,
-      qAudio_,
-      aconv_,
-      ares_,
-      asink_,
       cencdec_,   // optional
       NULL);
+    if (isolated_) {
+      // The worker sends raw video only; an audio sink that is never fed
+      // would never preroll and hold the pipeline out of PLAYING
+      for (GstElement* e : audioBranch()) {
+        gst_object_ref_sink(e);
+      }
+      ownsAudioBranch_ = true;
+    } else {
+      gst_bin_add_many(GST_BIN(pipeline_), qAudio_, aconv_, ares_, asink_, NULL);
+    }
 
-    if (!gst_element_link(filesrc_, decodebin_)) {
-      qFatal("[FATAL] Cannot link filesrc → decodebin");
+    if (!gst_element_link(source_, decodebin_)) {
+      qFatal("[FATAL] Cannot link source → decodebin");
     }
-    if (!gst_element_link_many(qVideo_, vconvert_, vscale_, vcaps_, vsink_, NULL)) {
-      qFatal("[FATAL] Cannot link video branch");
+    if (audioOnly_) {
+      // Video branch never enters the pipeline; compressed video pads are
+      // discarded by a fakesink so the demuxer keeps flowing.
+      for (GstElement* e : videoBranch()) {
+        gst_object_ref_sink(e);
+      }
+      ownsVideoBranch_ = true;
+      vdiscard_ = gst_element_factory_make("fakesink", "vdiscard");
+      if (!vdiscard_) {
+        qFatal("[FATAL] Failed to create fakesink for audio-only mode");
+      }
+      g_object_set(vdiscard_, "sync", FALSE, "async", FALSE, NULL);
+      gst_bin_add(GST_BIN(pipeline_), vdiscard_);
+      disableVideoControls();
+      qInfo() << "[PIPELINE] Audio-only mode: video decoding disabled";
+    } else {
+      gst_bin_add_many(GST_BIN(pipeline_), qVideo_, vscale_, vconvert_, vcaps_, vselector_, vsink_, NULL);
+      // Scale before converting so videoconvert only touches the displayed pixels
+      if (!gst_element_link_many(qVideo_, vscale_, vconvert_, vcaps_, vselector_, vsink_, NULL)) {
+        qFatal("[FATAL] Cannot link video branch");
+      }
+      setupFrameCache(opts);
+      renditionFrames_ = budget_.active() ? budget_.plan().renditionFrames : opts.renditionFrames;
+      renditionCacheBytes_ = opts.renditionCacheBytes;
+      setupFrameMemory(opts);
+      reverseWorkers_ = opts.reverseWorkers;
     }
-    if (!gst_element_link_many(qAudio_, aconv_, ares_, asink_, NULL)) {
+    if (!ownsAudioBranch_ && !gst_element_link_many(qAudio_, aconv_, ares_, asink_, NULL)) {
       qFatal("[FATAL] Cannot link audio branch");
     }
+    if (audioOnly_ || audioPassthrough_) {
+      g_signal_connect(decodebin_, "autoplug-continue", G_CALLBACK(&GstQtPlayer::onAutoplugContinue), this);
+    }
+    attachResampleMonitor();
+    attachLevelMeter();
     qInfo() << "[PIPELINE] Base links established";
 
     // decodebin creates dynamic pads -> hook defensive callback
     g_signal_connect(decodebin_, "pad-added", G_CALLBACK(&GstQtPlayer::onPadAdded), this);
+    // Video decoders get an input probe used for visibility throttling
+    g_signal_connect(decodebin_, "element-added", G_CALLBACK(&GstQtPlayer::onDecodebinElementAdded), this);
+    // Media without video: drop the video branch so the sink doesn't block preroll
+    g_signal_connect(decodebin_, "no-more-pads", G_CALLBACK(&GstQtPlayer::onNoMorePads), this);
 
     // ---------- Bus: async and sync messages ----------
     bus_ = gst_element_get_bus(pipeline_);
@@ -184,6 +499,33 @@ public:
     connect(&busTimer_, &QTimer::timeout, this, &GstQtPlayer::pumpBus);
     busTimer_.start();
 
+    // All play/pause/teardown requests go through the state machine; it
+    // never waits on ASYNC and settles from the bus messages pumped above
+    states_.attach(pipeline_);
+
+    watchdogTimer_.setInterval(250);
+    connect(&watchdogTimer_, &QTimer::timeout, this, &GstQtPlayer::checkStall);
+    watchdogTimer_.start();
+
+    recoveryTimer_.setSingleShot(true);
+    connect(&recoveryTimer_, &QTimer::timeout, this, &GstQtPlayer::runRecovery);
+    recoveryUptime_.start();
+    states_.setListener([this](const PlayerStateMachine::Transition& t) {
+      qInfo().noquote() << QString("[STATE] %1 -> %2 %3 in %4 ms (%5)")
+                             .arg(gst_element_state_get_name(t.from), gst_element_state_get_name(t.to),
+                                  t.ok ? "settled" : "failed/superseded")
+                             .arg(t.ms, 0, 'f', 1).arg(QString::fromStdString(t.reason));
+      if (t.ok && t.to == GST_STATE_PLAYING) {
+        playingSinceUs_ = g_get_monotonic_time();
+      }
+      if (!states_.busy()) {
+        playBtn_->setText(states_.target() == GST_STATE_PLAYING ? "Pause" : "Play");
+      }
+      if (scenarioAwaitPause_ && t.ok && t.to == GST_STATE_PAUSED && !states_.busy()) {
+        scenarioPauseSettled();
+      }
+    });
+
     // Synchronous message for "prepare-window-handle" (ensures correct overlay timing)
     gst_bus_enable_sync_message_emission(bus_);
     g_signal_connect(
@@ -191,27 +533,134 @@ public:
       "sync-message::element",
       G_CALLBACK(&GstQtPlayer::onSyncMessage),
       this);
+    // Streaming tasks get their pool before they start (CREATE is synchronous)
+    if (threadPolicy_.active()) {
+      g_signal_connect(bus_, "sync-message::stream-status",
+                       G_CALLBACK(&GstQtPlayer::onStreamStatus), this);
+    }
+
+    // GUI side of the level meter: read the latest snapshot at display rate
+    meterTimer_.setInterval(16);
+    connect(&meterTimer_, &QTimer::timeout, this, &GstQtPlayer::updateLevelMeter);
+    meterTimer_.start();
 
     // ---------- Controls ----------
     connect(playBtn_, &QPushButton::clicked, this, &GstQtPlayer::togglePlayPause);
     connect(throttleBtn_, &QPushButton::clicked, this, &GstQtPlayer::toggleQuality);
+    connect(stepBackBtn_, &QPushButton::clicked, this, [this] { stepFrame(-1); });
+    connect(stepFwdBtn_, &QPushButton::clicked, this, [this] { stepFrame(+1); });
+    connect(markABtn_, &QPushButton::clicked, this, [this] { markLoopPoint(true); });
+    connect(markBBtn_, &QPushButton::clicked, this, [this] { markLoopPoint(false); });
+    connect(loopBtn_, &QPushButton::toggled, this, &GstQtPlayer::setLooping);
+    loopTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&loopTimer_, &QTimer::timeout, this, &GstQtPlayer::advanceCachedLoop);
+    connect(reverseBtn_, &QPushButton::toggled, this, &GstQtPlayer::setReverse);
+    reverseTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&reverseTimer_, &QTimer::timeout, this, &GstQtPlayer::advanceReverse);
 
-    sliderTimer_.setInterval(200);
+    // Position is interpolated (no pipeline query), so the slider can follow
+    // the display refresh rate
+    sliderTimer_.setTimerType(Qt::PreciseTimer);
+    setSliderRate(QGuiApplication::primaryScreen());
     connect(&sliderTimer_, &QTimer::timeout, this, &GstQtPlayer::updatePosition);
     sliderTimer_.start();
     connect(slider_, &QSlider::sliderReleased, this, &GstQtPlayer::doSeek);
+
+    // ---------- Auto-fit (decode output follows videoArea_ size) ----------
+    if (const char* envFit = std::getenv("GST_QT_AUTOFIT")) {
+      autoFit_ = std::atoi(envFit) != 0;
+    }
+    qInfo() << "[AUTOFIT]" << (autoFit_ ? "enabled" : "disabled (GST_QT_AUTOFIT=0)");
+    fitTimer_.setSingleShot(true);
+    fitTimer_.setInterval(150);
+    connect(&fitTimer_, &QTimer::timeout, this, &GstQtPlayer::applyAutoFit);
+    attachPixelCounters();
+
+    // ---------- Resize coalescing ----------
+    overlayTimer_.setSingleShot(true);
+    connect(&overlayTimer_, &QTimer::timeout, this, &GstQtPlayer::applyOverlayGeometry);
+    resizeIdleTimer_.setSingleShot(true);
+    resizeIdleTimer_.setInterval(250);
+    connect(&resizeIdleTimer_, &QTimer::timeout, this, &GstQtPlayer::endResizeBurst);
+
+    // ---------- Visibility throttling (GST_QT_HIDDEN_MODE=off|keyframes|skip) ----------
+    if (const char* envHidden = std::getenv("GST_QT_HIDDEN_MODE")) {
+      const QByteArray m = QByteArray(envHidden).toLower();
+      if (m == "off") hiddenMode_ = ThrottleNone;
+      else if (m == "skip") hiddenMode_ = ThrottleSkip;
+      else hiddenMode_ = ThrottleKeyframes;
+    }
+    qInfo() << "[VISIBILITY] hidden mode =" << throttleName(hiddenMode_);
+    visibleCpuMs_ = processCpuMs();
+    visibleWall_.start();
+
+    if (!opts.controlSocket.isEmpty()) {
+      setupControlSocket(opts.controlSocket);
+    }
+    if (!opts.scenario.empty()) {
+      setupScenario(opts);
+    }
+    if (!opts.soakFile.isEmpty()) {
+      setupSoak(opts);
+    }
   }
 
   ~GstQtPlayer() override {
+    if (soakActive_) {
+      finishSoak(false);
+    }
+    qDeleteAll(findChildren<QSocketNotifier*>());
+    control_.close();
+    reverse_.stop();
+    stopPresenter();
+    {
+      std::lock_guard<std::mutex> lock(prewarmMutex_);
+      prewarmJobs_.clear();
+    }
+    if (prewarmThread_.joinable()) prewarmThread_.join();
+    if (recPipeline_) {
+      gst_element_set_state(recPipeline_, GST_STATE_NULL);
+    }
+    // Wake a need-data callback blocked on the ring before stopping playback
+    ring_.cancelReads();
+    isolatedStopping_ = true;
     if (pipeline_) {
       gst_element_set_state(pipeline_, GST_STATE_NULL);
+      DecodeScheduler::instance().detach(pipeline_);
     }
+    worker_.stop();
+    detachSinkProbe();
     if (bus_) {
       gst_object_unref(bus_);
     }
     if (pipeline_) {
       gst_object_unref(pipeline_);
     }
+    if (ownsVideoBranch_) {
+      for (GstElement* e : videoBranch()) {
+        gst_object_unref(e);
+      }
+    }
+    if (ownsAudioBranch_) {
+      for (GstElement* e : audioBranch()) {
+        gst_object_unref(e);
+      }
+    }
+    if (cachePad_) {
+      gst_object_unref(cachePad_);
+    }
+    if (hugeAllocator_) {
+      gst_object_unref(hugeAllocator_);
+    }
+    if (budget_.active()) {
+      budgetShare().players--;
+    }
+    if (recBus_) {
+      gst_object_unref(recBus_);
+    }
+    if (recPipeline_) {
+      gst_object_unref(recPipeline_);
+    }
   }
 
 protected:
@@ -219,30 +668,77 @@ protected:
     QWidget::showEvent(e);
     // Extra native window guarantee
     videoArea_->winId();
+    setSliderRate(screen());
+    // Track expose/obscure of the top-level window
+    if (windowHandle() && !exposeFilterInstalled_) {
+      windowHandle()->installEventFilter(this);
+      exposeFilterInstalled_ = true;
+    }
+    updateVisibility();
+  }
+
+  void hideEvent(QHideEvent* e) override {
+    QWidget::hideEvent(e);
+    updateVisibility();
+  }
+
+  void changeEvent(QEvent* e) override {
+    QWidget::changeEvent(e);
+    if (e->type() == QEvent::WindowStateChange) {
+      updateVisibility();
+    }
+  }
+
+  bool eventFilter(QObject* obj, QEvent* e) override {
+    if (obj == windowHandle() && e->type() == QEvent::Expose) {
+      // Deliver after QWindow updated its exposed state
+      QMetaObject::invokeMethod(this, [this] { updateVisibility(); }, Qt::QueuedConnection);
+    }
+    return QWidget::eventFilter(obj, e);
   }
 
   void resizeEvent(QResizeEvent* e) override {
     QWidget::resizeEvent(e);
-    if (GST_IS_VIDEO_OVERLAY(vsink_)) {
-      gst_video_overlay_set_render_rectangle(
-        GST_VIDEO_OVERLAY(vsink_),
-        0,
-        0,
-        videoArea_->width(),
-        videoArea_->height());
-      gst_video_overlay_expose(GST_VIDEO_OVERLAY(vsink_));
+    // Coalesce: only the latest geometry is applied, at most once per display frame
+    resizeEvents_++;
+    if (!resizing_) {
+      resizing_ = true;
+      resizeBurstEvents_ = 0;
+      resizeBurstExposes_ = 0;
+      std::lock_guard<std::mutex> lock(resizeFramesMutex_);
+      resizeFrames_.clear();
+    }
+    resizeBurstEvents_++;
+    overlayDirty_ = true;
+    if (!overlayTimer_.isActive()) {
+      const qreal hz = screen() ? screen()->refreshRate() : 60.0;
+      overlayTimer_.start(std::max(1, int(1000.0 / (hz > 0 ? hz : 60.0))));
+    }
+    resizeIdleTimer_.start();
+    // Debounced: renegotiate only once the user stops resizing
+    if (autoFit_) {
+      fitTimer_.start();
     }
   }
 
 private slots:
   void togglePlayPause() {
     if (!pipeline_) return;
-    GstState cur, pend;
-    gst_element_get_state(pipeline_, &cur, &pend, 0);
+    GstState cur = states_.target();
+    if (reversing_) {
+      reverseBtn_->setChecked(false);
+    }
+    if (cacheMode_) {
+      // Back from stepping/looping: resume decoding at the shown frame
+      leaveCacheMode();
+      cur = GST_STATE_PAUSED;
+    }
     if (cur == GST_STATE_PLAYING) {
-      gst_element_set_state(pipeline_, GST_STATE_PAUSED);
+      const auto r = states_.request(GST_STATE_PAUSED, "user");
+      qInfo() << "[STATE] -> PAUSED" << PlayerStateMachine::resultName(r);
+      if (r == PlayerStateMachine::Result::Rejected) return;
       playBtn_->setText("Play");
-      qInfo() << "[STATE] PLAYING -> PAUSED";
+      reportSessionCpu();
     } else {
       // Start TTFF stopwatch on each transition to PLAYING
       playStartTimer_.restart();
@@ -250,22 +746,30 @@ private slots:
       frames_.clear();
       frameCount_ = 0;
       lastPts_ = GST_CLOCK_TIME_NONE;
-      gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+      sessionCpuMs_ = processCpuMs();
+      processPageFaults(sessionMinorFaults_, sessionMajorFaults_);
+      if (AllocTracer::instance().installed()) AllocTracer::instance().reset();
+      sessionWall_.start();
+      const auto r = states_.request(GST_STATE_PLAYING, "user");
+      qInfo() << "[STATE] -> PLAYING" << PlayerStateMachine::resultName(r) << "(TTFF timer armed)";
+      if (r == PlayerStateMachine::Result::Rejected) return;
       playBtn_->setText("Pause");
-      qInfo() << "[STATE] -> PLAYING (TTFF timer armed)";
       // Install sink pad probe (if not already) to capture first frame and intervals
       attachSinkProbeIfNeeded();
     }
   }
 
   void pumpBus() {
+    pumpRecordBus();
     while (true) {
       GstMessage* msg = gst_bus_pop(bus_);
       if (!msg) {
         break;
       }
+      states_.handleMessage(msg);
       switch (GST_MESSAGE_TYPE(msg)) {
         case GST_MESSAGE_ERROR: {
+          const bool wasPlaying = states_.target() == GST_STATE_PLAYING;
           GError* err = nullptr;
           gchar* dbg = nullptr;
           gst_message_parse_error(msg, &err, &dbg);
@@ -277,13 +781,50 @@ private slots:
           if (err) {
             g_error_free(err);
           }
-          gst_element_set_state(pipeline_, GST_STATE_READY);
+          states_.request(GST_STATE_READY, "error", true);
           playBtn_->setText("Play");
+          if (recoveryEnabled_) {
+            GstElement* failingSink = nullptr;
+            const ErrorContext ctx{source_, decodebin_, cencdec_, ownsVideoBranch_ ? nullptr : vsink_, asink_};
+            const ErrorClass cls = classifyError(msg, ctx, &failingSink);
+            scheduleRecovery(cls, failingSink, wasPlaying);
+          }
           break;
         }
+        case GST_MESSAGE_STATE_CHANGED:
+          if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline_)) {
+            GstState oldState, newState;
+            gst_message_parse_state_changed(msg, &oldState, &newState, nullptr);
+            positions_.setPlaying(newState == GST_STATE_PLAYING);
+          }
+          break;
+        case GST_MESSAGE_DURATION_CHANGED:
+          positions_.invalidateDuration();
+          qInfo() << "[POSITION] duration changed; re-query on next tick";
+          break;
+        case GST_MESSAGE_ASYNC_DONE:
+          if (GST_MESSAGE_SRC(msg) != GST_OBJECT(pipeline_)) break;
+          if (recoveryStage_ == RecoveryPrerolling || recoveryStage_ == RecoverySeeking) {
+            continueRecovery();
+          } else if (clipLoop_ && !clipLoopArmed_) {
+            armClipLoop();
+          }
+          break;
+        case GST_MESSAGE_SEGMENT_DONE:
+          if (clipLoop_) {
+            restartClipLoop();
+          }
+          break;
         case GST_MESSAGE_EOS:
+          if (clipLoop_) {
+            // Segment mode got lost (e.g. a seek without the flag): loop with a flush
+            qWarning() << "[CLIPLOOP] EOS instead of SEGMENT_DONE; flushing restart";
+            seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH), 0);
+            break;
+          }
           qInfo() << "[GST] EOS";
-          gst_element_set_state(pipeline_, GST_STATE_READY);
+          reportSessionCpu();
+          states_.request(GST_STATE_READY, "eos");
           playBtn_->setText("Play");
           break;
         default: break;
@@ -296,12 +837,39 @@ private slots:
     if (!pipeline_) {
       return;
     }
-    gint64 pos=0, dur=0;
-    if (gst_element_query_position(pipeline_, GST_FORMAT_TIME, &pos) &&
-        gst_element_query_duration(pipeline_, GST_FORMAT_TIME, &dur) &&
-        dur > 0) {
+    if (timeshift_) {
+      // Slider spans the ring window; value is the playhead inside it
+      const qint64 oldest = ring_.oldestTime();
+      const int windowMs = int((ring_.headTime() - oldest) / 1000000);
+      const int posMs = int((ringPlayheadTime() - oldest) / 1000000);
+      slider_->blockSignals(true);
+      slider_->setRange(0, std::max(0, windowMs));
+      slider_->setValue(std::clamp(posMs, 0, std::max(0, windowMs)));
+      slider_->blockSignals(false);
+      return;
+    }
+    if (cacheMode_) {
+      // Frames come from RAM; follow what is on screen
+      slider_->blockSignals(true);
+      slider_->setValue(int(GstClockTime(shownPts_) / GST_MSECOND));
+      slider_->blockSignals(false);
+      return;
+    }
+    const GstClockTime pos = positions_.position();
+    if (!GST_CLOCK_TIME_IS_VALID(pos)) return;
+    if (recoveryStage_ == RecoveryIdle) {
+      lastGoodPos_ = pos;
+    }
+    if (looping_ && pos >= loopB_) {
+      loopWrapped();
+      return;
+    }
+    const GstClockTime dur = positions_.duration();
+    if (GST_CLOCK_TIME_IS_VALID(dur) && dur > 0 && !slider_->isSliderDown()) {
       const int msPos = int(pos / GST_MSECOND);
       const int msDur = int(dur / GST_MSECOND);
+      sliderTicks_++;
+      if (slider_->maximum() == msDur && slider_->value() == msPos) return;
       slider_->blockSignals(true);
       slider_->setRange(0, msDur);
       slider_->setValue(msPos);
@@ -309,17 +877,39 @@ private slots:
     }
   }
 
+  void setSliderRate(QScreen* s) {
+    const qreal hz = s ? s->refreshRate() : 60.0;
+    sliderTimer_.setInterval(std::max(1, int(1000.0 / (hz > 0 ? hz : 60.0))));
+  }
+
+  void reportPositionService() {
+    qInfo().noquote() << QString("[POSITION] slider ticks=%1 interpolated=%2 position-queries=%3 duration-queries=%4")
+                           .arg(sliderTicks_).arg(positions_.interpolated())
+                           .arg(positions_.positionQueries()).arg(positions_.durationQueries());
+  }
+
   void doSeek() {
+    seekTo(GstClockTime(slider_->value()) * GST_MSECOND, false);
+  }
+
+  // Slider and control-socket seeks; keeps the playback rate set via setPlaybackRate()
+  void seekTo(GstClockTime target, bool accurate) {
     if (!pipeline_) {
       return;
     }
-    const gint64 target = (gint64)slider_->value() * GST_MSECOND;
-    qInfo() << "[SEEK] to (ms):" << slider_->value();
-    gst_element_seek_simple(
-      pipeline_,
+    if (timeshift_) {
+      seekInRing(ring_.oldestTime() + qint64(target));
+      return;
+    }
+    if (looping_) loopBtn_->setChecked(false);
+    if (reversing_) reverseBtn_->setChecked(false);
+    leaveCacheMode(false);
+    qInfo() << "[SEEK] to (ms):" << qint64(target / GST_MSECOND);
+    gst_element_seek(
+      pipeline_, rate_,
       GST_FORMAT_TIME,
-      (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT),
-      target);
+      seekFlags(GST_SEEK_FLAG_FLUSH | (accurate ? GST_SEEK_FLAG_ACCURATE : GST_SEEK_FLAG_KEY_UNIT)),
+      GST_SEEK_TYPE_SET, gint64(target), GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
     // After seeks, we reset metrics to measure new segment if desired
     lastPts_ = GST_CLOCK_TIME_NONE;
     frames_.clear();
@@ -332,134 +922,848 @@ private slots:
     if (!pipeline_ || !vcaps_) return;
 
     qInfo() << "[ABR] Toggling quality. Current lowQuality =" << (lowQuality_ ? "true" : "false");
-    // Pause briefly for safe renegotiation
-    gst_element_set_state(pipeline_, GST_STATE_PAUSED);
+    // The capsfilter renegotiates on the fly; no state change needed, and the
+    // user's play/pause request stays in charge
 
     if (!lowQuality_) {
       // Force smaller resolution (reduced quality)
-      GstCaps* caps = gst_caps_new_simple(
-        "video/x-raw",
-        "width",  G_TYPE_INT, 640,
-        "height", G_TYPE_INT, 360,
-        NULL);
-      g_object_set(vcaps_, "caps", caps, NULL);
-      gst_caps_unref(caps);
-
-      // Signal downstream reconfigure
-      gst_element_send_event(vscale_, gst_event_new_reconfigure());
-
       lowQuality_ = true;
+      applyVideoCaps();
       throttleBtn_->setText("Restore quality");
       qInfo() << "[ABR] Low quality enforced: 640x360";
     } else {
-      // Remove restriction → allow renegotiation to full-res
-      g_object_set(vcaps_, "caps", NULL, NULL);
-      gst_element_send_event(vscale_, gst_event_new_reconfigure());
-
+      // Remove restriction → back to full-res (or the auto-fit size)
       lowQuality_ = false;
+      applyVideoCaps();
       throttleBtn_->setText("Simulate bitrate drop");
-      qInfo() << "[ABR] Quality restored (caps removed)";
+      qInfo() << "[ABR] Quality restored";
     }
+  }
 
-    // Resume playback
-    gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+  // Media turned out to have no video: take the video branch out of the
+  // pipeline (GUI thread) so the sink stops holding back preroll.
+  void dropVideoBranch() {
+    if (ownsVideoBranch_ || videoLinked_) return;
+    qInfo() << "[PIPELINE] No video stream; removing video branch (automatic audio-only)";
+    for (GstElement* e : videoBranch()) {
+      gst_object_ref(e);
+      gst_element_set_locked_state(e, TRUE);
+      gst_element_set_state(e, GST_STATE_NULL);
+      gst_bin_remove(GST_BIN(pipeline_), e);
+    }
+    ownsVideoBranch_ = true;
+    videoDropped_ = true;
+    disableVideoControls();
+    // The buffer probe and position service sat on the removed vsink_ pad:
+    // without moving them there is no TTFF, no slider and a false stall
+    moveSinkProbe();
   }
 
-private:
-  // ---------- GStreamer callbacks ----------
-  static void onSyncMessage(GstBus*, GstMessage* msg, gpointer userData) {
-    if (!gst_is_video_overlay_prepare_window_handle_message(msg)) {
+  // Puts the buffer probe back on whichever sink now carries the timing
+  void moveSinkProbe() {
+    const bool probed = sinkProbeAttached_;
+    detachSinkProbe();
+    if (probed) attachSinkProbeIfNeeded();
+  }
+
+  // Undoes an automatic dropVideoBranch() before the next file (pipeline in
+  // NULL). Removal unlinked every pad, the frame-cache selector inputs too.
+  void restoreVideoBranch() {
+    if (!videoDropped_) return;
+    for (GstElement* e : videoBranch()) {
+      gst_bin_add(GST_BIN(pipeline_), e);
+      gst_element_set_locked_state(e, FALSE);
+      gst_object_unref(e);
+    }
+    bool linked = gst_element_link_many(qVideo_, vscale_, vconvert_, vcaps_, NULL) &&
+                  gst_element_link(vselector_, vsink_);
+    GstPad* tap = gst_element_get_static_pad(vcaps_, "src");
+    linked = linked && gst_pad_link(tap, mainSelPad_) == GST_PAD_LINK_OK;
+    gst_object_unref(tap);
+    if (cachePad_ && cacheSelPad_) {
+      gst_pad_link_full(cachePad_, cacheSelPad_, GST_PAD_LINK_CHECK_NOTHING);
+    }
+    if (!linked) {
+      qWarning() << "[PIPELINE] Cannot relink the video branch; staying audio-only";
+      for (GstElement* e : videoBranch()) {
+        gst_object_ref(e);
+        gst_element_set_locked_state(e, TRUE);
+        gst_bin_remove(GST_BIN(pipeline_), e);
+      }
       return;
     }
-    auto* self = static_cast<GstQtPlayer*>(userData);
+    videoDropped_ = false;
+    ownsVideoBranch_ = false;
+    enableVideoControls();
+    moveSinkProbe();
+    qInfo() << "[PIPELINE] Video branch restored for the next file";
+  }
 
-    // Ensure a native window exists
-    self->videoArea_->setAttribute(Qt::WA_NativeWindow);
-    WId wid = self->videoArea_->winId();
-    if (!wid || wid < 0x10) {
-      qWarning() << "[OVERLAY] Invalid window id during prepare-window-handle";
-      return; // avoid BadWindow
+  void updateLevelMeter() {
+    LevelSnapshot snap;
+    if (!levelMeter_.latest(snap) || snap.channels <= 0) return;
+    QString text;
+    for (int ch = 0; ch < std::min(snap.channels, 2); ++ch) {
+      text += QString("%1 %2/%3 dB  ").arg(ch == 0 ? "L" : "R")
+                .arg(snap.peakDb[ch], 0, 'f', 1).arg(snap.rmsDb[ch], 0, 'f', 1);
     }
+    text += QString("M %1  I %2 LUFS").arg(snap.momentaryLufs, 0, 'f', 1).arg(snap.integratedLufs, 0, 'f', 1);
+    levelLabel_->setText(text);
+  }
 
-    if (GST_IS_VIDEO_OVERLAY(self->vsink_)) {
-      gst_video_overlay_set_window_handle(
-        GST_VIDEO_OVERLAY(self->vsink_),
-        (guintptr)wid);
-      gst_video_overlay_set_render_rectangle(
-        GST_VIDEO_OVERLAY(self->vsink_),
-        0,
-        0,
-        self->videoArea_->width(),
-        self->videoArea_->height());
-      gst_video_overlay_expose(GST_VIDEO_OVERLAY(self->vsink_));
-      qInfo() << "[OVERLAY] Window handle set";
+  // ---------- Frame stepping / A-B loop ----------
+  void stepFrame(int dir) {
+    if (!pipeline_ || ownsVideoBranch_ || !cachePad_) return;
+    if (looping_) loopBtn_->setChecked(false);
+    if (reversing_) reverseBtn_->setChecked(false);
+    if (states_.target() == GST_STATE_PLAYING) {
+      states_.request(GST_STATE_PAUSED, "step");
+      playBtn_->setText("Play");
+    }
+    const GstClockTime at = shownPts_;
+    if (!GST_CLOCK_TIME_IS_VALID(at)) return;
+    stepTimer_.restart();
+    stepPending_ = true;
+    GstSample* sample = dir > 0 ? frameCache_.next(at) : frameCache_.prev(at);
+    stepFromCache_ = sample != nullptr;
+    if (sample) {
+      enterCacheMode();
+      presentCached(sample);
+    } else {
+      // Miss: decode it. Accurate seek lands on the exact frame (re-decodes the GOP).
+      if (cacheMode_) leaveCacheMode(false);
+      const GstClockTime dur = frameCache_.frameDuration();
+      const GstClockTime target = dir > 0 ? at + dur : (at > dur ? at - dur : 0);
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), target);
     }
+    reportFrameCache();
   }
 
-  // Robust, instrumented onPadAdded implementing cencdec routing + fallback
-  static void onPadAdded(GstElement* dbin, GstPad* newPad, gpointer userData) {
-    auto* self = static_cast<GstQtPlayer*>(userData);
-    if (!self) return;
+  void markLoopPoint(bool isA) {
+    const GstClockTime pts = shownPts_;
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+    (isA ? loopA_ : loopB_) = pts;
+    qInfo() << "[LOOP]" << (isA ? "A" : "B") << "=" << pts / GST_MSECOND << "ms";
+  }
 
-    if (gst_pad_get_direction(newPad) != GST_PAD_SRC) {
+  // Loops decode normally until the whole A-B range is cached, then replay
+  // from RAM (video only, paused pipeline) with no seeks at all.
+  void setLooping(bool on) {
+    if (on && (!GST_CLOCK_TIME_IS_VALID(loopA_) || !GST_CLOCK_TIME_IS_VALID(loopB_) || loopB_ <= loopA_)) {
+      qWarning() << "[LOOP] Set A and B (A before B) first";
+      loopBtn_->setChecked(false);
+      return;
+    }
+    if (on && reversing_) reverseBtn_->setChecked(false);
+    looping_ = on;
+    if (!on) {
+      loopTimer_.stop();
+      qInfo() << "[LOOP] off";
       return;
     }
+    loopPasses_ = 0;
+    qInfo() << "[LOOP] A-B" << loopA_ / GST_MSECOND << "-" << loopB_ / GST_MSECOND << "ms";
+    loopWrapped();
+  }
 
-    GstCaps* caps = gst_pad_get_current_caps(newPad);
-    if (!caps) {
-      caps = gst_pad_query_caps(newPad, nullptr);
+  void loopWrapped() {
+    loopPasses_++;
+    if (frameCache_.covers(loopA_, loopB_)) {
+      if (!cacheMode_) {
+        states_.request(GST_STATE_PAUSED, "ab-loop");
+        enterCacheMode();
+        qInfo() << "[LOOP] range fully cached; replaying from RAM";
+      }
+      loopPos_ = GST_CLOCK_TIME_NONE;
+      loopTimer_.start(int(std::max<GstClockTime>(1, frameCache_.frameDuration() / GST_MSECOND)));
+      advanceCachedLoop();
+    } else {
+      if (cacheMode_) leaveCacheMode(false);
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), loopA_);
+      states_.request(GST_STATE_PLAYING, "ab-loop");
+      playBtn_->setText("Pause");
     }
-    if (!caps || gst_caps_is_empty(caps)) {
-      if (caps) gst_caps_unref(caps);
-      qWarning() << "[DECODEBIN] pad-added with empty caps";
+    reportFrameCache();
+  }
+
+  void advanceCachedLoop() {
+    GstSample* sample = GST_CLOCK_TIME_IS_VALID(loopPos_) ? frameCache_.next(loopPos_)
+                                                          : frameCache_.atOrAfter(loopA_);
+    GstBuffer* buf = sample ? gst_sample_get_buffer(sample) : nullptr;
+    if (buf && GST_BUFFER_PTS(buf) > loopB_) {
+      gst_sample_unref(sample);
+      loopTimer_.stop();
+      loopWrapped();
+      return;
+    }
+    if (!sample) {
+      // Evicted meanwhile: fall back to decoding
+      loopTimer_.stop();
+      loopWrapped();
       return;
     }
+    loopPos_ = GST_BUFFER_PTS(buf);
+    presentCached(sample);
+  }
 
-    const GstStructure* st = gst_caps_get_structure(caps, 0);
-    if (!st) {
-      gst_caps_unref(caps);
-      qWarning() << "[DECODEBIN] pad-added but no structure";
+  // ---------- Error recovery ----------
+  // ERROR → READY (state machine) → backoff → rebuild → PAUSED → seek back
+  // to the last rendered position → previous state. Sink errors rebuild only
+  // that sink; everything else resets the whole pipeline to NULL so the
+  // source is reopened and decodebin re-autoplugs.
+  void scheduleRecovery(ErrorClass cls, GstElement* failingSink, bool wasPlaying) {
+    if (recoveryStage_ == RecoveryScheduled) {
+      // Error burst from one failure: escalate to a full reset if needed
+      if (cls != ErrorClass::Sink || failingSink != recoverySink_) {
+        recoveryClass_ = (recoveryClass_ == ErrorClass::Sink && cls == ErrorClass::Sink) ? ErrorClass::Other : cls;
+        recoverySink_ = nullptr;
+      }
       return;
     }
-    const gchar* name = gst_structure_get_name(st);
-    if (!name) {
-      gst_caps_unref(caps);
-      qWarning() << "[DECODEBIN] pad-added but structure has no name";
+    if (recoveryStage_ == RecoveryIdle) {
+      recoveryClock_.start();
+      recoveryPos_ = lastGoodPos_;
+      recoveryWasPlaying_ = wasPlaying;
+    } else {
+      recoveryStats_.failedAttempts++;
+      recoveryFramePending_ = false;
+    }
+    if (backoff_.exhausted(recoveryUptime_.elapsed())) {
+      qCritical() << "[RECOVERY] giving up after" << backoff_.attempts() << "attempts";
+      recoveryStage_ = RecoveryIdle;
+      recoveryClock_.invalidate();
       return;
     }
+    recoveryClass_ = cls;
+    recoverySink_ = failingSink;
+    recoveryStage_ = RecoveryScheduled;
+    const int delay = backoff_.nextDelayMs(recoveryUptime_.elapsed());
+    recoveryTimer_.start(delay);
+    qWarning().noquote() << QString("[RECOVERY] %1 error; %2 in %3 ms (attempt %4, resume at %5 ms)")
+                              .arg(errorClassName(cls))
+                              .arg(cls == ErrorClass::Sink && failingSink ? "rebuilding sink" : "resetting pipeline")
+                              .arg(delay).arg(backoff_.attempts())
+                              .arg(GST_CLOCK_TIME_IS_VALID(recoveryPos_) ? qint64(recoveryPos_ / GST_MSECOND) : 0);
+  }
 
-    // log caps (free string afterwards)
-    gchar* caps_str = gst_caps_to_string(caps);
-    qInfo() << "[DECODEBIN] pad-added caps:" << (caps_str ? caps_str : "(null)") << " name=" << name;
-    if (caps_str) g_free(caps_str);
-
-    const bool isVideo = g_str_has_prefix(name, "video/");
-    const bool isAudio = g_str_has_prefix(name, "audio/");
+  // Drops a scheduled or running recovery and its history (new file)
+  void cancelRecovery() {
+    if (recoveryStage_ != RecoveryIdle) {
+      qInfo() << "[RECOVERY] cancelled";
+    }
+    recoveryTimer_.stop();
+    recoveryStage_ = RecoveryIdle;
+    recoveryFramePending_ = false;
+    recoveryClock_.invalidate();
+    recoveryPos_ = GST_CLOCK_TIME_NONE;
+    recoverySink_ = nullptr;
+    backoff_.reset();
+  }
 
-    // Detect encrypted variants commonly used with CENC
-    const bool isCenc = g_str_has_prefix(name, "application/x-cenc") ||
-                        g_str_has_prefix(name, "video/encv") ||
-                        g_str_has_prefix(name, "audio/enca");
+  void runRecovery() {
+    if (recoveryStage_ != RecoveryScheduled) return;
+    if (recoveryClass_ == ErrorClass::Sink && recoverySink_ && rebuildSink(recoverySink_ == vsink_)) {
+      qInfo() << "[RECOVERY] sink rebuilt";
+    } else {
+      states_.request(GST_STATE_NULL, "recovery");
+      restoreAudioChain();
+      clipLoopArmed_ = false;
+      qInfo() << "[RECOVERY] pipeline reset to NULL";
+    }
+    recoveryStage_ = RecoveryPrerolling;
+    firstFrameSeen_ = false;
+    lastPts_ = GST_CLOCK_TIME_NONE;
+    const bool seekBack = !timeshift_ && GST_CLOCK_TIME_IS_VALID(recoveryPos_) && recoveryPos_ > 0;
+    // Without a seek the preroll frame is already the resume frame
+    recoveryFramePending_ = !seekBack;
+    if (states_.request(GST_STATE_PAUSED, "recovery") == PlayerStateMachine::Result::Rejected) {
+      // A failed attempt like any other: backoff, counted against the limit,
+      // and a full reset next time
+      qWarning() << "[RECOVERY] PAUSED rejected; retrying";
+      scheduleRecovery(ErrorClass::Other, nullptr, recoveryWasPlaying_);
+    }
+  }
 
-    GstElement* targetQueue = isVideo ? self->qVideo_ : (isAudio ? self->qAudio_ : nullptr);
-    if (!targetQueue) {
-      qWarning() << "[DECODEBIN] Ignoring pad with caps:" << name;
-      gst_caps_unref(caps);
+  // ASYNC_DONE while recovering: first the preroll, then the seek-back
+  void continueRecovery() {
+    if (recoveryStage_ == RecoveryPrerolling && !timeshift_ &&
+        GST_CLOCK_TIME_IS_VALID(recoveryPos_) && recoveryPos_ > 0) {
+      recoveryStage_ = RecoverySeeking;
+      recoveryFramePending_ = true;
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), recoveryPos_);
+      clipLoopArmed_ = clipLoop_;
       return;
     }
+    recoveryStage_ = RecoveryIdle;
+    attachSinkProbeIfNeeded();
+    if (recoveryWasPlaying_) {
+      playStartTimer_.restart();
+      states_.request(GST_STATE_PLAYING, "recovery");
+      playBtn_->setText("Pause");
+    }
+  }
 
-    // If it's encrypted and we have a cencdec element, attempt route: demux-pad -> cencdec -> queue
-    if (isCenc && self->cencdec_) {
-      qInfo() << "[CENC] Encrypted pad detected; attempting routing via cencdec";
+  // GUI thread, after the first frame at the resume position. Only records
+  // the metric; resuming is driven by ASYNC_DONE in continueRecovery().
+  void finishRecovery() {
+    if (recoveryStage_ == RecoveryScheduled || !recoveryClock_.isValid()) return;
+    const double ms = double(recoveryClock_.nsecsElapsed()) / 1e6;
+    recoveryClock_.invalidate();
+    recoveryStats_.add(ms);
+    backoff_.recovered(recoveryUptime_.elapsed());
+    qInfo().noquote() << QString("[RECOVERY] recovered (%1) in %2 ms after %3 attempt(s); "
+                                 "recoveries=%4 mean=%5 ms max=%6 ms failed-attempts=%7")
+                           .arg(errorClassName(recoveryClass_)).arg(ms, 0, 'f', 0).arg(backoff_.attempts())
+                           .arg(recoveryStats_.samples.size()).arg(recoveryStats_.mean(), 0, 'f', 0)
+                           .arg(recoveryStats_.max(), 0, 'f', 0).arg(recoveryStats_.failedAttempts);
+  }
 
-      // Some plugins allocate resources only after state change; request READY to be safe
-      GstStateChangeReturn st_ret = gst_element_set_state(self->cencdec_, GST_STATE_READY);
-      qInfo() << "[CENC] cencdec state change requested (to READY), return code =" << st_ret;
+  // Replaces a failed sink with a fresh instance of the same factory while
+  // the pipeline is in READY. False when it can't be recreated.
+  bool rebuildSink(bool video) {
+    GstElement*& sink = video ? vsink_ : asink_;
+    GstElement* upstream = video ? vselector_ : (audioPassthroughActive_ ? qAudio_ : ares_);
+    GstElementFactory* factory = gst_element_get_factory(sink);
+    if (!factory) return false;
+    const QByteArray factoryName = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+    GstElement* fresh = gst_element_factory_make(factoryName.constData(), nullptr);
+    if (!fresh) return false;
+    // The buffer probe moves only if it lived on this sink; the other sink's
+    // probe stays where it is
+    const bool probed = sinkProbeOn(sink);
+    if (probed) detachSinkProbe();
+    gst_element_set_state(sink, GST_STATE_NULL);
+    gst_bin_remove(GST_BIN(pipeline_), sink);
+    gst_object_set_name(GST_OBJECT(fresh), video ? "vsink" : "asink");
+    sink = fresh;
+    gst_bin_add(GST_BIN(pipeline_), sink);
+    if (!gst_element_link(upstream, sink)) {
+      qCritical() << "[RECOVERY] cannot link the new" << factoryName;
+      return false;
+    }
+    if (video) {
+      if (GstPad* pad = gst_element_get_static_pad(vsink_, "sink")) {
+        gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                          &GstQtPlayer::onPixelCountProbe, &sinkPixels_, nullptr);
+        gst_object_unref(pad);
+      }
+    }
+    if (probed) attachSinkProbeIfNeeded();
+    return true;
+  }
 
-      // link demux pad -> cencdec sink
-      GstPad* cenc_sink = gst_element_get_static_pad(self->cencdec_, "sink");
-      if (!cenc_sink) {
-        qWarning() << "[CENC] cencdec sink pad not available";
+  // A full reset re-decides compressed passthrough, so start from the
+  // decoding audio chain again
+  void restoreAudioChain() {
+    if (!audioPassthroughActive_) return;
+    gst_element_unlink(qAudio_, asink_);
+    if (!gst_element_link_many(qAudio_, aconv_, ares_, asink_, NULL)) {
+      qWarning() << "[RECOVERY] cannot restore the decoding audio chain";
+    }
+    audioPassthroughActive_ = false;
+  }
+
+  // ---------- Stall watchdog ----------
+  // PLAYING (settled, not throttled, not showing cached frames) with no
+  // buffer at the sink for stallFrames_ frame durations → one diagnostics
+  // dump per stall, optionally followed by recovery.
+  void checkStall() {
+    // A probe left on a sink outside the pipeline (dropped video branch)
+    // sees no buffers by design
+    GstElement* probed = sinkProbePad_ ? GST_PAD_PARENT(sinkProbePad_) : nullptr;
+    if (!probed || GST_OBJECT_PARENT(probed) != GST_OBJECT(pipeline_)) return;
+    if (stallFrames_ <= 0 || stalled_ || !sinkProbeAttached_ ||
+        states_.current() != GST_STATE_PLAYING || states_.busy() ||
+        cacheMode_ || recoveryStage_ != RecoveryIdle || videoThrottle_ != ThrottleNone) {
+      return;
+    }
+    const gint64 nowUs = g_get_monotonic_time();
+    const gint64 since = std::max<gint64>(lastSinkBufferUs_, playingSinceUs_);
+    const gint64 limitUs = std::max<gint64>(200000, gint64(stallFrames_) * sinkFrameUs_);
+    if (nowUs - since < limitUs) return;
+
+    stalled_ = true;
+    stallCount_++;
+    qWarning().noquote() << QString("[STALL] no buffer at the %1 sink for %2 ms (limit %3 ms = %4 frames); stall #%5")
+                              .arg(ownsVideoBranch_ ? "audio" : "video").arg((nowUs - since) / 1000)
+                              .arg(limitUs / 1000).arg(stallFrames_).arg(stallCount_);
+    const QByteArray dotName = QString("stall-%1").arg(stallCount_).toUtf8();
+    for (const std::string& line : collectPipelineDiagnostics(pipeline_, dotName.constData())) {
+      qWarning().noquote() << "[STALL]" << QString::fromStdString(line);
+    }
+    qWarning().noquote() << QString("[STALL] player: clip-loop=%1 recovery=%2 position=%3 ms")
+                              .arg(clipLoop_ ? (clipLoopArmed_ ? "armed" : "pending") : "off")
+                              .arg(recoveryStage_).arg(qint64(GST_CLOCK_TIME_IS_VALID(lastGoodPos_) ? lastGoodPos_ / GST_MSECOND : 0));
+    if (stallRecover_ && recoveryEnabled_) {
+      states_.request(GST_STATE_READY, "stall");
+      scheduleRecovery(ErrorClass::Stall, nullptr, true);
+    }
+  }
+
+  // ---------- Seamless clip loop ----------
+  // Every seek carries GST_SEEK_FLAG_SEGMENT while looping, so the pipeline
+  // posts SEGMENT_DONE instead of EOS at the end of the clip.
+  GstSeekFlags seekFlags(int flags) const {
+    return GstSeekFlags(clipLoop_ ? (flags | GST_SEEK_FLAG_SEGMENT) : flags);
+  }
+
+  // One flushing segment seek after the first preroll enters segment mode
+  void armClipLoop() {
+    gint64 pos = 0;
+    gst_element_query_position(pipeline_, GST_FORMAT_TIME, &pos);
+    if (seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), pos)) {
+      clipLoopArmed_ = true;
+      qInfo() << "[CLIPLOOP] segment looping armed";
+    } else {
+      qWarning() << "[CLIPLOOP] source does not support segment seeks; looping disabled";
+      clipLoop_ = false;
+    }
+  }
+
+  // Non-flushing: queued data keeps playing while the demuxer restarts at 0,
+  // and the running time simply continues into the next pass.
+  void restartClipLoop() {
+    clipLoopPasses_++;
+    clipLoopWrapPending_ = true;
+    if (!gst_element_seek(pipeline_, rate_, GST_FORMAT_TIME, GST_SEEK_FLAG_SEGMENT,
+                          GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE)) {
+      qWarning() << "[CLIPLOOP] segment restart failed; falling back to a flushing seek";
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH), 0);
+    }
+  }
+
+  // Streaming thread (video sink pad). Gap at the wrap = scheduled hole in
+  // running time between the last frame of a pass and the first of the next,
+  // plus how late that first frame reached the sink.
+  void measureClipLoopGap(GstPad* pad, GstBuffer* buf) {
+    GstEvent* ev = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (!ev) return;
+    const GstSegment* seg = nullptr;
+    gst_event_parse_segment(ev, &seg);
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    const GstClockTime rt = gst_segment_to_running_time(seg, GST_FORMAT_TIME, pts);
+    gst_event_unref(ev);
+    if (!GST_CLOCK_TIME_IS_VALID(rt)) return;
+
+    if (GST_CLOCK_TIME_IS_VALID(clipLoopLastPts_) && pts < clipLoopLastPts_ &&
+        clipLoopWrapPending_.exchange(false)) {
+      const gint64 scheduled = std::max<gint64>(0, gint64(rt) - gint64(clipLoopLastRtEnd_));
+      gint64 late = 0;
+      if (GstClock* clock = gst_element_get_clock(vsink_)) {
+        const GstClockTime now = gst_clock_get_time(clock) - gst_element_get_base_time(vsink_);
+        late = std::max<gint64>(0, gint64(now) - gint64(rt));
+        gst_object_unref(clock);
+      }
+      const double gapMs = double(scheduled + late) / GST_MSECOND;
+      clipLoopGapMax_ = std::max(clipLoopGapMax_, gapMs);
+      qInfo().noquote() << QString("[CLIPLOOP] pass %1 boundary gap=%2 ms (scheduled %3, late %4) max=%5 ms")
+                             .arg(clipLoopPasses_.load()).arg(gapMs, 0, 'f', 2)
+                             .arg(double(scheduled) / GST_MSECOND, 0, 'f', 2)
+                             .arg(double(late) / GST_MSECOND, 0, 'f', 2).arg(clipLoopGapMax_, 0, 'f', 2);
+    }
+    const GstClockTime dur = GST_BUFFER_DURATION_IS_VALID(buf) ? GST_BUFFER_DURATION(buf)
+                           : (GST_CLOCK_TIME_IS_VALID(clipLoopLastPts_) && pts > clipLoopLastPts_
+                                ? pts - clipLoopLastPts_ : 0);
+    clipLoopLastPts_ = pts;
+    clipLoopLastRtEnd_ = rt + dur;
+  }
+
+  // ---------- Reverse playback ----------
+  // GOPs are decoded forward by ReverseDecoder workers and shown backwards
+  // through the cache presenter; the main pipeline stays paused (no audio).
+  void setReverse(bool on) {
+    if (!on) {
+      if (!reversing_) return;
+      reversing_ = false;
+      reverseTimer_.stop();
+      reportReverse();
+      reverse_.stop();
+      leaveCacheMode();
+      qInfo() << "[REVERSE] off";
+      return;
+    }
+    GstCaps* caps = frameCache_.caps();
+    const GstClockTime from = shownPts_;
+    if (!pipeline_ || timeshift_ || !cachePad_ || !caps || !GST_CLOCK_TIME_IS_VALID(from)) {
+      qWarning() << "[REVERSE] Needs a local file with video already playing";
+      if (caps) gst_caps_unref(caps);
+      reverseBtn_->setChecked(false);
+      return;
+    }
+    if (looping_) loopBtn_->setChecked(false);
+    states_.request(GST_STATE_PAUSED, "reverse");
+    playBtn_->setText("Play");
+    const bool started = reverse_.start(filePath_.toStdString(), caps, from, reverseWorkers_,
+                                        size_t(std::max<qint64>(frameCache_.budget(), 64ll * 1024 * 1024)));
+    gst_caps_unref(caps);
+    if (!started) {
+      qWarning() << "[REVERSE] Cannot start GOP decoders";
+      reverseBtn_->setChecked(false);
+      return;
+    }
+    enterCacheMode();
+    reversing_ = true;
+    reversePts_ = from;
+    reverseShown_ = 0;
+    reverseUnderruns_ = 0;
+    reverseFirstFrame_ = true;
+    reverseWall_.start();
+    reverseReport_.start();
+    reverseTimer_.start(int(std::max<GstClockTime>(1, frameCache_.frameDuration() / GST_MSECOND)));
+    qInfo() << "[REVERSE] from (ms):" << from / GST_MSECOND << "workers:" << reverse_.workers();
+  }
+
+  void advanceReverse() {
+    GstSample* sample = reverse_.frameBefore(reversePts_);
+    if (!sample) {
+      if (reverse_.exhausted(reversePts_)) {
+        if (reverse_.failed()) qWarning() << "[REVERSE] GOP decode failed";
+        else qInfo() << "[REVERSE] reached the start";
+        reverseBtn_->setChecked(false);
+        return;
+      }
+      if (!reverseFirstFrame_) reverseUnderruns_++;
+      return;
+    }
+    if (reverseFirstFrame_) {
+      reverseFirstFrame_ = false;
+      qInfo() << "[REVERSE] first frame after (ms):" << reverseWall_.elapsed();
+    }
+    reversePts_ = GST_BUFFER_PTS(gst_sample_get_buffer(sample));
+    reverse_.setPlayhead(reversePts_);
+    presentCached(sample);
+    reverseShown_++;
+    if (reverseReport_.elapsed() >= 2000) {
+      reportReverse();
+      reverseReport_.restart();
+    }
+  }
+
+  void reportReverse() {
+    const double sec = reverseWall_.elapsed() / 1000.0;
+    qInfo().noquote() << QString("[REVERSE] shown=%1 (%2 fps) underruns=%3 gops=%4 avg-gop-decode=%5 ms "
+                                 "buffered=%6 keyframes=%7%8 workers=%9")
+                           .arg(reverseShown_).arg(sec > 0 ? reverseShown_ / sec : 0.0, 0, 'f', 1)
+                           .arg(reverseUnderruns_).arg(reverse_.gopsDecoded())
+                           .arg(reverse_.avgGopDecodeMs(), 0, 'f', 1).arg(reverse_.bufferedFrames())
+                           .arg(reverse_.keyframes()).arg(reverse_.indexComplete() ? "" : "+")
+                           .arg(reverse_.workers());
+  }
+
+  void reportFrameCache() {
+    const quint64 hits = frameCache_.hits();
+    const quint64 total = hits + frameCache_.misses();
+    qInfo().noquote() << QString("[CACHE] hit-rate=%1% (%2/%3) frames=%4 size=%5/%6 MB loop-passes=%7")
+                           .arg(total ? 100.0 * double(hits) / double(total) : 0.0, 0, 'f', 1)
+                           .arg(hits).arg(total).arg(frameCache_.frames())
+                           .arg(double(frameCache_.bytes()) / (1024.0 * 1024.0), 0, 'f', 1)
+                           .arg(double(frameCache_.budget()) / (1024.0 * 1024.0), 0, 'f', 0)
+                           .arg(loopPasses_);
+  }
+
+  // ---------- Timeshift ----------
+  // Replay from the ring: restart the playback pipeline at the byte offset
+  // that arrived at timeNs. Recording is never interrupted.
+  void seekInRing(qint64 timeNs) {
+    const GstState cur = states_.target();
+    ringSeekPending_ = true;
+    firstFrameSeen_ = false;
+    lastPts_ = GST_CLOCK_TIME_NONE;
+    frames_.clear();
+    frameCount_ = 0;
+    playStartTimer_.restart();
+
+    // Going to READY is synchronous, so the ring is repositioned before the
+    // upward change is issued
+    ring_.cancelReads();
+    states_.request(GST_STATE_READY, "ring-seek");
+    readPos_ = ring_.positionForTime(timeNs);
+    ringBaseTime_ = ring_.timeForPosition(readPos_);
+    ringBasePos_ = GST_CLOCK_TIME_NONE;
+    ring_.resumeReads();
+    states_.request(cur == GST_STATE_PLAYING ? GST_STATE_PLAYING : GST_STATE_PAUSED, "ring-seek");
+    qInfo() << "[TIMESHIFT] seek to" << (ring_.headTime() - timeNs) / 1000000 << "ms behind live, offset" << quint64(readPos_);
+  }
+
+  // Arrival time of what is on screen. readPos_ runs ahead by everything
+  // appsrc, decodebin and the queues hold, so the playhead is the arrival
+  // time the current run started from plus the stream time shown since.
+  qint64 ringPlayheadTime() {
+    if (ringBaseTime_ < 0) ringBaseTime_ = ring_.oldestTime();
+    const GstClockTime pos = positions_.position();
+    if (!GST_CLOCK_TIME_IS_VALID(pos)) return ringBaseTime_;
+    if (!GST_CLOCK_TIME_IS_VALID(ringBasePos_) || pos < ringBasePos_) ringBasePos_ = pos;
+    return std::clamp<qint64>(ringBaseTime_ + qint64(pos - ringBasePos_), ring_.oldestTime(), ring_.headTime());
+  }
+
+  void reportTimeshift() {
+    const qint64 ms = timeshiftStatsWall_.restart();
+    const quint64 written = ring_.bytesWritten();
+    const quint64 oldest = ring_.oldest();
+    const double fill = ring_.capacity() ? 100.0 * double(written - oldest) / double(ring_.capacity()) : 0.0;
+    const double mbps = ms > 0 ? double(written - timeshiftLastBytes_) / 1e6 * 1000.0 / ms : 0.0;
+    timeshiftLastBytes_ = written;
+    qInfo().noquote() << QString("[TIMESHIFT] fill=%1% window=%2 s write=%3 MB/s behind-live=%4 s overruns=%5")
+                           .arg(fill, 0, 'f', 1)
+                           .arg(double(ring_.headTime() - ring_.oldestTime()) / 1e9, 0, 'f', 1)
+                           .arg(mbps, 0, 'f', 2)
+                           .arg(double(ring_.headTime() - ringPlayheadTime()) / 1e9, 0, 'f', 1)
+                           .arg(ring_.overruns());
+  }
+
+  // Apply the latest videoArea_ geometry to the sink (one expose per display frame)
+  void applyOverlayGeometry() {
+    if (!overlayDirty_) return;
+    overlayDirty_ = false;
+    if (GST_IS_VIDEO_OVERLAY(vsink_)) {
+      gst_video_overlay_set_render_rectangle(
+        GST_VIDEO_OVERLAY(vsink_),
+        0,
+        0,
+        videoArea_->width(),
+        videoArea_->height());
+      gst_video_overlay_expose(GST_VIDEO_OVERLAY(vsink_));
+      exposeCalls_++;
+      resizeBurstExposes_++;
+    }
+  }
+
+  // Resize burst finished: flush pending geometry and report what was saved
+  void endResizeBurst() {
+    applyOverlayGeometry();
+    resizing_ = false;
+    std::vector<int> copy;
+    {
+      std::lock_guard<std::mutex> lock(resizeFramesMutex_);
+      copy.swap(resizeFrames_);
+    }
+    const int n = int(copy.size());
+    std::vector<int> tmp = copy;
+    const int q50 = percentile(tmp, 50.0);
+    tmp = copy;
+    const int q95 = percentile(tmp, 95.0);
+    qInfo() << "[RESIZE] burst events=" << resizeBurstEvents_
+            << " exposes=" << resizeBurstExposes_
+            << " avoided=" << (resizeBurstEvents_ - resizeBurstExposes_)
+            << " frame-gap-ms q50=" << q50 << " q95=" << q95 << " (n=" << n << ")"
+            << " totals events=" << resizeEvents_ << " exposes=" << exposeCalls_;
+  }
+
+  // Minimized / hidden / unexposed → throttle video decode; audio keeps running
+  void updateVisibility() {
+    const bool visible = isVisible() && !isMinimized() &&
+                         (!windowHandle() || windowHandle()->isExposed());
+    if (visible == windowVisible_) return;
+    windowVisible_ = visible;
+
+    const qint64 cpu = processCpuMs();
+    if (!visible) {
+      const qint64 wall = visibleWall_.restart();
+      if (wall > 0) {
+        qInfo() << "[VISIBILITY] visible period" << wall << "ms, CPU"
+                << QString::number(100.0 * double(cpu - visibleCpuMs_) / wall, 'f', 1) << "%";
+      }
+      hiddenCpuMs_ = cpu;
+      hiddenDropped_ = 0;
+      videoThrottle_ = hiddenMode_;
+      if (hiddenMode_ != ThrottleNone) {
+        qInfo() << "[VISIBILITY] window hidden → video decode" << throttleName(hiddenMode_);
+      }
+      return;
+    }
+
+    const qint64 wall = visibleWall_.restart();
+    const int wasThrottled = videoThrottle_.exchange(ThrottleNone);
+    visibleCpuMs_ = cpu;
+    if (wall > 0) {
+      qInfo() << "[VISIBILITY] hidden period" << wall << "ms, CPU"
+              << QString::number(100.0 * double(cpu - hiddenCpuMs_) / wall, 'f', 1) << "%"
+              << " video buffers dropped=" << hiddenDropped_.load();
+    }
+    if (wasThrottled == ThrottleNone || !pipeline_) return;
+
+    // Accurate catch-up: the decoder lost its references, flush and resume at
+    // the current position so video re-syncs with audio on the exact frame.
+    GstState cur = GST_STATE_NULL;
+    gst_element_get_state(pipeline_, &cur, nullptr, 0);
+    gint64 pos = 0;
+    if (cur >= GST_STATE_PAUSED && gst_element_query_position(pipeline_, GST_FORMAT_TIME, &pos)) {
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), GstClockTime(pos));
+      lastPts_ = GST_CLOCK_TIME_NONE;
+      qInfo() << "[VISIBILITY] window visible → catch-up seek to (ms):" << pos / GST_MSECOND;
+    }
+  }
+
+  // Recompute the auto-fit size from videoArea_ and renegotiate if it moved
+  // beyond the hysteresis band. Growing (e.g. maximize) renegotiates upward.
+  void applyAutoFit() {
+    if (!autoFit_ || !vcaps_) return;
+    const QSize target = autoFitTarget();
+    if (target == fitSize_) return;
+    if (target.isValid() && fitSize_.isValid()) {
+      const int dw = std::abs(target.width()  - fitSize_.width());
+      const int dh = std::abs(target.height() - fitSize_.height());
+      if (dw * 10 < fitSize_.width() && dh * 10 < fitSize_.height()) {
+        return; // within 10% hysteresis band
+      }
+    }
+    qInfo() << "[AUTOFIT]" << (fitSize_.isValid() ? QString("%1x%2").arg(fitSize_.width()).arg(fitSize_.height()) : QString("native"))
+            << "->" << (target.isValid() ? QString("%1x%2").arg(target.width()).arg(target.height()) : QString("native"))
+            << " area=" << videoArea_->size();
+    fitSize_ = target;
+    applyVideoCaps();
+  }
+
+private:
+  // ---------- GStreamer callbacks ----------
+  static void onSyncMessage(GstBus*, GstMessage* msg, gpointer userData) {
+    if (!gst_is_video_overlay_prepare_window_handle_message(msg)) {
+      return;
+    }
+    auto* self = static_cast<GstQtPlayer*>(userData);
+
+    // Ensure a native window exists
+    self->videoArea_->setAttribute(Qt::WA_NativeWindow);
+    WId wid = self->videoArea_->winId();
+    if (!wid || wid < 0x10) {
+      qWarning() << "[OVERLAY] Invalid window id during prepare-window-handle";
+      return; // avoid BadWindow
+    }
+
+    if (GST_IS_VIDEO_OVERLAY(self->vsink_)) {
+      gst_video_overlay_set_window_handle(
+        GST_VIDEO_OVERLAY(self->vsink_),
+        (guintptr)wid);
+      gst_video_overlay_set_render_rectangle(
+        GST_VIDEO_OVERLAY(self->vsink_),
+        0,
+        0,
+        self->videoArea_->width(),
+        self->videoArea_->height());
+      gst_video_overlay_expose(GST_VIDEO_OVERLAY(self->vsink_));
+      qInfo() << "[OVERLAY] Window handle set";
+    }
+  }
+
+  static void onStreamStatus(GstBus*, GstMessage* msg, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    GstStreamStatusType type;
+    GstElement* owner = nullptr;
+    gst_message_parse_stream_status(msg, &type, &owner);
+    const ThreadRole role = classifyTaskOwner(owner, self->decodebin_, self->qVideo_, self->qAudio_);
+    if (self->threadPolicy_.install(msg, role)) {
+      qInfo().noquote() << "[THREADS]" << GST_ELEMENT_NAME(owner) << "task ->" << threadRoleName(role);
+    }
+  }
+
+  void reportThreadPolicy() {
+    if (!threadPolicy_.active()) return;
+    const ThreadPolicyStats& st = threadPolicy_.stats();
+    qInfo().noquote() << QString("[THREADS][METRICS] threads=%1 pinned=%2 affinity-failed=%3 nice-failed=%4 fifo-denied=%5")
+                           .arg(st.threads.load()).arg(st.pinned.load()).arg(st.affinityFailed.load())
+                           .arg(st.niceFailed.load()).arg(st.fifoDenied.load());
+  }
+
+  void reportDecodeShare() {
+    DecodeScheduler& sched = DecodeScheduler::instance();
+    if (!sched.totalThreads()) return;
+    qInfo().noquote() << QString("[SCHED] decode/convert share=%1 of %2 threads across %3 pipelines (capped elements=%4)")
+                           .arg(sched.shareFor(pipeline_)).arg(sched.totalThreads())
+                           .arg(sched.pipelines()).arg(sched.elementsCapped());
+  }
+
+  // Robust, instrumented onPadAdded implementing cencdec routing + fallback
+  static void onPadAdded(GstElement* dbin, GstPad* newPad, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (!self) return;
+
+    if (gst_pad_get_direction(newPad) != GST_PAD_SRC) {
+      return;
+    }
+
+    GstCaps* caps = gst_pad_get_current_caps(newPad);
+    if (!caps) {
+      caps = gst_pad_query_caps(newPad, nullptr);
+    }
+    if (!caps || gst_caps_is_empty(caps)) {
+      if (caps) gst_caps_unref(caps);
+      qWarning() << "[DECODEBIN] pad-added with empty caps";
+      return;
+    }
+
+    const GstStructure* st = gst_caps_get_structure(caps, 0);
+    if (!st) {
+      gst_caps_unref(caps);
+      qWarning() << "[DECODEBIN] pad-added but no structure";
+      return;
+    }
+    const gchar* name = gst_structure_get_name(st);
+    if (!name) {
+      gst_caps_unref(caps);
+      qWarning() << "[DECODEBIN] pad-added but structure has no name";
+      return;
+    }
+
+    // log caps (free string afterwards)
+    gchar* caps_str = gst_caps_to_string(caps);
+    qInfo() << "[DECODEBIN] pad-added caps:" << (caps_str ? caps_str : "(null)") << " name=" << name;
+    if (caps_str) g_free(caps_str);
+
+    const bool isVideo = g_str_has_prefix(name, "video/");
+    const bool isAudio = g_str_has_prefix(name, "audio/");
+
+    // Detect encrypted variants commonly used with CENC
+    const bool isCenc = g_str_has_prefix(name, "application/x-cenc") ||
+                        g_str_has_prefix(name, "video/encv") ||
+                        g_str_has_prefix(name, "audio/enca");
+
+    if (isVideo && self->audioOnly_) {
+      // Demuxed (still compressed) video is thrown away without decoding
+      GstPad* discardPad = gst_element_get_static_pad(self->vdiscard_, "sink");
+      if (discardPad && !gst_pad_is_linked(discardPad)) {
+        const GstPadLinkReturn r = gst_pad_link(newPad, discardPad);
+        qInfo() << "[LINK] Audio-only: video pad -> fakesink, result code =" << r;
+      } else {
+        qInfo() << "[LINK] Audio-only: ignoring extra video pad";
+      }
+      if (discardPad) gst_object_unref(discardPad);
+      gst_caps_unref(caps);
+      return;
+    }
+
+    if (isAudio && !g_str_has_prefix(name, "audio/x-raw") && !isCenc && self->audioPassthrough_ &&
+        !self->audioPassthroughActive_) {
+      // Compressed passthrough: qAudio_ feeds the sink directly; nothing to
+      // convert or resample. Done before data flows on this pad.
+      gst_element_unlink(self->qAudio_, self->aconv_);
+      gst_element_unlink(self->ares_, self->asink_);
+      if (!gst_element_link(self->qAudio_, self->asink_)) {
+        qWarning() << "[AUDIO] Passthrough relink qa -> asink failed";
+      } else {
+        self->audioPassthroughActive_ = true;
+        qInfo() << "[AUDIO] Passthrough branch: queue -> sink";
+      }
+    }
+
+    GstElement* targetQueue = isVideo ? self->qVideo_ : (isAudio ? self->qAudio_ : nullptr);
+    if (!targetQueue) {
+      qWarning() << "[DECODEBIN] Ignoring pad with caps:" << name;
+      gst_caps_unref(caps);
+      return;
+    }
+
+    // If it's encrypted and we have a cencdec element, attempt route: demux-pad -> cencdec -> queue
+    if (isCenc && self->cencdec_) {
+      qInfo() << "[CENC] Encrypted pad detected; attempting routing via cencdec";
+
+      // Some plugins allocate resources only after state change; request READY to be safe
+      GstStateChangeReturn st_ret = gst_element_set_state(self->cencdec_, GST_STATE_READY);
+      qInfo() << "[CENC] cencdec state change requested (to READY), return code =" << st_ret;
+
+      // link demux pad -> cencdec sink
+      GstPad* cenc_sink = gst_element_get_static_pad(self->cencdec_, "sink");
+      if (!cenc_sink) {
+        qWarning() << "[CENC] cencdec sink pad not available";
         // fallback: try direct linking demux -> queue
       } else {
         if (!gst_pad_is_linked(cenc_sink)) {
@@ -485,6 +1789,7 @@ private:
             qWarning() << "[CENC] cencdec src -> queue sink link FAILED (code =" << r2 << ")";
           } else {
             qInfo() << "[CENC] Successfully linked cencdec ->" << (isVideo ? "video" : "audio") << "queue";
+            if (isVideo) self->videoLinked_ = true;
             if (cenc_src) gst_object_unref(cenc_src);
             if (q_sink) gst_object_unref(q_sink);
             gst_caps_unref(caps);
@@ -501,87 +1806,1801 @@ private:
       if (cenc_src) gst_object_unref(cenc_src);
       if (q_sink) gst_object_unref(q_sink);
 
-      qWarning() << "[CENC] Routing via cencdec did not succeed; attempting fallback direct link demux -> queue";
-      // fall through to fallback direct linking
+      qWarning() << "[CENC] Routing via cencdec did not succeed; attempting fallback direct link demux -> queue";
+      // fall through to fallback direct linking
+    }
+
+    // Fallback / non-encrypted path: link demux pad -> queue sink
+    GstPad* sinkpad = gst_element_get_static_pad(targetQueue, "sink");
+    if (sinkpad) {
+      if (!gst_pad_is_linked(sinkpad)) {
+        GstPadLinkReturn r = gst_pad_link(newPad, sinkpad);
+        if (r != GST_PAD_LINK_OK) {
+          qWarning() << "[LINK] Failed to link decodebin pad (" << name << ") -> queue. Code:" << r;
+        } else {
+          qInfo() << "[LINK] Linked decodebin pad ->" << (isVideo ? "video" : "audio") << "queue";
+          if (isVideo) self->videoLinked_ = true;
+        }
+      } else {
+        qInfo() << "[LINK] queue sink pad already linked";
+      }
+      gst_object_unref(sinkpad);
+    } else {
+      qWarning() << "[LINK] target queue sink pad not available";
+    }
+
+    gst_caps_unref(caps);
+  }
+
+  static GstPadProbeReturn onSinkBufferProbe(GstPad* pad, GstPadProbeInfo* info, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (!self) return GST_PAD_PROBE_OK;
+
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!buf) return GST_PAD_PROBE_OK;
+
+    GstClockTime pts = GST_BUFFER_PTS(buf);
+    if (GST_CLOCK_TIME_IS_VALID(pts)) {
+      self->shownPts_ = pts;
+      if (self->clipLoop_) {
+        self->measureClipLoopGap(pad, buf);
+      }
+    }
+    const gint64 nowUs = g_get_monotonic_time();
+    const gint64 prevUs = self->lastSinkBufferUs_.exchange(nowUs);
+    self->sinkFrames_++;
+    if (self->scenarioWait_.load() != ScenarioWaitNone) {
+      self->checkScenarioFrame(pad, nowUs, prevUs);
+    }
+    if (self->soakActive_.load() && prevUs > 0) {
+      std::lock_guard<std::mutex> lock(self->soakMutex_);
+      self->soakIntervalsUs_.push_back(int(std::min<gint64>(nowUs - prevUs, INT_MAX)));
+    }
+    // Wall-clock gaps: PTS deltas stay at the frame duration however late
+    // frames reach the sink, so they cannot show what a resize costs
+    if (self->resizing_ && prevUs > 0) {
+      std::lock_guard<std::mutex> lock(self->resizeFramesMutex_);
+      self->resizeFrames_.push_back(int(std::min<gint64>((nowUs - prevUs) / 1000, INT_MAX)));
+    }
+    if (GST_BUFFER_DURATION_IS_VALID(buf)) {
+      self->sinkFrameUs_ = gint64(GST_BUFFER_DURATION(buf) / GST_USECOND);
+    }
+    if (self->stalled_.exchange(false)) {
+      qInfo() << "[STALL] buffers flowing again after (ms):" << (nowUs - prevUs) / 1000;
+    }
+    if (self->recoveryFramePending_.exchange(false)) {
+      QMetaObject::invokeMethod(self, [self] { self->finishRecovery(); }, Qt::QueuedConnection);
+    }
+    if (self->stepPending_.exchange(false)) {
+      qInfo() << "[STEP] latency(ms):" << self->stepTimer_.elapsed()
+              << (self->stepFromCache_ ? "(cache)" : "(re-decode)");
+    }
+    if (!self->firstFrameSeen_) {
+      self->firstFrameSeen_ = true;
+      // Time To First Frame = wallclock since we entered PLAYING
+      const qint64 ttff_ms = self->playStartTimer_.elapsed();
+      self->lastTtffMs_ = ttff_ms;
+      qInfo() << "[METRICS] TTFF(ms):" << ttff_ms;
+      if (self->ringSeekPending_.exchange(false)) {
+        qInfo() << "[TIMESHIFT] seek-in-ring latency(ms):" << ttff_ms;
+      }
+      // Source caps are known now; size decode output to the video area
+      QMetaObject::invokeMethod(self, [self] { self->applyAutoFit(); }, Qt::QueuedConnection);
+    }
+
+    if (pts != GST_CLOCK_TIME_NONE) {
+      if (self->lastPts_ != GST_CLOCK_TIME_NONE) {
+        // Compute frame interval in milliseconds based on PTS delta
+        gint64 delta_ns = (gint64)pts - (gint64)self->lastPts_;
+        if (delta_ns > 0) {
+          int delta_ms = static_cast<int>(delta_ns / GST_MSECOND);
+          self->frames_.push_back(delta_ms);
+          self->frameCount_++;
+
+          if (self->frameCount_ % 60 == 0) {
+            // Compute q50 and q95 on a copy (percentile does nth_element and mutates).
+            std::vector<int> copy = self->frames_;
+            int q50 = percentile(copy, 50.0);
+            // Re-copy to restore distribution before next percentile
+            copy = self->frames_;
+            int q95 = percentile(copy, 95.0);
+            self->intervalQ50_ = q50;
+            self->intervalQ95_ = q95;
+            qInfo() << "[METRICS] frame-interval-ms q50=" << q50 << " q95=" << q95 << " (n=" << self->frameCount_ << ")";
+            self->reportPixelRate();
+          }
+
+          // Keep vector from growing unbounded; retain last ~1000 samples
+          if (self->frames_.size() > 1200) {
+            self->frames_.erase(self->frames_.begin(), self->frames_.begin() + 200);
+          }
+        }
+      }
+      self->lastPts_ = pts;
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  // Largest even size that keeps the source display aspect ratio and fits the
+  // on-screen video area. Invalid QSize means "native" (source already fits).
+  QSize autoFitTarget() const {
+    GstPad* pad = gst_element_get_static_pad(vscale_, "sink");
+    if (!pad) return fitSize_;
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    gst_object_unref(pad);
+    if (!caps) return fitSize_; // not negotiated yet
+    GstVideoInfo info;
+    const bool ok = gst_video_info_from_caps(&info, caps);
+    gst_caps_unref(caps);
+    if (!ok || info.width <= 0 || info.height <= 0) return fitSize_;
+
+    const qreal dpr = videoArea_->devicePixelRatioF();
+    const QSize box(int(videoArea_->width() * dpr), int(videoArea_->height() * dpr));
+    int srcW = info.width;
+    if (info.par_n > 0 && info.par_d > 0) {
+      srcW = int(gint64(info.width) * info.par_n / info.par_d);
+    }
+    const QSize src(srcW, info.height);
+    if (box.isEmpty() || (src.width() <= box.width() && src.height() <= box.height())) {
+      return QSize();
+    }
+    const QSize fit = src.scaled(box, Qt::KeepAspectRatio);
+    return QSize(std::max(2, fit.width() & ~1), std::max(2, fit.height() & ~1));
+  }
+
+  // Single owner of vcaps_: ABR low-quality wins, then auto-fit, else native;
+  // the memory budget's max height caps the latter two
+  void applyVideoCaps() {
+    GstCaps* caps = nullptr;
+    const int maxHeight = budget_.maxHeight();
+    if (lowQuality_) {
+      caps = gst_caps_new_simple(
+        "video/x-raw",
+        "width",  G_TYPE_INT, 640,
+        "height", G_TYPE_INT, 360,
+        NULL);
+    } else if (autoFit_ && fitSize_.isValid()) {
+      QSize fit = fitSize_;
+      if (maxHeight && fit.height() > maxHeight) {
+        fit = QSize(std::max(2, (fit.width() * maxHeight / fit.height()) & ~1), maxHeight);
+      }
+      caps = gst_caps_new_simple(
+        "video/x-raw",
+        "width",  G_TYPE_INT, fit.width(),
+        "height", G_TYPE_INT, fit.height(),
+        "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+        NULL);
+    } else if (maxHeight) {
+      // videoscale keeps the display aspect ratio while fixating the height
+      caps = gst_caps_new_simple(
+        "video/x-raw",
+        "height", GST_TYPE_INT_RANGE, 2, maxHeight,
+        NULL);
+    }
+    g_object_set(vcaps_, "caps", caps, NULL);
+    if (caps) gst_caps_unref(caps);
+    // Signal downstream reconfigure
+    gst_element_send_event(vscale_, gst_event_new_reconfigure());
+  }
+
+  // Times audioresample's transform: sink-pad probe stamps the buffer arrival,
+  // src-pad probe (same streaming thread, after transform) closes the interval.
+  static GstPadProbeReturn onResampleInProbe(GstPad*, GstPadProbeInfo*, gpointer) {
+    resampleStartNs() = std::chrono::steady_clock::now().time_since_epoch().count();
+    return GST_PAD_PROBE_OK;
+  }
+
+  static GstPadProbeReturn onResampleOutProbe(GstPad*, GstPadProbeInfo* info, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    const qint64 start = resampleStartNs();
+    if (start) {
+      self->resampleNs_ += std::chrono::steady_clock::now().time_since_epoch().count() - start;
+      resampleStartNs() = 0;
+    }
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (buf && GST_BUFFER_DURATION_IS_VALID(buf)) {
+      self->resampledAudioNs_ += GST_BUFFER_DURATION(buf);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  static qint64& resampleStartNs() {
+    static thread_local qint64 start = 0;
+    return start;
+  }
+
+  // Level/loudness tap on what the audio sink receives (streaming thread)
+  static GstPadProbeReturn onLevelProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+      GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+      if (GST_EVENT_TYPE(ev) == GST_EVENT_CAPS) {
+        GstCaps* caps = nullptr;
+        gst_event_parse_caps(ev, &caps);
+        int rate = 0, channels = 0;
+        self->meterActive_ = meterFormatFromCaps(caps, self->meterFormat_, rate, channels);
+        if (self->meterActive_) {
+          self->levelMeter_.configure(rate, channels);
+          self->meterChannels_ = channels;
+        } else {
+          qWarning() << "[METER] Unsupported audio format; level meter disabled";
+        }
+      }
+      return GST_PAD_PROBE_OK;
+    }
+    if (!self->meterActive_) return GST_PAD_PROBE_OK;
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+      const size_t bytesPerFrame = size_t(self->meterChannels_) * meterSampleBytes(self->meterFormat_);
+      self->levelMeter_.process(map.data, map.size / bytesPerFrame, self->meterFormat_);
+      gst_buffer_unmap(buf, &map);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  static size_t meterSampleBytes(LoudnessMeter::SampleFormat fmt) {
+    switch (fmt) {
+      case LoudnessMeter::SampleFormat::S16: return 2;
+      case LoudnessMeter::SampleFormat::F64: return 8;
+      default:                               return 4;
+    }
+  }
+
+  void attachLevelMeter() {
+    GstPad* pad = gst_element_get_static_pad(ares_, "src");
+    if (!pad) return;
+    gst_pad_add_probe(pad,
+                      (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                      &GstQtPlayer::onLevelProbe, this, nullptr);
+    gst_object_unref(pad);
+  }
+
+  void attachResampleMonitor() {
+    GstPad* in  = gst_element_get_static_pad(ares_, "sink");
+    GstPad* out = gst_element_get_static_pad(ares_, "src");
+    if (in) {
+      gst_pad_add_probe(in, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onResampleInProbe, this, nullptr);
+      gst_object_unref(in);
+    }
+    if (out) {
+      gst_pad_add_probe(out, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onResampleOutProbe, this, nullptr);
+      gst_object_unref(out);
+    }
+  }
+
+  static int padRate(GstElement* e, const char* padName) {
+    GstPad* pad = gst_element_get_static_pad(e, padName);
+    if (!pad) return 0;
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    gst_object_unref(pad);
+    int rate = 0;
+    if (caps) {
+      if (!gst_caps_is_empty(caps)) {
+        gst_structure_get_int(gst_caps_get_structure(caps, 0), "rate", &rate);
+      }
+      gst_caps_unref(caps);
+    }
+    return rate;
+  }
+
+  // Resampling is only real work when rates differ; equal rates put
+  // audioresample (and audioconvert for matching formats) in passthrough.
+  void reportAudioPath() {
+    if (audioPassthroughActive_) {
+      qInfo() << "[AUDIO] compressed passthrough: decode/convert/resample skipped";
+      return;
+    }
+    const int inRate = padRate(ares_, "sink");
+    const int outRate = padRate(ares_, "src");
+    if (!inRate || !outRate) return;
+    const qint64 audioNs = resampledAudioNs_.exchange(0);
+    const qint64 costNs = resampleNs_.exchange(0);
+    const double usPerSec = audioNs > 0 ? (double(costNs) / 1000.0) / (double(audioNs) / 1e9) : 0.0;
+    qInfo() << "[AUDIO] resample" << (inRate != outRate ? "ACTIVE" : "passthrough")
+            << inRate << "->" << outRate << "Hz, cost=" << QString::number(usPerSec, 'f', 1)
+            << "us per second of audio (" << QString::number(usPerSec / 1e4, 'f', 3) << "% of a core)";
+  }
+
+  void reportSessionCpu() {
+    if (!sessionWall_.isValid()) return;
+    const qint64 wall = sessionWall_.elapsed();
+    if (wall <= 0) return;
+    const qint64 cpu = processCpuMs() - sessionCpuMs_;
+    qInfo() << "[METRICS] CPU% over play session =" << QString::number(100.0 * double(cpu) / wall, 'f', 1)
+            << " (cpu ms=" << cpu << " wall ms=" << wall << " mode=" << (ownsVideoBranch_ ? "audio-only" : "normal") << ")";
+    sessionWall_.invalidate();
+    reportAudioPath();
+    reportMemoryPath(wall);
+    reportMemoryBudget();
+    reportAllocations(wall);
+    reportPositionService();
+    reportThreadPolicy();
+    reportDecodeShare();
+    reportIsolatedDecode();
+    for (const std::string& line : states_.report()) {
+      qInfo().noquote() << "[STATE][METRICS]" << QString::fromStdString(line);
+    }
+  }
+
+  // Audio-only: stop autoplugging at any video elementary stream a decoder
+  // would accept, so no parser/decoder is ever instantiated for it.
+  // Containers (video/quicktime, video/x-matroska...) have no decoder and
+  // keep being autoplugged.
+  // Passthrough: stop at compressed audio the audio sink accepts as-is.
+  // Sinks are already PAUSED when decodebin autoplugs, so autoaudiosink has
+  // its real child and reports real caps.
+  static gboolean onAutoplugContinue(GstElement* /*bin*/, GstPad* /*pad*/, GstCaps* caps, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (self->audioOnly_ && isDecodableVideo(caps)) {
+      return FALSE;
+    }
+    if (self->audioPassthrough_ && !gst_caps_is_empty(caps)) {
+      const gchar* name = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+      if (g_str_has_prefix(name, "audio/") && !g_str_has_prefix(name, "audio/x-raw")) {
+        GstPad* sinkpad = gst_element_get_static_pad(self->asink_, "sink");
+        bool accepted = false;
+        if (sinkpad) {
+          GstCaps* allowed = gst_pad_query_caps(sinkpad, caps);
+          accepted = allowed && !gst_caps_is_empty(allowed);
+          if (allowed) gst_caps_unref(allowed);
+          gst_object_unref(sinkpad);
+        }
+        if (accepted) {
+          qInfo() << "[AUDIO] Sink accepts" << name << "- skipping decode (passthrough)";
+          return FALSE;
+        }
+      }
+    }
+    return TRUE;
+  }
+
+  static void onNoMorePads(GstElement* /*dbin*/, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (self->audioOnly_ || self->videoLinked_) return;
+    QMetaObject::invokeMethod(self, [self] { self->dropVideoBranch(); }, Qt::QueuedConnection);
+  }
+
+  // Record pipeline: source → appsink, always PLAYING, writes into the ring.
+  // Playback pipeline: appsrc (need-data reads the ring) → decodebin → ...
+  void setupTimeshift(const PlayerOptions& opts) {
+    if (!ring_.open(size_t(opts.timeshiftBytes), opts.timeshiftFile.toStdString())) {
+      qFatal("[FATAL] Cannot allocate timeshift ring");
+    }
+    gst_util_set_object_arg(G_OBJECT(source_), "stream-type", "stream");
+    g_object_set(source_, "format", GST_FORMAT_BYTES, "max-bytes", (guint64)(1 << 20), NULL);
+    g_signal_connect(source_, "need-data", G_CALLBACK(&GstQtPlayer::onTimeshiftNeedData), this);
+
+    QString uri = filePath_;
+    if (!uri.contains("://")) {
+      gchar* u = gst_filename_to_uri(filePath_.toUtf8().constData(), nullptr);
+      uri = QString::fromUtf8(u ? u : "");
+      g_free(u);
+    }
+    GError* err = nullptr;
+    recPipeline_ = gst_parse_launch(
+      "urisourcebin name=rsrc ! appsink name=rec sync=false emit-signals=true", &err);
+    if (!recPipeline_) {
+      qFatal("[FATAL] Cannot build timeshift record pipeline: %s", err ? err->message : "unknown");
+    }
+    GstElement* rsrc = gst_bin_get_by_name(GST_BIN(recPipeline_), "rsrc");
+    GstElement* rec = gst_bin_get_by_name(GST_BIN(recPipeline_), "rec");
+    g_object_set(rsrc, "uri", uri.toUtf8().constData(), NULL);
+    g_signal_connect(rec, "new-sample", G_CALLBACK(&GstQtPlayer::onTimeshiftSample), this);
+    gst_object_unref(rec);
+    gst_object_unref(rsrc);
+    recBus_ = gst_element_get_bus(recPipeline_);
+    gst_element_set_state(recPipeline_, GST_STATE_PLAYING);
+
+    timeshiftStatsWall_.start();
+    timeshiftStatsTimer_.setInterval(5000);
+    connect(&timeshiftStatsTimer_, &QTimer::timeout, this, &GstQtPlayer::reportTimeshift);
+    timeshiftStatsTimer_.start();
+    qInfo() << "[TIMESHIFT] Recording" << uri << "into" << opts.timeshiftBytes / (1024 * 1024) << "MB ring"
+            << (opts.timeshiftFile.isEmpty() ? QString("(memory)") : opts.timeshiftFile);
+  }
+
+  void pumpRecordBus() {
+    if (!recBus_) return;
+    while (GstMessage* msg = gst_bus_pop(recBus_)) {
+      if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+        GError* err = nullptr;
+        gst_message_parse_error(msg, &err, nullptr);
+        qCritical() << "[TIMESHIFT][ERROR]" << (err ? err->message : "unknown");
+        if (err) g_error_free(err);
+        ring_.markEos();
+      } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
+        qInfo() << "[TIMESHIFT] Source EOS; ring will drain";
+        ring_.markEos();
+      }
+      gst_message_unref(msg);
+    }
+  }
+
+  // appsink streaming thread: copy the compressed buffer into the ring
+  static GstFlowReturn onTimeshiftSample(GstElement* appsink, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    GstSample* sample = nullptr;
+    g_signal_emit_by_name(appsink, "pull-sample", &sample);
+    if (!sample) return GST_FLOW_EOS;
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+      self->ring_.write(map.data, map.size, g_get_monotonic_time() * 1000);
+      gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+
+  // appsrc streaming thread: block (in short slices) until the ring has data
+  static void onTimeshiftNeedData(GstElement* appsrc, guint length, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    const size_t want = std::clamp<size_t>(length ? length : 65536, 4096, 262144);
+    GstBuffer* buf = gst_buffer_new_allocate(nullptr, want, nullptr);
+    GstMapInfo map;
+    if (!gst_buffer_map(buf, &map, GST_MAP_WRITE)) {
+      gst_buffer_unref(buf);
+      return;
+    }
+    uint64_t pos = self->readPos_;
+    const uint64_t overrunsBefore = self->ring_.overruns();
+    size_t n = 0;
+    for (;;) {
+      n = self->ring_.read(pos, map.data, want, 50);
+      if (n) break;
+      if (self->ring_.eos() && pos >= self->ring_.head()) {
+        gst_buffer_unmap(buf, &map);
+        gst_buffer_unref(buf);
+        GstFlowReturn ret;
+        g_signal_emit_by_name(appsrc, "end-of-stream", &ret);
+        return;
+      }
+      if (self->ring_.readsCancelled()) {
+        gst_buffer_unmap(buf, &map);
+        gst_buffer_unref(buf);
+        return; // seek-in-ring or shutdown is stopping the pipeline
+      }
+    }
+    gst_buffer_unmap(buf, &map);
+    gst_buffer_set_size(buf, n);
+    self->readPos_ = pos;
+    if (self->ring_.overruns() != overrunsBefore) {
+      qWarning() << "[TIMESHIFT] Playhead fell out of the ring window; jumped to oldest data";
+    }
+    GstFlowReturn ret;
+    g_signal_emit_by_name(appsrc, "push-buffer", buf, &ret);
+    gst_buffer_unref(buf);
+  }
+
+  // Playback pipeline: appsrc (need-data wraps shared-memory slots filled by
+  // a decode worker process) → decodebin (raw caps: nothing to plug) → ...
+  // Audio stays in the worker's file; isolated mode presents video only.
+  void setupIsolatedDecode() {
+    // Slots sized for 4K I420; pages are only touched as frames arrive
+    constexpr uint32_t kSlots = 6;
+    constexpr uint32_t kSlotBytes = 3840 * 2160 * 3 / 2;
+    if (!worker_.start(QCoreApplication::applicationFilePath().toStdString(), filePath_.toStdString(), 0,
+                       kSlots, kSlotBytes)) {
+      qFatal("[FATAL] Cannot start decode worker process");
+    }
+    gst_util_set_object_arg(G_OBJECT(source_), "stream-type", "seekable");
+    g_object_set(source_, "format", GST_FORMAT_TIME, "max-bytes", (guint64)kSlotBytes, NULL);
+    g_signal_connect(source_, "need-data", G_CALLBACK(&GstQtPlayer::onIsolatedNeedData), this);
+    g_signal_connect(source_, "seek-data", G_CALLBACK(&GstQtPlayer::onIsolatedSeekData), this);
+    qInfo() << "[ISOLATE] decode worker pid" << worker_.pid() << "ring" << kSlots << "slots";
+  }
+
+  struct SlotRelease {
+    std::shared_ptr<SharedFrameRing> ring;
+    int slot;
+  };
+
+  static void releaseSlot(gpointer data) {
+    auto* r = static_cast<SlotRelease*>(data);
+    r->ring->release(r->slot);
+    delete r;
+  }
+
+  // Worker-failure path: respawn just past the last frame handed downstream,
+  // or post an error once it keeps failing. False when need-data should stop.
+  bool respawnIsolatedWorker(GstElement* appsrc, const char* what) {
+    if (isolatedRespawns_ >= 3) {
+      GST_ELEMENT_ERROR(appsrc, STREAM, DECODE, ("decode worker keeps failing"), ("last: %s", what));
+      return false;
+    }
+    const GstClockTime last = isolatedLastPts_;
+    const int64_t resume = GST_CLOCK_TIME_IS_VALID(last) ? int64_t(last) + 1 : 0;
+    qWarning().noquote() << QString("[ISOLATE] worker %1 (%2); respawning at %3 ms")
+                              .arg(what).arg(QString::fromStdString(worker_.exitReason()))
+                              .arg(resume / 1000000);
+    isolatedRespawns_++;
+    if (!worker_.respawn(resume)) {
+      GST_ELEMENT_ERROR(appsrc, RESOURCE, FAILED, ("cannot respawn decode worker"), (nullptr));
+      return false;
+    }
+    return true;
+  }
+
+  // appsrc streaming thread: hand the next slot downstream without copying.
+  // Everything read from the ring was written by the worker and is checked
+  // before use; a worker that stops heartbeating counts as hung.
+  static void onIsolatedNeedData(GstElement* appsrc, guint /*length*/, gpointer userData) {
+    constexpr int64_t kWorkerStallNs = 5000000000;
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    while (!self->isolatedStopping_) {
+      std::shared_ptr<SharedFrameRing> ring = self->worker_.ring();
+      SharedFrameRing::Frame frame;
+      const int slot = ring ? ring->beginRead(frame, 100) : -1;
+      if (slot < 0) {
+        const bool failed = ring && ring->state() == SharedFrameRing::Failed;
+        const bool alive = self->worker_.alive();
+        if (!failed && alive && ring && ring->stalled(kWorkerStallNs)) {
+          if (!self->respawnIsolatedWorker(appsrc, "stopped responding")) return;
+          continue;
+        }
+        if (!failed && alive) {
+          if (ring && ring->state() == SharedFrameRing::Eos && !ring->queued()) {
+            GstFlowReturn ret;
+            g_signal_emit_by_name(appsrc, "end-of-stream", &ret);
+            return;
+          }
+          continue;
+        }
+        if (!self->respawnIsolatedWorker(appsrc, failed ? "reported a decode failure" : "died")) return;
+        continue;
+      }
+      if (uint32_t(slot) >= ring->slots() || frame.size > ring->slotBytes()) {
+        ring->release(slot);
+        if (!self->respawnIsolatedWorker(appsrc, "committed a corrupt frame")) return;
+        continue;
+      }
+      const GstClockTime last = self->isolatedLastPts_;
+      // Stale (pre-seek) frames and the overlap after a respawn are skipped
+      if (frame.epoch != ring->epoch() ||
+          (GST_CLOCK_TIME_IS_VALID(last) && frame.pts >= 0 && GstClockTime(frame.pts) <= last)) {
+        ring->release(slot);
+        continue;
+      }
+      std::string caps;
+      if (!ring->caps(caps)) {
+        ring->release(slot);
+        if (!self->respawnIsolatedWorker(appsrc, "left its caps half-written")) return;
+        continue;
+      }
+      if (caps != self->isolatedCaps_) {
+        GstCaps* c = gst_caps_from_string(caps.c_str());
+        g_object_set(appsrc, "caps", c, NULL);
+        if (c) gst_caps_unref(c);
+        self->isolatedCaps_ = caps;
+      }
+      GstBuffer* buf = gst_buffer_new_wrapped_full(
+        GST_MEMORY_FLAG_READONLY, const_cast<uint8_t*>(ring->slotData(slot)), frame.size, 0, frame.size,
+        new SlotRelease{ring, slot}, &GstQtPlayer::releaseSlot);
+      if (frame.pts >= 0) {
+        GST_BUFFER_PTS(buf) = GstClockTime(frame.pts);
+        self->isolatedLastPts_ = GstClockTime(frame.pts);
+      }
+      if (frame.duration >= 0) GST_BUFFER_DURATION(buf) = GstClockTime(frame.duration);
+      self->isolatedRespawns_ = 0;
+      {
+        std::lock_guard<std::mutex> lock(self->isolatedMutex_);
+        self->isolatedTransitUs_.push_back(int((monotonicNs() - frame.producedNs) / 1000));
+        if (self->isolatedTransitUs_.size() > 5000) {
+          self->isolatedTransitUs_.erase(self->isolatedTransitUs_.begin(), self->isolatedTransitUs_.begin() + 2500);
+        }
+      }
+      GstFlowReturn ret;
+      g_signal_emit_by_name(appsrc, "push-buffer", buf, &ret);
+      gst_buffer_unref(buf);
+      return;
+    }
+  }
+
+  static gboolean onIsolatedSeekData(GstElement*, guint64 offset, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    std::shared_ptr<SharedFrameRing> ring = self->worker_.ring();
+    if (!ring) return FALSE;
+    self->isolatedLastPts_ = GST_CLOCK_TIME_NONE;
+    ring->requestSeek(int64_t(offset));
+    return TRUE;
+  }
+
+  void reportIsolatedDecode() {
+    if (!isolated_) return;
+    std::vector<int> transit;
+    {
+      std::lock_guard<std::mutex> lock(isolatedMutex_);
+      transit = isolatedTransitUs_;
+    }
+    std::vector<int> tmp = transit;
+    const int q50 = percentile(tmp, 50.0);
+    tmp = transit;
+    const int q95 = percentile(tmp, 95.0);
+    qInfo().noquote() << QString("[ISOLATE] worker pid=%1 restarts=%2 worker-cpu-ms=%3 ring-transit-ms q50=%4 q95=%5 (n=%6)")
+                           .arg(worker_.pid()).arg(worker_.restarts()).arg(worker_.cpuMs(), 0, 'f', 0)
+                           .arg(q50 / 1000.0, 0, 'f', 2).arg(q95 / 1000.0, 0, 'f', 2).arg(transit.size());
+  }
+
+  // Conversion time of vconvert_ (sink → src of the same buffer, one
+  // streaming thread) plus the allocator offered for what flows into
+  // vconvert_ and, when the sink brings no pool of its own, out of it:
+  // rendition pools (frame memory kept across quality switches), backed by
+  // hugepages when asked for.
+  void setupFrameMemory(const PlayerOptions& opts) {
+    GstPad* in = gst_element_get_static_pad(vconvert_, "sink");
+    GstPad* out = gst_element_get_static_pad(vconvert_, "src");
+    GstPad* capsIn = gst_element_get_static_pad(vcaps_, "sink");
+    gst_pad_add_probe(in, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onConvertIn, this, nullptr);
+    gst_pad_add_probe(out, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onConvertOut, this, nullptr);
+    if (opts.hugePages) {
+      hugeAllocator_ = hugePageAllocatorNew();
+      if (hugeAllocator_) {
+        qInfo() << "[MEMORY] hugepage allocator offered to the video branch";
+      } else {
+        qWarning() << "[MEMORY] --hugepages is not supported on this platform";
+      }
+    }
+    if (renditionFrames_ > 0) {
+      renditionPools_.init(hugeAllocator_, renditionFrames_, uint64_t(std::max<qint64>(0, renditionCacheBytes_)));
+      for (GstPad* pad : {in, capsIn}) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &GstQtPlayer::onRenditionCaps, this, nullptr);
+      }
+      poolStatsTimer_.setInterval(5000);
+      connect(&poolStatsTimer_, &QTimer::timeout, this, &GstQtPlayer::reportRenditionPools);
+      poolStatsTimer_.start();
+      poolStatsWall_.start();
+      qInfo() << "[POOLS] keeping" << renditionFrames_ << "frames per rendition size, at most"
+              << renditionCacheBytes_ / (1024 * 1024) << "MB in all";
+    }
+    GstAllocator* offered = renditionPools_.active() ? renditionPools_.allocator() : hugeAllocator_;
+    if (offered) {
+      installAllocation(in, offered, false);
+      installAllocation(capsIn, offered, true);
+    }
+    gst_object_unref(capsIn);
+    gst_object_unref(out);
+    gst_object_unref(in);
+  }
+
+  // First caps on either side of vconvert_: pre-size frame memory for every
+  // rendition toggleQuality()/auto-fit can switch to, in that format
+  static GstPadProbeReturn onRenditionCaps(GstPad* pad, GstPadProbeInfo* info, gpointer userData) {
+    GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(ev) != GST_EVENT_CAPS) return GST_PAD_PROBE_OK;
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    GstCaps* caps = nullptr;
+    gst_event_parse_caps(ev, &caps);
+    GstVideoInfo vinfo;
+    if (!caps || !gst_video_info_from_caps(&vinfo, caps)) return GST_PAD_PROBE_OK;
+    const GstVideoFormat format = GST_VIDEO_INFO_FORMAT(&vinfo);
+    const bool input = GST_PAD_PARENT(pad) == self->vconvert_;
+    std::atomic<int>& seen = input ? self->prewarmedInFormat_ : self->prewarmedOutFormat_;
+    if (seen.exchange(int(format)) == int(format)) return GST_PAD_PROBE_OK;
+    QMetaObject::invokeMethod(self, [self, format] { self->prewarmRenditions(format); }, Qt::QueuedConnection);
+    return GST_PAD_PROBE_OK;
+  }
+
+  void prewarmRenditions(GstVideoFormat format) {
+    std::vector<std::pair<int, int>> sizes = {{640, 360}};
+    if (fitSize_.isValid()) sizes.push_back({fitSize_.width(), fitSize_.height()});
+    GstPad* pad = gst_element_get_static_pad(vscale_, "sink");
+    if (GstCaps* caps = gst_pad_get_current_caps(pad)) {
+      GstVideoInfo native;
+      if (gst_video_info_from_caps(&native, caps)) {
+        sizes.push_back({GST_VIDEO_INFO_WIDTH(&native), GST_VIDEO_INFO_HEIGHT(&native)});
+      }
+      gst_caps_unref(caps);
+    }
+    gst_object_unref(pad);
+    // Allocating and touching a few frames per size takes long enough to
+    // stall the GUI; one helper thread works through the requests
+    std::lock_guard<std::mutex> lock(prewarmMutex_);
+    prewarmJobs_.push_back({format, std::move(sizes)});
+    if (prewarmRunning_) return;
+    if (prewarmThread_.joinable()) prewarmThread_.join();   // already finished
+    prewarmRunning_ = true;
+    prewarmThread_ = std::thread(&GstQtPlayer::prewarmLoop, this);
+  }
+
+  void prewarmLoop() {
+    for (;;) {
+      PrewarmJob job;
+      {
+        std::lock_guard<std::mutex> lock(prewarmMutex_);
+        if (prewarmJobs_.empty()) {
+          prewarmRunning_ = false;
+          return;
+        }
+        job = std::move(prewarmJobs_.front());
+        prewarmJobs_.pop_front();
+      }
+      const quint64 before = renditionPools_.stats().prewarmed;
+      QElapsedTimer t;
+      t.start();
+      renditionPools_.prewarm(job.format, job.sizes, renditionFrames_);
+      qInfo().noquote() << QString("[POOLS] pre-sized %1 frames (%2 sizes) for %3 in %4 ms")
+                             .arg(renditionPools_.stats().prewarmed - before).arg(job.sizes.size())
+                             .arg(gst_video_format_to_string(job.format)).arg(t.elapsed());
+    }
+  }
+
+  // Allocation rate through the offered allocator; fresh = not served from
+  // memory kept across renegotiations
+  void reportRenditionPools() {
+    const RecycleStats& st = renditionPools_.stats();
+    const quint64 requests = st.requests;
+    const quint64 fresh = st.misses;
+    const qint64 ms = std::max<qint64>(1, poolStatsWall_.restart());
+    if (requests == poolLastRequests_) return;
+    qInfo().noquote() << QString("[POOLS] allocs/s=%1 fresh/s=%2 (total %3, fresh %4, dropped %5, evicted %6) retained=%7 MB")
+                           .arg((requests - poolLastRequests_) * 1000.0 / ms, 0, 'f', 1)
+                           .arg((fresh - poolLastFresh_) * 1000.0 / ms, 0, 'f', 1)
+                           .arg(requests).arg(fresh).arg(st.dropped.load()).arg(st.evicted.load())
+                           .arg(st.cachedBytes.load() / (1024 * 1024));
+    poolLastRequests_ = requests;
+    poolLastFresh_ = fresh;
+  }
+
+  static GstPadProbeReturn onConvertIn(GstPad*, GstPadProbeInfo*, gpointer userData) {
+    static_cast<GstQtPlayer*>(userData)->convertStartUs_ = g_get_monotonic_time();
+    return GST_PAD_PROBE_OK;
+  }
+
+  static GstPadProbeReturn onConvertOut(GstPad*, GstPadProbeInfo*, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    const gint64 start = self->convertStartUs_.exchange(0);
+    if (!start) return GST_PAD_PROBE_OK;
+    std::lock_guard<std::mutex> lock(self->convertMutex_);
+    self->convertUs_.push_back(int(g_get_monotonic_time() - start));
+    if (self->convertUs_.size() > 5000) {
+      self->convertUs_.erase(self->convertUs_.begin(), self->convertUs_.begin() + 2500);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  void reportMemoryPath(qint64 wallMs) {
+    if (audioOnly_) return;
+    std::vector<int> conv;
+    {
+      std::lock_guard<std::mutex> lock(convertMutex_);
+      conv.swap(convertUs_);
+    }
+    qint64 minor = 0, major = 0;
+    processPageFaults(minor, major);
+    minor -= sessionMinorFaults_;
+    major -= sessionMajorFaults_;
+    double avg = 0.0;
+    for (int us : conv) avg += us;
+    avg = conv.empty() ? 0.0 : avg / conv.size();
+    const int q95 = percentile(conv, 95.0);
+    qInfo().noquote() << QString("[MEMORY] allocator=%1 convert-ms avg=%2 q95=%3 (n=%4) page-faults minor=%5 (%6/s) major=%7")
+                           .arg(hugeAllocator_ ? "hugepage" : "system")
+                           .arg(avg / 1000.0, 0, 'f', 2).arg(q95 / 1000.0, 0, 'f', 2).arg(conv.size())
+                           .arg(minor).arg(wallMs > 0 ? minor * 1000 / wallMs : 0).arg(major);
+    if (hugeAllocator_) {
+      const HugePageStats& st = hugePageStats();
+      qInfo().noquote() << QString("[MEMORY] hugepage allocations=%1 frees=%2 hugetlb=%3 thp=%4 small->sysmem=%5 "
+                                   "mapped=%6 MB prefault=%7 ms queries=%8")
+                             .arg(st.allocations.load()).arg(st.frees.load()).arg(st.hugetlb.load())
+                             .arg(st.transparent.load()).arg(st.fallbacks.load())
+                             .arg(st.bytesMapped.load() / (1024 * 1024))
+                             .arg(st.prefaultNs.load() / 1e6, 0, 'f', 1).arg(st.queriesAnswered.load());
+    }
+  }
+
+  // Players with a budget in this process and the resident memory before
+  // the first of them was built; RSS above that is split evenly between them
+  struct BudgetShare {
+    std::atomic<int> players{0};
+    std::atomic<qint64> baselineBytes{0};
+  };
+  static BudgetShare& budgetShare() {
+    static BudgetShare share;
+    return share;
+  }
+
+  // Sizes queues, decoder threads, frame cache and rendition pools to fit
+  // --memory-budget, then watches resident memory once a second
+  void setupMemoryBudget(const PlayerOptions& opts) {
+    if (!budget_.configure(quint64(std::max<qint64>(0, opts.memoryBudgetBytes)),
+                           size_t(std::max<qint64>(0, opts.frameCacheBytes)), opts.renditionFrames,
+                           std::max(1u, std::thread::hardware_concurrency()))) {
+      return;
+    }
+    BudgetShare& share = budgetShare();
+    qint64 none = 0;
+    share.baselineBytes.compare_exchange_strong(none, processRssBytes());
+    share.players++;
+    const BudgetPlan& plan = budget_.plan();
+    g_object_set(decodebin_, "max-size-bytes", guint(plan.demuxQueueBytes), NULL);
+    g_object_set(qVideo_, "max-size-bytes", guint(plan.videoQueueBytes), "max-size-buffers", 0, NULL);
+    g_object_set(qAudio_, "max-size-bytes", guint(plan.audioQueueBytes), NULL);
+    DecodeScheduler::instance().setPipelineLimit(pipeline_, plan.decoderThreads);
+    qInfo().noquote() << QString("[BUDGET] %1 MB: demux queue=%2 MB video queue=%3 MB audio queue=%4 MB "
+                                 "frame cache=%5 MB rendition frames=%6 decoder threads<=%7")
+                           .arg(budget_.budget() / (1024 * 1024))
+                           .arg(plan.demuxQueueBytes / (1024 * 1024)).arg(plan.videoQueueBytes / (1024 * 1024))
+                           .arg(plan.audioQueueBytes / (1024 * 1024)).arg(plan.frameCacheBytes / (1024 * 1024))
+                           .arg(plan.renditionFrames).arg(plan.decoderThreads);
+    budgetTimer_.setInterval(1000);
+    connect(&budgetTimer_, &QTimer::timeout, this, &GstQtPlayer::sampleMemoryBudget);
+    budgetTimer_.start();
+  }
+
+  // This player's share of the resident memory above the baseline
+  qint64 budgetUsageBytes() const {
+    const BudgetShare& share = budgetShare();
+    const qint64 above = std::max<qint64>(0, processRssBytes() - share.baselineBytes.load());
+    return above / std::max(1, share.players.load());
+  }
+
+  void sampleMemoryBudget() {
+    const qint64 used = budgetUsageBytes();
+    const int level = budget_.level();
+    if (!budget_.sample(quint64(used))) return;
+    const bool worse = budget_.level() > level;
+    frameCache_.setBudget(budget_.frameCacheBytes());
+    // Sizes above the new cap are being left: keeping their frame memory
+    // would raise usage instead of lowering it
+    renditionPools_.setSizeCeiling(renditionBytesAt(budget_.maxHeight()));
+    applyVideoCaps();
+#if defined(__GLIBC__)
+    // Frames freed by the rebuilt pools stay in the heap otherwise
+    if (worse) malloc_trim(0);
+#endif
+    qInfo().noquote() << QString("[BUDGET] %1: using %2 MB of %3 MB -> max height %4, frame cache %5 MB")
+                           .arg(worse ? "over budget, degrading" : "back under budget, restoring")
+                           .arg(used / (1024 * 1024)).arg(budget_.budget() / (1024 * 1024))
+                           .arg(budget_.maxHeight() ? QString::number(budget_.maxHeight()) : QString("native"))
+                           .arg(budget_.frameCacheBytes() / (1024 * 1024));
+  }
+
+  // Largest frame vconvert_ handles (either side) once output is capped at
+  // maxHeight; 0 when uncapped or the source isn't known yet
+  gsize renditionBytesAt(int maxHeight) {
+    if (!maxHeight) return 0;
+    GstPad* pad = gst_element_get_static_pad(vscale_, "sink");
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    gst_object_unref(pad);
+    if (!caps) return 0;
+    GstVideoInfo native;
+    const bool known = gst_video_info_from_caps(&native, caps);
+    gst_caps_unref(caps);
+    if (!known || GST_VIDEO_INFO_HEIGHT(&native) <= maxHeight) return 0;
+    const int width = (GST_VIDEO_INFO_WIDTH(&native) * maxHeight / GST_VIDEO_INFO_HEIGHT(&native) + 1) & ~1;
+    gsize bytes = 0;
+    for (int format : {prewarmedInFormat_.load(), prewarmedOutFormat_.load()}) {
+      GstVideoInfo info;
+      if (format != GST_VIDEO_FORMAT_UNKNOWN &&
+          gst_video_info_set_format(&info, GstVideoFormat(format), guint(width), guint(maxHeight))) {
+        bytes = std::max<gsize>(bytes, GST_VIDEO_INFO_SIZE(&info));
+      }
+    }
+    // Slack for the stride padding and alignment pools add
+    return bytes + bytes / 8;
+  }
+
+  void reportMemoryBudget() {
+    if (!budget_.active()) return;
+    qInfo().noquote() << QString("[BUDGET][METRICS] budget=%1 MB used=%2 MB peak=%3 MB over-budget samples=%4/%5 "
+                                 "degradations=%6 restorations=%7 max-height=%8 (players sharing RSS=%9)")
+                           .arg(budget_.budget() / (1024 * 1024)).arg(budget_.lastBytes() / (1024 * 1024))
+                           .arg(budget_.peakBytes() / (1024 * 1024)).arg(budget_.overSamples())
+                           .arg(budget_.samples()).arg(budget_.degradations()).arg(budget_.restorations())
+                           .arg(budget_.maxHeight() ? QString::number(budget_.maxHeight()) : QString("native"))
+                           .arg(budgetShare().players.load());
+  }
+
+  // Allocation churn over the play session, process-wide (all players);
+  // elements with the most fresh memory first
+  void reportAllocations(qint64 wallMs) {
+    AllocTracer& tracer = AllocTracer::instance();
+    if (!tracer.installed()) return;
+    const AllocTotals& t = tracer.totals();
+    const double secs = std::max<qint64>(1, wallMs) / 1000.0;
+    qInfo().noquote() << QString("[ALLOC][METRICS] buffers new=%1 (%2/s) freed=%3 memories new=%4 (%5/s) freed=%6 "
+                                 "(%7 MB) pool releases=%8 unattributed=%9 (+%10 pool hits)")
+                           .arg(t.buffersCreated.load()).arg(t.buffersCreated.load() / secs, 0, 'f', 1)
+                           .arg(t.buffersFreed.load()).arg(t.memoriesCreated.load())
+                           .arg(t.memoriesCreated.load() / secs, 0, 'f', 1).arg(t.memoriesFreed.load())
+                           .arg(t.bytesFreed.load() / (1024 * 1024)).arg(t.poolReleases.load())
+                           .arg(t.unattributed.load()).arg(t.unattributedPoolHits.load());
+    int shown = 0;
+    for (const auto& kv : tracer.perElement()) {
+      const ElementAllocStats& e = kv.second;
+      if (shown++ == 12) break;
+      qInfo().noquote() << QString("[ALLOC][METRICS]   %1: fresh=%2 MB (%3 MB/s) memories=%4 shares=%5 buffers=%6 "
+                                   "pool hits=%7 misses=%8")
+                             .arg(QString::fromStdString(kv.first), -12)
+                             .arg(e.freshBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(e.freshBytes / (1024.0 * 1024.0) / secs, 0, 'f', 1)
+                             .arg(e.memories).arg(e.shares).arg(e.buffers).arg(e.poolHits).arg(e.poolMisses);
+    }
+  }
+
+  // ---------- Control socket (JSON-RPC 2.0, one object per line) ----------
+  void setupControlSocket(const QString& path) {
+    std::string err;
+    if (!control_.listen(path.toStdString(), err)) {
+      qWarning().noquote() << "[CONTROL] cannot listen on" << path << ":" << QString::fromStdString(err);
+      return;
+    }
+    auto* listener = new QSocketNotifier(control_.fd(), QSocketNotifier::Read, this);
+    connect(listener, &QSocketNotifier::activated, this, [this] {
+      for (int fd; (fd = control_.acceptClient()) >= 0;) {
+        auto* client = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(client, &QSocketNotifier::activated, this, [this, fd, client] { serveControlClient(fd, client); });
+        qInfo() << "[CONTROL] client connected; clients =" << control_.clients();
+      }
+    });
+    qInfo().noquote() << "[CONTROL] JSON-RPC on" << path;
+  }
+
+  void serveControlClient(int fd, QSocketNotifier* notifier) {
+    std::vector<std::string> lines;
+    bool open = control_.readLines(fd, lines);
+    for (const std::string& line : lines) {
+      const QByteArray reply = handleControlLine(QByteArray::fromStdString(line));
+      if (!reply.isEmpty() && !control_.sendLine(fd, reply.toStdString())) {
+        open = false;
+        break;
+      }
+    }
+    if (open) return;
+    notifier->setEnabled(false);
+    notifier->deleteLater();
+    control_.dropClient(fd);
+    qInfo() << "[CONTROL] client gone; clients =" << control_.clients();
+  }
+
+  // Empty for notifications (requests without an id)
+  QByteArray handleControlLine(const QByteArray& line) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    QJsonObject reply{{"jsonrpc", "2.0"}};
+    if (parseError.error != QJsonParseError::NoError) {
+      reply["id"] = QJsonValue::Null;
+      reply["error"] = QJsonObject{{"code", -32700}, {"message", "parse error"}};
+      return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+    }
+    // Valid JSON but not a request object (batches included), or no method
+    const QJsonObject request = doc.object();
+    if (!doc.isObject() || !request.value("method").isString()) {
+      reply["id"] = request.contains("id") ? request.value("id") : QJsonValue(QJsonValue::Null);
+      reply["error"] = QJsonObject{{"code", -32600}, {"message", "invalid request"}};
+      return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+    }
+    const QString method = request.value("method").toString();
+    int code = 0;
+    QString error;
+    const QJsonValue result = runControl(method, request.value("params").toObject(), code, error);
+    controlRequests_++;
+    if (code) {
+      qWarning().noquote() << "[CONTROL]" << method << "failed:" << error;
+    }
+    if (!request.contains("id")) return {};
+    reply["id"] = request.value("id");
+    if (code) {
+      reply["error"] = QJsonObject{{"code", code}, {"message", error}};
+    } else {
+      reply["result"] = result;
+    }
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+  }
+
+  // Same entry points as the buttons and slider; code != 0 on failure
+  // (JSON-RPC codes: -32601 unknown method, -32602 bad params, -32000 refused)
+  QJsonValue runControl(const QString& method, const QJsonObject& params, int& code, QString& error) {
+    const auto fail = [&code, &error](int c, const QString& message) {
+      code = c;
+      error = message;
+      return QJsonValue();
+    };
+    if (method == "play" || method == "pause") {
+      const bool play = method == "play";
+      const bool playing = states_.target() == GST_STATE_PLAYING && !cacheMode_;
+      if (play != playing) togglePlayPause();
+      return QJsonObject{{"target", gst_element_state_get_name(states_.target())}};
+    }
+    if (method == "seek") {
+      const QJsonValue position = params.value("position");
+      if (!position.isDouble() || position.toDouble() < 0) {
+        return fail(-32602, "seek needs params.position >= 0 (seconds)");
+      }
+      seekTo(GstClockTime(position.toDouble() * GST_SECOND), params.value("accurate").toBool(false));
+      return QJsonObject{{"position", position.toDouble()}};
+    }
+    if (method == "rate") {
+      const double rate = params.value("rate").toDouble(0.0);
+      if (rate <= 0.0 || rate > 16.0) return fail(-32602, "rate needs 0 < params.rate <= 16");
+      if (!setPlaybackRate(rate)) return fail(-32000, "rate change refused by the pipeline");
+      return QJsonObject{{"rate", rate_}};
+    }
+    if (method == "quality") {
+      if (ownsVideoBranch_) return fail(-32000, "no video branch");
+      const bool low = params.contains("low") ? params.value("low").toBool() : !lowQuality_;
+      if (low != lowQuality_) toggleQuality();
+      return QJsonObject{{"low", lowQuality_}};
+    }
+    if (method == "open") {
+      const QString path = params.value("path").toString();
+      if (path.isEmpty()) return fail(-32602, "open needs params.path");
+      if (!openFile(path, params.value("play").toBool(true), error)) return fail(-32000, error);
+      return QJsonObject{{"path", filePath_}};
+    }
+    if (method == "metrics") {
+      return metricsSnapshot();
+    }
+    return fail(-32601, QString("unknown method '%1'").arg(method));
+  }
+
+  // Flushing seek at the current position with the new rate (forward only;
+  // reverse playback has its own path). Every later seek on the main
+  // pipeline (clip loop, step, A-B loop, recovery) goes through seekAtRate()
+  // and keeps it; seekTo() uses it too, and only openFile() resets it.
+  bool setPlaybackRate(double rate) {
+    if (!pipeline_ || timeshift_) return false;
+    if (looping_) loopBtn_->setChecked(false);
+    if (reversing_) reverseBtn_->setChecked(false);
+    leaveCacheMode(false);
+    const GstClockTime pos = positions_.position();
+    if (!gst_element_seek(pipeline_, rate, GST_FORMAT_TIME, seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                          GST_SEEK_TYPE_SET, GST_CLOCK_TIME_IS_VALID(pos) ? gint64(pos) : 0,
+                          GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE)) {
+      return false;
+    }
+    rate_ = rate;
+    lastPts_ = GST_CLOCK_TIME_NONE;
+    qInfo() << "[RATE] playback rate =" << rate;
+    return true;
+  }
+
+  // Seek of the main pipeline at the current playback rate
+  bool seekAtRate(GstSeekFlags flags, GstClockTime position) {
+    return gst_element_seek(pipeline_, rate_, GST_FORMAT_TIME, flags, GST_SEEK_TYPE_SET, gint64(position),
+                            GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+  }
+
+  // Switches the file source to another file: full reset as in recovery,
+  // then preroll (and play when asked)
+  bool openFile(const QString& path, bool play, QString& error) {
+    if (timeshift_ || isolated_) {
+      error = "open is not available with --timeshift / --isolated-decode";
+      return false;
+    }
+    if (!QFileInfo(path).isFile()) {
+      error = QString("no such file: %1").arg(path);
+      return false;
+    }
+    if (looping_) loopBtn_->setChecked(false);
+    if (reversing_) reverseBtn_->setChecked(false);
+    leaveCacheMode(false);
+    reportSessionCpu();
+    cancelRecovery();
+    states_.request(GST_STATE_NULL, "open");
+    restoreAudioChain();
+    // The new file decides again whether there is video
+    videoLinked_ = false;
+    restoreVideoBranch();
+    clipLoopArmed_ = false;
+    frameCache_.clear();
+    positions_.invalidateDuration();
+    lastGoodPos_ = GST_CLOCK_TIME_NONE;
+    filePath_ = path;
+    rate_ = 1.0;
+    g_object_set(source_, "location", filePath_.toUtf8().constData(), NULL);
+    qInfo() << "[PIPELINE] Source file:" << filePath_;
+    if (play) {
+      togglePlayPause();
+    } else if (states_.request(GST_STATE_PAUSED, "open") == PlayerStateMachine::Result::Rejected) {
+      error = "preroll rejected";
+      return false;
+    }
+    return true;
+  }
+
+  QJsonObject metricsSnapshot() {
+    const GstClockTime pos = positions_.position();
+    const GstClockTime dur = positions_.duration();
+    qint64 minor = 0, major = 0;
+    processPageFaults(minor, major);
+    QJsonObject m{
+      {"file", filePath_},
+      {"state", gst_element_state_get_name(states_.current())},
+      {"target", gst_element_state_get_name(states_.target())},
+      {"position", GST_CLOCK_TIME_IS_VALID(pos) ? QJsonValue(double(pos) / GST_SECOND) : QJsonValue()},
+      {"duration", GST_CLOCK_TIME_IS_VALID(dur) ? QJsonValue(double(dur) / GST_SECOND) : QJsonValue()},
+      {"rate", rate_},
+      {"low_quality", lowQuality_},
+      {"frames", double(sinkFrames_.load())},
+      {"ttff_ms", double(lastTtffMs_.load())},
+      {"frame_interval_q50_ms", intervalQ50_.load()},
+      {"frame_interval_q95_ms", intervalQ95_.load()},
+      {"stalled", stalled_.load()},
+      {"recoveries", int(recoveryStats_.samples.size())},
+      {"rss_bytes", double(processRssBytes())},
+      {"cpu_ms", double(processCpuMs())},
+      {"threads", processThreadCount()},
+      {"minor_faults", double(minor)},
+      {"major_faults", double(major)},
+      {"control_requests", double(controlRequests_)},
+    };
+    if (budget_.active()) {
+      m["budget"] = QJsonObject{{"bytes", double(budget_.budget())}, {"used_bytes", double(budget_.lastBytes())},
+                                {"max_height", budget_.maxHeight()}};
+    }
+    if (AllocTracer::instance().installed()) {
+      const AllocTotals& t = AllocTracer::instance().totals();
+      m["alloc"] = QJsonObject{{"buffers_created", double(t.buffersCreated.load())},
+                               {"memories_created", double(t.memoriesCreated.load())},
+                               {"bytes_freed", double(t.bytesFreed.load())}};
+    }
+    return m;
+  }
+
+  // ---------- Scenario replay (--scenario) ----------
+  static int& scenariosRunning() {
+    static int running = 0;
+    return running;
+  }
+
+  void setupScenario(const PlayerOptions& opts) {
+    scenario_ = opts.scenario;
+    scenarioOut_.setFileName(opts.scenarioOut);
+    if (!scenarioOut_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      qWarning() << "[SCENARIO] cannot write" << opts.scenarioOut << "- results are only logged";
+    }
+    scenarioTimer_.setSingleShot(true);
+    connect(&scenarioTimer_, &QTimer::timeout, this, &GstQtPlayer::runScenarioAction);
+    scenarioTimeout_.setSingleShot(true);
+    scenarioTimeout_.setInterval(10000);
+    connect(&scenarioTimeout_, &QTimer::timeout, this, [this] {
+      completeScenarioAction("timeout", -1.0, double(scenarioGapUs_.load()) / 1000.0);
+    });
+    scenariosRunning()++;
+    // Start once the window (and its overlay handle) exists
+    QTimer::singleShot(0, this, [this] {
+      attachSinkProbeIfNeeded();
+      qInfo() << "[SCENARIO] running" << scenario_.size() << "actions; results ->" << scenarioOut_.fileName();
+      scenarioClock_.start();
+      scheduleScenarioAction();
+    });
+  }
+
+  void scheduleScenarioAction() {
+    if (scenarioNext_ >= scenario_.size() || scenario_[scenarioNext_].op == ScenarioOp::End) {
+      finishScenario();
+      return;
+    }
+    const ScenarioAction& a = scenario_[scenarioNext_];
+    scenarioCurrent_ = ScenarioResult();
+    scenarioCurrent_.index = scenarioNext_;
+    scenarioCurrent_.action = a;
+    scenarioCurrent_.scheduledMs = a.relative ? scenarioLastDoneMs_ + a.atMs : a.atMs;
+    scenarioTimer_.start(int(std::max<qint64>(0, scenarioCurrent_.scheduledMs - scenarioClock_.elapsed())));
+  }
+
+  // Seqnum of the segment the pad is in, GST_SEQNUM_INVALID before the first
+  static guint32 segmentSeqnum(GstPad* pad) {
+    GstEvent* ev = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (!ev) return GST_SEQNUM_INVALID;
+    const guint32 seqnum = gst_event_get_seqnum(ev);
+    gst_event_unref(ev);
+    return seqnum;
+  }
+
+  // Armed before the action is issued so its first frame can't be missed.
+  // Segment waits only accept frames from a segment that started after
+  // arming: frames still draining before a seek's flush don't count.
+  void armScenarioWait(ScenarioWait wait) {
+    scenarioSeq_++;
+    scenarioArmUs_ = g_get_monotonic_time();
+    scenarioWaitFromUs_ = scenarioArmUs_;
+    scenarioGapUs_ = 0;
+    scenarioWidth_ = scenarioHeight_ = 0;
+    if (wait == ScenarioWaitSegment) {
+      GstPad* pad = gst_element_get_static_pad(ownsVideoBranch_ ? asink_ : vsink_, "sink");
+      scenarioSegment_ = segmentSeqnum(pad);
+      gst_object_unref(pad);
+    }
+    if (wait == ScenarioWaitSize) {
+      GstPad* pad = gst_element_get_static_pad(vsink_, "sink");
+      if (GstCaps* caps = gst_pad_get_current_caps(pad)) {
+        GstVideoInfo info;
+        if (gst_video_info_from_caps(&info, caps)) {
+          scenarioWidth_ = info.width;
+          scenarioHeight_ = info.height;
+        }
+        gst_caps_unref(caps);
+      }
+      gst_object_unref(pad);
+    }
+    scenarioWait_ = wait;
+  }
+
+  void runScenarioAction() {
+    const ScenarioAction& a = scenarioCurrent_.action;
+    scenarioCurrent_.issuedMs = scenarioClock_.elapsed();
+    QString method = scenarioOpName(a.op);
+    QJsonObject params;
+    ScenarioWait wait = ScenarioWaitFrame;
+    switch (a.op) {
+      case ScenarioOp::Pause:   wait = ScenarioWaitNone; break;
+      case ScenarioOp::Seek:
+        params = {{"position", a.value}, {"accurate", a.flag}};
+        wait = ScenarioWaitSegment;
+        break;
+      case ScenarioOp::Quality:
+        if (a.arg != "toggle") params = {{"low", a.arg == "low"}};
+        wait = ownsVideoBranch_ ? ScenarioWaitFrame : ScenarioWaitSize;
+        break;
+      case ScenarioOp::Rate:
+        params = {{"rate", a.value}};
+        wait = ScenarioWaitSegment;
+        break;
+      case ScenarioOp::Open:
+        params = {{"path", QString::fromStdString(a.arg)}, {"play", true}};
+        wait = ScenarioWaitSegment;
+        break;
+      default: break;
+    }
+    armScenarioWait(wait);
+    scenarioActive_ = true;
+    scenarioAwaitPause_ = a.op == ScenarioOp::Pause;
+    const bool wasLow = lowQuality_;
+    int code = 0;
+    QString error;
+    runControl(method, params, code, error);
+    if (code) {
+      completeScenarioAction("error: " + error, -1.0, 0.0);
+    } else if (a.op == ScenarioOp::Quality && lowQuality_ == wasLow) {
+      completeScenarioAction("same-size", 0.0, 0.0);   // already at that quality
+    } else if (a.op == ScenarioOp::Pause && !scenarioAwaitPause_) {
+      // Settled synchronously; the state listener already took it from here
+    } else if (a.op == ScenarioOp::Pause && states_.target() == GST_STATE_PAUSED && !states_.busy()) {
+      scenarioPauseSettled();   // was not playing: nothing to wait for
+    } else {
+      scenarioTimeout_.start();
+    }
+  }
+
+  void scenarioPauseSettled() {
+    scenarioAwaitPause_ = false;
+    const double settledMs = double(g_get_monotonic_time() - scenarioArmUs_) / 1000.0;
+    const int hold = scenarioCurrent_.action.holdMs;
+    if (!hold) {
+      completeScenarioAction("ok", settledMs, 0.0);
+      return;
+    }
+    scenarioTimeout_.stop();
+    qInfo().noquote() << QString("[SCENARIO] #%1 paused in %2 ms; resuming after %3 ms")
+                           .arg(scenarioCurrent_.index).arg(settledMs, 0, 'f', 1).arg(hold);
+    const quint64 seq = scenarioSeq_;
+    QTimer::singleShot(hold, this, [this, seq] {
+      if (seq != scenarioSeq_ || !scenarioActive_) return;
+      armScenarioWait(ScenarioWaitFrame);
+      int code = 0;
+      QString error;
+      runControl("play", {}, code, error);
+      if (code) {
+        completeScenarioAction("error: " + error, -1.0, 0.0);
+        return;
+      }
+      scenarioTimeout_.start();
+    });
+  }
+
+  // Streaming thread: resolves the armed wait with this sink frame
+  void checkScenarioFrame(GstPad* pad, gint64 nowUs, gint64 prevUs) {
+    const gint64 from = scenarioWaitFromUs_.load();
+    scenarioGapUs_ = std::max(scenarioGapUs_.load(), nowUs - std::max(prevUs, from));
+    int wait = scenarioWait_.load();
+    bool sameSize = false;
+    if (wait == ScenarioWaitSegment && segmentSeqnum(pad) == scenarioSegment_.load()) return;
+    if (wait == ScenarioWaitSize) {
+      GstCaps* caps = gst_pad_get_current_caps(pad);
+      GstVideoInfo info;
+      const bool known = caps && gst_video_info_from_caps(&info, caps);
+      if (caps) gst_caps_unref(caps);
+      sameSize = known && info.width == scenarioWidth_.load() && info.height == scenarioHeight_.load();
+      // No new size within 3 s: the rendition didn't change the output size
+      if (sameSize && nowUs - from < 3 * G_USEC_PER_SEC) return;
+    }
+    if (!scenarioWait_.compare_exchange_strong(wait, ScenarioWaitNone)) return;
+    const quint64 seq = scenarioSeq_.load();
+    const gint64 gapUs = scenarioGapUs_.load();
+    QMetaObject::invokeMethod(this, [this, seq, nowUs, gapUs, sameSize] {
+      if (seq != scenarioSeq_ || !scenarioActive_) return;
+      completeScenarioAction(sameSize ? "same-size" : "ok", double(nowUs - scenarioArmUs_) / 1000.0,
+                             double(gapUs) / 1000.0);
+    }, Qt::QueuedConnection);
+  }
+
+  void completeScenarioAction(const QString& status, double latencyMs, double gapMs) {
+    if (!scenarioActive_) return;
+    scenarioActive_ = false;
+    scenarioAwaitPause_ = false;
+    scenarioWait_ = ScenarioWaitNone;
+    scenarioSeq_++;
+    scenarioTimeout_.stop();
+    ScenarioResult& r = scenarioCurrent_;
+    r.status = status.toStdString();
+    r.latencyMs = latencyMs;
+    r.maxGapMs = gapMs;
+    scenarioResults_.push_back(r);
+    const ScenarioAction& a = r.action;
+    QString arg = QString::fromStdString(a.arg);
+    if (a.op == ScenarioOp::Seek || a.op == ScenarioOp::Rate) arg = QString::number(a.value);
+    if (a.op == ScenarioOp::Pause && a.holdMs) arg = QString::number(a.holdMs);
+    const QJsonObject line{
+      {"index", int(r.index)}, {"line", a.line}, {"action", scenarioOpName(a.op)}, {"arg", arg},
+      {"scheduled_ms", double(r.scheduledMs)}, {"issued_ms", double(r.issuedMs)},
+      {"latency_ms", latencyMs}, {"max_gap_ms", gapMs}, {"status", status},
+    };
+    if (scenarioOut_.isOpen()) {
+      scenarioOut_.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+      scenarioOut_.flush();
+    }
+    qInfo().noquote() << QString("[SCENARIO] #%1 %2 %3: %4 latency=%5 ms gap=%6 ms (late %7 ms)")
+                           .arg(r.index).arg(scenarioOpName(a.op)).arg(arg).arg(status)
+                           .arg(latencyMs, 0, 'f', 1).arg(gapMs, 0, 'f', 1).arg(r.issuedMs - r.scheduledMs);
+    scenarioLastDoneMs_ = scenarioClock_.elapsed();
+    scenarioNext_++;
+    scheduleScenarioAction();
+  }
+
+  void finishScenario() {
+    QJsonArray summary;
+    size_t failed = 0;
+    for (const ScenarioSummary& s : summarizeScenario(scenarioResults_)) {
+      failed += s.failed;
+      summary.append(QJsonObject{{"action", scenarioOpName(s.op)}, {"count", int(s.count)},
+                                 {"failed", int(s.failed)}, {"same_size", int(s.sameSize)},
+                                 {"q50_ms", s.q50}, {"q95_ms", s.q95},
+                                 {"max_ms", s.max}, {"max_gap_ms", s.maxGap}});
+      qInfo().noquote() << QString("[SCENARIO][METRICS] %1: n=%2 failed=%3 same-size=%4 q50=%5 q95=%6 max=%7 ms max-gap=%8 ms")
+                             .arg(scenarioOpName(s.op)).arg(s.count).arg(s.failed).arg(s.sameSize)
+                             .arg(s.q50, 0, 'f', 1).arg(s.q95, 0, 'f', 1).arg(s.max, 0, 'f', 1)
+                             .arg(s.maxGap, 0, 'f', 1);
+    }
+    if (scenarioOut_.isOpen()) {
+      const QJsonObject line{{"summary", summary}, {"wall_ms", double(scenarioClock_.elapsed())},
+                             {"failed", int(failed)}};
+      scenarioOut_.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+      scenarioOut_.close();
+    }
+    scenarioFailed_ += failed;
+    reportSessionCpu();
+    qInfo() << "[SCENARIO] done;" << failed << "failed action(s)";
+    // The run is the test: exit once every player's scenario is through,
+    // failing if any of them failed
+    if (--scenariosRunning() == 0) {
+      QCoreApplication::exit(scenarioFailed_ ? 1 : 0);
+    }
+  }
+
+  // ---------- Soak mode (--soak) ----------
+  static int& soaksRunning() {
+    static int running = 0;
+    return running;
+  }
+
+  void setupSoak(const PlayerOptions& opts) {
+    if (!clipLoop_) {
+      qWarning() << "[SOAK] clip looping is unavailable here; the soak ends at EOS";
+    }
+    soakOut_.setFileName(opts.soakFile);
+    if (!soakOut_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      qWarning() << "[SOAK] cannot write" << opts.soakFile << "- samples are only logged";
+    } else {
+      soakOut_.write(QByteArray::fromStdString(SoakMonitor::csvHeader()) + '\n');
+      soakOut_.flush();
+    }
+    soakTimer_.setInterval(std::max(1, opts.soakIntervalS) * 1000);
+    connect(&soakTimer_, &QTimer::timeout, this, &GstQtPlayer::sampleSoak);
+    // Drift is read once a second and the interval's median kept, so one
+    // sample landing on a loop boundary or a late frame doesn't count
+    soakDriftTimer_.setInterval(1000);
+    connect(&soakDriftTimer_, &QTimer::timeout, this, [this] {
+      const double lag = videoLagMs();
+      if (!std::isnan(lag)) soakDrift_.push_back(lag);
+    });
+    soaksRunning()++;
+    const double hours = opts.soakHours;
+    QTimer::singleShot(0, this, [this, hours] {
+      attachSinkProbeIfNeeded();
+      if (states_.target() != GST_STATE_PLAYING) togglePlayPause();
+      {
+        std::lock_guard<std::mutex> lock(soakMutex_);
+        soakIntervalsUs_.clear();
+      }
+      soakFramesBase_ = sinkFrames_.load();
+      soakLoopsBase_ = clipLoopPasses_.load();
+      soakClock_.start();
+      soakActive_ = true;
+      soakTimer_.start();
+      soakDriftTimer_.start();
+      qInfo().noquote() << QString("[SOAK] sampling every %1 s into %2%3")
+                             .arg(soakTimer_.interval() / 1000).arg(soakOut_.fileName())
+                             .arg(hours > 0 ? QString(" for %1 h").arg(hours) : QString(" until closed"));
+      if (hours > 0) {
+        QTimer::singleShot(qint64(hours * 3600.0 * 1000.0), this, [this] { finishSoak(true); });
+      }
+    });
+  }
+
+  // How far the video frame on screen is behind the pipeline clock (the
+  // audio sink's clock whenever there is audio), centred on the frame's
+  // display slot: ~0 in sync, growing when video falls behind. NaN unless
+  // playing with both branches.
+  double videoLagMs() const {
+    if (ownsVideoBranch_ || ownsAudioBranch_ || !asink_ || states_.busy() || states_.target() != GST_STATE_PLAYING) return NAN;
+    GstElement* sink = renderingSink(vsink_);
+    if (!sink) return NAN;
+    GstSample* sample = nullptr;
+    g_object_get(sink, "last-sample", &sample, NULL);
+    gst_object_unref(sink);
+    if (!sample) return NAN;
+    GstClockTime rt = GST_CLOCK_TIME_NONE;
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    const GstSegment* seg = gst_sample_get_segment(sample);
+    if (buf && seg && GST_BUFFER_PTS_IS_VALID(buf)) {
+      const GstClockTime half = GST_BUFFER_DURATION_IS_VALID(buf) ? GST_BUFFER_DURATION(buf) / 2 : 0;
+      rt = gst_segment_to_running_time(seg, GST_FORMAT_TIME, GST_BUFFER_PTS(buf) + half);
+    }
+    gst_sample_unref(sample);
+    GstClock* clock = gst_element_get_clock(pipeline_);
+    if (!GST_CLOCK_TIME_IS_VALID(rt) || !clock) {
+      if (clock) gst_object_unref(clock);
+      return NAN;
+    }
+    const GstClockTime now = gst_clock_get_time(clock) - gst_element_get_base_time(pipeline_);
+    gst_object_unref(clock);
+    GstClockTime latency = gst_pipeline_get_latency(GST_PIPELINE(pipeline_));
+    if (!GST_CLOCK_TIME_IS_VALID(latency)) latency = 0;
+    return double(gint64(now) - gint64(latency) - gint64(rt)) / GST_MSECOND;
+  }
+
+  // The element that renders for sink: sink itself, or the real sink inside
+  // a bin such as autovideosink. New reference, nullptr when there is none.
+  static GstElement* renderingSink(GstElement* sink) {
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(sink), "last-sample")) {
+      return GST_ELEMENT(gst_object_ref(sink));
+    }
+    if (!GST_IS_BIN(sink)) return nullptr;
+    GstElement* found = nullptr;
+    GstIterator* it = gst_bin_iterate_sinks(GST_BIN(sink));
+    GValue item = G_VALUE_INIT;
+    while (!found && gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      found = renderingSink(GST_ELEMENT(g_value_get_object(&item)));
+      g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return found;
+  }
+
+  void sampleSoak() {
+    SoakSample s;
+    s.elapsedS = double(soakClock_.elapsed()) / 1000.0;
+    s.rssBytes = uint64_t(processRssBytes());
+    s.fds = processFdCount();
+    s.threads = processThreadCount();
+    std::vector<int> intervals;
+    {
+      std::lock_guard<std::mutex> lock(soakMutex_);
+      intervals.swap(soakIntervalsUs_);
+    }
+    s.intervalQ95Ms = double(percentile(intervals, 95.0)) / 1000.0;
+    s.driftMs = NAN;
+    if (!soakDrift_.empty()) {
+      std::nth_element(soakDrift_.begin(), soakDrift_.begin() + long(soakDrift_.size() / 2), soakDrift_.end());
+      s.driftMs = soakDrift_[soakDrift_.size() / 2];
+      soakDrift_.clear();
+    }
+    s.frames = sinkFrames_.load() - soakFramesBase_;
+    s.loops = uint64_t(clipLoopPasses_.load() - soakLoopsBase_);
+    if (soakOut_.isOpen()) {
+      soakOut_.write(QByteArray::fromStdString(SoakMonitor::csvLine(s)) + '\n');
+      soakOut_.flush();
+    }
+    qInfo().noquote() << QString("[SOAK] t=%1 min rss=%2 MB fds=%3 threads=%4 interval-q95=%5 ms drift=%6 ms frames=%7 loops=%8")
+                           .arg(s.elapsedS / 60.0, 0, 'f', 1).arg(double(s.rssBytes) / (1024 * 1024), 0, 'f', 1)
+                           .arg(s.fds).arg(s.threads).arg(s.intervalQ95Ms, 0, 'f', 1)
+                           .arg(std::isnan(s.driftMs) ? QString("n/a") : QString::number(s.driftMs, 'f', 1))
+                           .arg(s.frames).arg(s.loops);
+    for (SoakSeries series : soak_.add(s)) {
+      const SoakTrend t = soak_.trend(series);
+      qWarning().noquote() << QString("[SOAK] %1 keeps growing: %2 -> %3 (trend +%4 over %5 samples, tau=%6)")
+                                .arg(soakSeriesName(series)).arg(t.first, 0, 'f', 1).arg(t.last, 0, 'f', 1)
+                                .arg(t.growth, 0, 'f', 1).arg(t.samples).arg(t.tau, 0, 'f', 2);
+    }
+  }
+
+  void finishSoak(bool exitWhenDone) {
+    if (!soakActive_.exchange(false)) return;
+    soakTimer_.stop();
+    soakDriftTimer_.stop();
+    sampleSoak();
+    for (size_t i = 0; i < size_t(SoakSeries::Count); ++i) {
+      const SoakTrend t = soak_.trend(SoakSeries(i));
+      qInfo().noquote() << QString("[SOAK][METRICS] %1: %2 -> %3 trend %4 over %5 samples tau=%6 %7")
+                             .arg(soakSeriesName(t.series)).arg(t.first, 0, 'f', 1).arg(t.last, 0, 'f', 1)
+                             .arg(t.growth, 0, 'f', 1).arg(t.samples).arg(t.tau, 0, 'f', 2)
+                             .arg(t.flagged ? "FLAGGED" : "stable");
+    }
+    soakOut_.close();
+    const bool flagged = soak_.anyFlagged();
+    soakFlagged_ = soakFlagged_ || flagged;
+    qInfo() << "[SOAK] done after" << QString::number(soakClock_.elapsed() / 60000.0, 'f', 1) << "min;"
+            << (flagged ? "growth or degradation flagged" : "no trend flagged");
+    // Unattended runs: the exit code is the verdict once every player is through
+    if (--soaksRunning() == 0 && exitWhenDone) {
+      QCoreApplication::exit(soakFlagged_ ? 1 : 0);
+    }
+  }
+
+  std::vector<GstElement*> videoBranch() const {
+    return {qVideo_, vscale_, vconvert_, vcaps_, vselector_, vsink_};
+  }
+
+  std::vector<GstElement*> audioBranch() const {
+    return {qAudio_, aconv_, ares_, asink_};
+  }
+
+  void disableVideoControls() {
+    videoArea_->hide();
+    for (QPushButton* b : {throttleBtn_, stepBackBtn_, stepFwdBtn_, markABtn_, markBBtn_, loopBtn_, reverseBtn_}) {
+      b->setEnabled(false);
+    }
+  }
+
+  void enableVideoControls() {
+    videoArea_->show();
+    for (QPushButton* b : {throttleBtn_, stepBackBtn_, stepFwdBtn_, markABtn_, markBBtn_, loopBtn_, reverseBtn_}) {
+      b->setEnabled(true);
     }
+  }
 
-    // Fallback / non-encrypted path: link demux pad -> queue sink
-    GstPad* sinkpad = gst_element_get_static_pad(targetQueue, "sink");
-    if (sinkpad) {
-      if (!gst_pad_is_linked(sinkpad)) {
-        GstPadLinkReturn r = gst_pad_link(newPad, sinkpad);
-        if (r != GST_PAD_LINK_OK) {
-          qWarning() << "[LINK] Failed to link decodebin pad (" << name << ") -> queue. Code:" << r;
-        } else {
-          qInfo() << "[LINK] Linked decodebin pad ->" << (isVideo ? "video" : "audio") << "queue";
-        }
-      } else {
-        qInfo() << "[LINK] queue sink pad already linked";
+  // Cache taps what reaches the selector from the decode path; a parentless
+  // src pad linked to a second selector input presents cached frames.
+  void setupFrameCache(const PlayerOptions& opts) {
+    frameCache_.setBudget(budget_.active() ? budget_.frameCacheBytes()
+                                           : size_t(std::max<qint64>(0, opts.frameCacheBytes)));
+    g_object_set(vselector_, "sync-streams", FALSE, "cache-buffers", FALSE, NULL);
+    GstPad* tap = gst_element_get_static_pad(vcaps_, "src");
+    mainSelPad_ = gst_pad_get_peer(tap);
+    gst_pad_add_probe(tap,
+                      (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                      &GstQtPlayer::onFrameCacheProbe, this, nullptr);
+    gst_object_unref(tap);
+
+    GstPad* selSink = gst_element_request_pad_simple(vselector_, "sink_%u");
+    cachePad_ = gst_pad_new("cachesrc", GST_PAD_SRC);
+    gst_pad_set_active(cachePad_, TRUE);
+    if (!selSink || gst_pad_link_full(cachePad_, selSink, GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK) {
+      qWarning() << "[CACHE] Cannot link cache presenter; stepping will always re-decode";
+    }
+    cacheSelPad_ = selSink;
+    g_object_set(vselector_, "active-pad", mainSelPad_, NULL);
+    presenter_ = std::thread(&GstQtPlayer::presenterLoop, this);
+    qInfo() << "[CACHE] decoded-frame cache budget (MB):" << frameCache_.budget() / (1024 * 1024);
+  }
+
+  static GstPadProbeReturn onFrameCacheProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+      if (GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info)) {
+        self->frameCache_.insert(buf);
       }
-      gst_object_unref(sinkpad);
-    } else {
-      qWarning() << "[LINK] target queue sink pad not available";
+      return GST_PAD_PROBE_OK;
+    }
+    GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+    if (ev && GST_EVENT_TYPE(ev) == GST_EVENT_CAPS) {
+      GstCaps* caps = nullptr;
+      gst_event_parse_caps(ev, &caps);
+      self->frameCache_.setCaps(caps);
     }
+    return GST_PAD_PROBE_OK;
+  }
 
-    gst_caps_unref(caps);
+  void enterCacheMode() {
+    if (cacheMode_) return;
+    cacheMode_ = true;
+    g_object_set(vselector_, "active-pad", cacheSelPad_, NULL);
   }
 
-  static GstPadProbeReturn onSinkBufferProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
-    auto* self = static_cast<GstQtPlayer*>(userData);
-    if (!self) return GST_PAD_PROBE_OK;
+  // Back to the decode path: drop the cached preroll and re-sync decoding on
+  // the frame currently shown.
+  void leaveCacheMode(bool resync = true) {
+    if (!cacheMode_) return;
+    loopTimer_.stop();
+    cacheMode_ = false;
+    // Release a presenter blocked in preroll, then leave the pad usable again
+    gst_pad_push_event(cachePad_, gst_event_new_flush_start());
+    g_object_set(vselector_, "active-pad", mainSelPad_, NULL);
+    gst_pad_push_event(cachePad_, gst_event_new_flush_stop(TRUE));
+    if (resync && GST_CLOCK_TIME_IS_VALID(GstClockTime(shownPts_))) {
+      seekAtRate(seekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE), shownPts_);
+    }
+  }
 
-    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
-    if (!buf) return GST_PAD_PROBE_OK;
+  // GUI thread: hand a sample to the presenter. flush-start first so a
+  // presenter blocked in the paused sink's preroll wait lets go.
+  void presentCached(GstSample* sample) {
+    gst_pad_push_event(cachePad_, gst_event_new_flush_start());
+    {
+      std::lock_guard<std::mutex> lock(presentMutex_);
+      if (pendingSample_) gst_sample_unref(pendingSample_);
+      pendingSample_ = sample;
+    }
+    presentCv_.notify_one();
+  }
 
-    GstClockTime pts = GST_BUFFER_PTS(buf);
-    if (!self->firstFrameSeen_) {
-      self->firstFrameSeen_ = true;
-      // Time To First Frame = wallclock since we entered PLAYING
-      const qint64 ttff_ms = self->playStartTimer_.elapsed();
-      qInfo() << "[METRICS] TTFF(ms):" << ttff_ms;
+  // Presenter thread: flush-stop, (caps), segment, push. The push blocks in
+  // the sink's preroll until the next presentCached() flushes it.
+  void presenterLoop() {
+    bool streamStarted = false;
+    GstCaps* lastCaps = nullptr;
+    for (;;) {
+      GstSample* sample = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(presentMutex_);
+        presentCv_.wait(lock, [this] { return presenterQuit_ || pendingSample_; });
+        if (presenterQuit_) break;
+        std::swap(sample, pendingSample_);
+      }
+      gst_pad_push_event(cachePad_, gst_event_new_flush_stop(TRUE));
+      if (!streamStarted) {
+        gst_pad_push_event(cachePad_, gst_event_new_stream_start("frame-cache"));
+        streamStarted = true;
+      }
+      GstCaps* caps = gst_sample_get_caps(sample);
+      if (caps && (!lastCaps || !gst_caps_is_equal(caps, lastCaps))) {
+        gst_caps_replace(&lastCaps, caps);
+        gst_pad_push_event(cachePad_, gst_event_new_caps(caps));
+      }
+      GstBuffer* buf = gst_sample_get_buffer(sample);
+      GstSegment seg;
+      gst_segment_init(&seg, GST_FORMAT_TIME);
+      seg.start = seg.time = GST_BUFFER_PTS(buf);
+      gst_pad_push_event(cachePad_, gst_event_new_segment(&seg));
+      gst_pad_push(cachePad_, gst_buffer_ref(buf));
+      gst_sample_unref(sample);
     }
+    if (lastCaps) gst_caps_unref(lastCaps);
+  }
 
-    if (pts != GST_CLOCK_TIME_NONE) {
-      if (self->lastPts_ != GST_CLOCK_TIME_NONE) {
-        // Compute frame interval in milliseconds based on PTS delta
-        gint64 delta_ns = (gint64)pts - (gint64)self->lastPts_;
-        if (delta_ns > 0) {
-          int delta_ms = static_cast<int>(delta_ns / GST_MSECOND);
-          self->frames_.push_back(delta_ms);
-          self->frameCount_++;
+  void stopPresenter() {
+    if (!presenter_.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lock(presentMutex_);
+      presenterQuit_ = true;
+    }
+    presentCv_.notify_one();
+    gst_pad_push_event(cachePad_, gst_event_new_flush_start());
+    presenter_.join();
+    if (pendingSample_) gst_sample_unref(pendingSample_);
+    pendingSample_ = nullptr;
+  }
 
-          if (self->frameCount_ % 60 == 0) {
-            // Compute q50 and q95 on a copy (percentile does nth_element and mutates).
-            std::vector<int> copy = self->frames_;
-            int q50 = percentile(copy, 50.0);
-            // Re-copy to restore distribution before next percentile
-            copy = self->frames_;
-            int q95 = percentile(copy, 95.0);
-            qInfo() << "[METRICS] frame-interval-ms q50=" << q50 << " q95=" << q95 << " (n=" << self->frameCount_ << ")";
-          }
+  static const char* throttleName(int mode) {
+    switch (mode) {
+      case ThrottleKeyframes: return "keyframes";
+      case ThrottleSkip:      return "skip";
+      default:                return "off";
+    }
+  }
 
-          // Keep vector from growing unbounded; retain last ~1000 samples
-          if (self->frames_.size() > 1200) {
-            self->frames_.erase(self->frames_.begin(), self->frames_.begin() + 200);
-          }
-        }
+  static void onDecodebinElementAdded(GstBin* /*bin*/, GstElement* element, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    GstElementFactory* f = gst_element_get_factory(element);
+    const gchar* klass = f ? gst_element_factory_get_metadata(f, GST_ELEMENT_METADATA_KLASS) : nullptr;
+    if (!klass || !strstr(klass, "Decoder") || !strstr(klass, "Video")) {
+      return;
+    }
+    GstPad* sinkpad = gst_element_get_static_pad(element, "sink");
+    if (!sinkpad) return;
+    gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onVideoDecoderInputProbe, self, nullptr);
+    gst_object_unref(sinkpad);
+    qInfo() << "[VISIBILITY] Throttle probe attached to" << GST_ELEMENT_NAME(element);
+  }
+
+  // Runs on the decoder's streaming thread, before any decode work happens
+  static GstPadProbeReturn onVideoDecoderInputProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
+    auto* self = static_cast<GstQtPlayer*>(userData);
+    const int mode = self->videoThrottle_.load(std::memory_order_relaxed);
+    if (mode == ThrottleNone) return GST_PAD_PROBE_OK;
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (mode == ThrottleSkip || GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+      self->hiddenDropped_++;
+      return GST_PAD_PROBE_DROP;
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  static GstPadProbeReturn onPixelCountProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
+    auto* counter = static_cast<PixelCounter*>(userData);
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+      counter->pixels += counter->framePixels.load(std::memory_order_relaxed);
+      return GST_PAD_PROBE_OK;
+    }
+    GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+    if (ev && GST_EVENT_TYPE(ev) == GST_EVENT_CAPS) {
+      GstCaps* caps = nullptr;
+      gst_event_parse_caps(ev, &caps);
+      GstVideoInfo vi;
+      if (caps && gst_video_info_from_caps(&vi, caps)) {
+        counter->framePixels = quint64(vi.width) * quint64(vi.height);
       }
-      self->lastPts_ = pts;
     }
     return GST_PAD_PROBE_OK;
   }
 
+  void attachPixelCounters() {
+    GstPad* in  = gst_element_get_static_pad(vscale_, "sink");
+    GstPad* out = gst_element_get_static_pad(vsink_, "sink");
+    const auto mask = (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM);
+    if (in) {
+      gst_pad_add_probe(in, mask, &GstQtPlayer::onPixelCountProbe, &decodedPixels_, nullptr);
+      gst_object_unref(in);
+    }
+    if (out) {
+      gst_pad_add_probe(out, mask, &GstQtPlayer::onPixelCountProbe, &sinkPixels_, nullptr);
+      gst_object_unref(out);
+    }
+  }
+
+  // Called from the sink probe every 60 frames (streaming thread)
+  void reportPixelRate() {
+    if (!pixelRateTimer_.isValid()) {
+      pixelRateTimer_.start();
+      decodedPixels_.lastReported = decodedPixels_.pixels;
+      sinkPixels_.lastReported = sinkPixels_.pixels;
+      return;
+    }
+    const qint64 ms = pixelRateTimer_.restart();
+    if (ms <= 0) return;
+    const quint64 dec = decodedPixels_.pixels;
+    const quint64 out = sinkPixels_.pixels;
+    const double decRate = double(dec - decodedPixels_.lastReported) * 1000.0 / ms;
+    const double outRate = double(out - sinkPixels_.lastReported) * 1000.0 / ms;
+    decodedPixels_.lastReported = dec;
+    sinkPixels_.lastReported = out;
+    qInfo() << "[METRICS] Mpixels/s decoded=" << QString::number(decRate / 1e6, 'f', 1)
+            << " displayed=" << QString::number(outRate / 1e6, 'f', 1);
+  }
+
   void attachSinkProbeIfNeeded() {
     if (sinkProbeAttached_) return;
-    GstPad* sinkpad = gst_element_get_static_pad(vsink_, "sink");
+    // Audio-only: first-buffer timing is taken at the audio sink instead
+    GstElement* sink = ownsVideoBranch_ ? asink_ : vsink_;
+    GstPad* sinkpad = gst_element_get_static_pad(sink, "sink");
     if (!sinkpad) {
-      qWarning() << "[PROBE] vsink sink pad not available yet";
+      qWarning() << "[PROBE] sink pad not available yet";
       return;
     }
-    gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onSinkBufferProbe, this, nullptr);
+    sinkProbeId_ = gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, &GstQtPlayer::onSinkBufferProbe, this, nullptr);
+    positions_.attach(pipeline_, sinkpad);
     sinkProbeAttached_ = true;
-    gst_object_unref(sinkpad);
-    qInfo() << "[PROBE] Buffer probe attached to video sink";
+    sinkProbePad_ = sinkpad;   // keeps the reference
+    qInfo() << "[PROBE] Buffer probe attached to" << (ownsVideoBranch_ ? "audio" : "video") << "sink";
+  }
+
+  // Takes the buffer probe (and the position service) off its sink pad
+  void detachSinkProbe() {
+    if (!sinkProbePad_) return;
+    positions_.detach();
+    gst_pad_remove_probe(sinkProbePad_, sinkProbeId_);
+    gst_object_unref(sinkProbePad_);
+    sinkProbePad_ = nullptr;
+    sinkProbeId_ = 0;
+    sinkProbeAttached_ = false;
+  }
+
+  bool sinkProbeOn(GstElement* sink) const {
+    return sinkProbePad_ && GST_PAD_PARENT(sinkProbePad_) == sink;
   }
 
 private:
@@ -589,12 +3608,18 @@ private:
   QWidget*     videoArea_{nullptr};
   QPushButton* playBtn_{nullptr};
   QPushButton* throttleBtn_{nullptr};
+  QPushButton* stepBackBtn_{nullptr};
+  QPushButton* stepFwdBtn_{nullptr};
+  QPushButton* markABtn_{nullptr};
+  QPushButton* markBBtn_{nullptr};
+  QPushButton* loopBtn_{nullptr};
+  QPushButton* reverseBtn_{nullptr};
   QSlider*     slider_{nullptr};
 
   // GStreamer
   QString    filePath_;
   GstElement* pipeline_{nullptr};
-  GstElement* filesrc_{nullptr};
+  GstElement* source_{nullptr};
   GstElement* decodebin_{nullptr};
 
   // Video
@@ -602,6 +3627,7 @@ private:
   GstElement* vconvert_{nullptr};
   GstElement* vscale_{nullptr};
   GstElement* vcaps_{nullptr};
+  GstElement* vselector_{nullptr};   // decode path / frame-cache presenter
   GstElement* vsink_{nullptr};
 
   // Audio
@@ -610,36 +3636,1086 @@ private:
   GstElement* ares_{nullptr};
   GstElement* asink_{nullptr};
 
+  // Decoded-frame cache (stepping, A-B loop)
+  FrameCache    frameCache_;
+  GstPad*       cachePad_{nullptr};     // parentless src pad feeding vselector_
+  GstPad*       mainSelPad_{nullptr};
+  GstPad*       cacheSelPad_{nullptr};
+  bool          cacheMode_{false};
+  std::thread   presenter_;
+  std::mutex    presentMutex_;
+  std::condition_variable presentCv_;
+  GstSample*    pendingSample_{nullptr};
+  bool          presenterQuit_{false};
+  std::atomic<quint64> shownPts_{GST_CLOCK_TIME_NONE};
+  std::atomic<bool> stepPending_{false};
+  bool          stepFromCache_{false};
+  QElapsedTimer stepTimer_;
+  bool          looping_{false};
+  GstClockTime  loopA_{GST_CLOCK_TIME_NONE};
+  GstClockTime  loopB_{GST_CLOCK_TIME_NONE};
+  GstClockTime  loopPos_{GST_CLOCK_TIME_NONE};
+  int           loopPasses_{0};
+  QTimer        loopTimer_;
+
+  // Seamless clip loop (segment seeks)
+  bool          clipLoop_{false};
+  bool          clipLoopArmed_{false};
+  std::atomic<int>  clipLoopPasses_{0};
+  std::atomic<bool> clipLoopWrapPending_{false};
+  GstClockTime  clipLoopLastPts_{GST_CLOCK_TIME_NONE};   // streaming thread only
+  GstClockTime  clipLoopLastRtEnd_{GST_CLOCK_TIME_NONE};
+  double        clipLoopGapMax_{0.0};
+
+  // Reverse playback (GOP-wise forward decode, presented backwards)
+  ReverseDecoder reverse_;
+  unsigned      reverseWorkers_{0};
+  bool          reversing_{false};
+  GstClockTime  reversePts_{GST_CLOCK_TIME_NONE};
+  int           reverseShown_{0};
+  int           reverseUnderruns_{0};
+  bool          reverseFirstFrame_{false};
+  QElapsedTimer reverseWall_;
+  QElapsedTimer reverseReport_;
+  QTimer        reverseTimer_;
+
+  // Timeshift (ring between a live recording pipeline and playback)
+  bool          timeshift_{false};
+  TimeshiftRing ring_;
+  GstElement*   recPipeline_{nullptr};
+  GstBus*       recBus_{nullptr};
+  std::atomic<quint64> readPos_{0};
+  std::atomic<bool> ringSeekPending_{false};
+  qint64        ringBaseTime_{-1};                      // arrival time playback (re)started from
+  GstClockTime  ringBasePos_{GST_CLOCK_TIME_NONE};      // first stream time shown since then
+  QTimer        timeshiftStatsTimer_;
+  QElapsedTimer timeshiftStatsWall_;
+  quint64       timeshiftLastBytes_{0};
+
+  // Process-isolated decoding (appsrc fed from the worker's frame ring)
+  bool          isolated_{false};
+  DecodeWorker  worker_;
+  std::atomic<bool> isolatedStopping_{false};
+  std::atomic<GstClockTime> isolatedLastPts_{GST_CLOCK_TIME_NONE};
+  int           isolatedRespawns_{0};   // consecutive, reset by the next frame
+  std::string   isolatedCaps_;
+  std::mutex    isolatedMutex_;
+  std::vector<int> isolatedTransitUs_;  // worker commit → handed downstream
+
+  // Scenario replay (--scenario); the wait is resolved by the sink probe
+  enum ScenarioWait { ScenarioWaitNone, ScenarioWaitFrame, ScenarioWaitSegment, ScenarioWaitSize };
+  std::vector<ScenarioAction> scenario_;
+  std::vector<ScenarioResult> scenarioResults_;
+  ScenarioResult scenarioCurrent_;
+  size_t        scenarioNext_{0};
+  bool          scenarioActive_{false};
+  bool          scenarioAwaitPause_{false};
+  static inline size_t scenarioFailed_{0};   // every player's, for the exit code
+  qint64        scenarioLastDoneMs_{0};
+  gint64        scenarioArmUs_{0};
+  QElapsedTimer scenarioClock_;
+  QTimer        scenarioTimer_;
+  QTimer        scenarioTimeout_;
+  QFile         scenarioOut_;
+  std::atomic<int>     scenarioWait_{ScenarioWaitNone};
+  std::atomic<quint64> scenarioSeq_{0};
+  std::atomic<gint64>  scenarioWaitFromUs_{0};
+  std::atomic<gint64>  scenarioGapUs_{0};
+  std::atomic<guint32> scenarioSegment_{GST_SEQNUM_INVALID};
+  std::atomic<int>     scenarioWidth_{0};
+  std::atomic<int>     scenarioHeight_{0};
+
+  // Soak mode (--soak); the sink probe collects wall-clock frame intervals
+  SoakMonitor   soak_;
+  QFile         soakOut_;
+  QTimer        soakTimer_;
+  QTimer        soakDriftTimer_;
+  QElapsedTimer soakClock_;
+  std::vector<double> soakDrift_;
+  std::vector<int> soakIntervalsUs_;
+  std::mutex    soakMutex_;
+  std::atomic<bool> soakActive_{false};
+  quint64       soakFramesBase_{0};
+  int           soakLoopsBase_{0};
+  static inline bool soakFlagged_{false};
+
+  // Control socket (--control-socket)
+  ControlSocket control_;
+  quint64       controlRequests_{0};
+  double        rate_{1.0};
+
+  // Per-player memory budget (--memory-budget)
+  MemoryBudget  budget_;
+  QTimer        budgetTimer_;
+
+  // Frame memory: vconvert_ timing, page faults, rendition pools, optional hugepage allocator
+  GstAllocator* hugeAllocator_{nullptr};
+  RenditionPools renditionPools_;
+  unsigned      renditionFrames_{4};
+  qint64        renditionCacheBytes_{0};
+  std::atomic<int> prewarmedInFormat_{GST_VIDEO_FORMAT_UNKNOWN};
+  std::atomic<int> prewarmedOutFormat_{GST_VIDEO_FORMAT_UNKNOWN};
+  struct PrewarmJob {
+    GstVideoFormat format{GST_VIDEO_FORMAT_UNKNOWN};
+    std::vector<std::pair<int, int>> sizes;
+  };
+  std::mutex    prewarmMutex_;
+  std::deque<PrewarmJob> prewarmJobs_;
+  bool          prewarmRunning_{false};
+  std::thread   prewarmThread_;
+  QTimer        poolStatsTimer_;
+  QElapsedTimer poolStatsWall_;
+  quint64       poolLastRequests_{0};
+  quint64       poolLastFresh_{0};
+  std::atomic<gint64> convertStartUs_{0};
+  std::mutex    convertMutex_;
+  std::vector<int> convertUs_;
+  qint64        sessionMinorFaults_{0};
+  qint64        sessionMajorFaults_{0};
+
   // Optional decrypt element (cencdec)
   GstElement* cencdec_{nullptr};
 
+  // Audio-only fast path
+  bool        audioOnly_{false};
+  bool        ownsVideoBranch_{false};   // video elements held outside the pipeline
+  bool        ownsAudioBranch_{false};   // audio elements held outside the pipeline (isolated decode)
+  std::atomic<bool> videoLinked_{false};
+  bool          videoDropped_{false};   // dropVideoBranch() took it out (not --audio-only)
+  GstElement* vdiscard_{nullptr};        // fakesink for demuxed video
+
+  // Audio path: compressed passthrough and resampler cost
+  bool        audioPassthrough_{false};
+  std::atomic<bool> audioPassthroughActive_{false};
+  std::atomic<qint64> resampleNs_{0};        // wall time spent inside audioresample
+  std::atomic<qint64> resampledAudioNs_{0};  // audio duration pushed through it
+
+  // Level / loudness meter (written on the streaming thread, read lock-free by the GUI)
+  QLabel*        levelLabel_{nullptr};
+  QTimer         meterTimer_;
+  LoudnessMeter  levelMeter_;
+  LoudnessMeter::SampleFormat meterFormat_{LoudnessMeter::SampleFormat::F32};
+  int            meterChannels_{0};
+  bool           meterActive_{false};
+
   GstBus*     bus_{nullptr};
   QTimer      busTimer_;
   QTimer      sliderTimer_;
+  PositionService positions_;
+  PlayerStateMachine states_;
+  ThreadPolicy  threadPolicy_;     // pinned/named streaming-thread pools
+
+  // Error recovery
+  enum RecoveryStage { RecoveryIdle, RecoveryScheduled, RecoveryPrerolling, RecoverySeeking };
+  bool          recoveryEnabled_{true};
+  RecoveryStage recoveryStage_{RecoveryIdle};
+  ErrorClass    recoveryClass_{ErrorClass::Other};
+  GstElement*   recoverySink_{nullptr};
+  GstClockTime  recoveryPos_{GST_CLOCK_TIME_NONE};
+  GstClockTime  lastGoodPos_{GST_CLOCK_TIME_NONE};
+  bool          recoveryWasPlaying_{false};
+  std::atomic<bool> recoveryFramePending_{false};
+  QTimer        recoveryTimer_;
+  QElapsedTimer recoveryClock_;    // first error → first frame at the resume point
+  QElapsedTimer recoveryUptime_;
+  RecoveryBackoff backoff_;
+  RecoveryStats recoveryStats_;
+
+  // Stall watchdog
+  int           stallFrames_{15};
+  bool          stallRecover_{false};
+  int           stallCount_{0};
+  std::atomic<bool>   stalled_{false};
+  std::atomic<gint64> lastSinkBufferUs_{0};
+  std::atomic<gint64> sinkFrameUs_{40000};
+  std::atomic<quint64> sinkFrames_{0};     // every buffer reaching the sink
+  std::atomic<qint64>  lastTtffMs_{-1};
+  std::atomic<int>     intervalQ50_{0};    // last frame-interval percentiles (ms)
+  std::atomic<int>     intervalQ95_{0};
+  gint64        playingSinceUs_{0};
+  QTimer        watchdogTimer_;
+  quint64     sliderTicks_{0};
 
   // ABR simulation
   bool        lowQuality_{false};
 
+  // Auto-fit: vcaps_ follows the on-screen size of videoArea_
+  bool        autoFit_{true};
+  QSize       fitSize_;          // invalid = native resolution
+  QTimer      fitTimer_;         // resize debounce
+
+  // Resize coalescing (render rectangle + expose batched per display frame)
+  QTimer      overlayTimer_;
+  QTimer      resizeIdleTimer_;  // detects end of an interactive resize
+  bool        overlayDirty_{false};
+  int         resizeEvents_{0};
+  int         exposeCalls_{0};
+  int         resizeBurstEvents_{0};
+  int         resizeBurstExposes_{0};
+  std::atomic<bool> resizing_{false};
+  std::mutex       resizeFramesMutex_;
+  std::vector<int> resizeFrames_;  // wall-clock gaps (ms) between sink frames during the burst
+
+  // Visibility-aware throttling of the video decoder input
+  enum { ThrottleNone = 0, ThrottleKeyframes = 1, ThrottleSkip = 2 };
+  int         hiddenMode_{ThrottleKeyframes};
+  std::atomic<int> videoThrottle_{ThrottleNone};
+  std::atomic<int> hiddenDropped_{0};
+  bool        windowVisible_{true};
+  bool        exposeFilterInstalled_{false};
+  QElapsedTimer visibleWall_;
+  qint64      visibleCpuMs_{0};
+  qint64      hiddenCpuMs_{0};
+
   // Metrics
   QElapsedTimer playStartTimer_;
   bool          firstFrameSeen_{false};
   bool          sinkProbeAttached_{false};
+  GstPad*       sinkProbePad_{nullptr};   // ref'd; the pad onSinkBufferProbe sits on
+  gulong        sinkProbeId_{0};
   GstClockTime  lastPts_{GST_CLOCK_TIME_NONE};
   std::vector<int> frames_;
   int           frameCount_{0};
+  QElapsedTimer sessionWall_;
+  qint64        sessionCpuMs_{0};
+  PixelCounter  decodedPixels_;  // vscale_ sink: what the decoder hands us
+  PixelCounter  sinkPixels_;     // vsink_ sink: what actually gets displayed
+  QElapsedTimer pixelRateTimer_;
 };
 
 #include "main.moc"
 
+// Resampling CPU per channel for each profile at common rate conversions.
+// audiotestsrc → audioresample → fakesink runs unsynced; a baseline run
+// without rate change is subtracted so only the resampler is counted.
+static qint64 runBenchPipeline(const QString& desc, const QString& profile) {
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(desc.toUtf8().constData(), &err);
+  if (!pipe) {
+    qCritical() << "[BENCH] Failed to build pipeline:" << (err ? err->message : "unknown");
+    if (err) g_error_free(err);
+    return -1;
+  }
+  if (GstElement* r = gst_bin_get_by_name(GST_BIN(pipe), "r")) {
+    applyResampleProfile(r, profile);
+    gst_object_unref(r);
+  }
+  GstBus* bus = gst_element_get_bus(pipe);
+  const qint64 cpu0 = processCpuMs();
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                               (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  const qint64 cpu = processCpuMs() - cpu0;
+  const bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+  if (msg) gst_message_unref(msg);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+  return ok ? cpu : -1;
+}
+
+static int runResampleBenchmark(int seconds) {
+  gst_init(nullptr, nullptr);
+  struct Conversion { int in; int out; };
+  const Conversion conversions[] = {{44100, 48000}, {48000, 44100}, {48000, 96000}, {96000, 48000}, {22050, 48000}};
+  const char* profiles[] = {"low-cpu", "low-latency", "default", "high-quality"};
+  const int channelCounts[] = {1, 2, 6};
+  const int samplesPerBuffer = 1024;
+
+  qInfo() << "[BENCH] audioresample CPU, ms per second of audio per channel (" << seconds << "s per run)";
+  for (const Conversion& c : conversions) {
+    for (int ch : channelCounts) {
+      const int buffers = seconds * c.in / samplesPerBuffer;
+      const QString mask = ch > 2 ? QString(",channel-mask=(bitmask)0x%1").arg((1 << ch) - 1, 0, 16) : QString();
+      const QString src = QString("audiotestsrc num-buffers=%1 samplesperbuffer=%2 wave=pink-noise ! "
+                                  "audio/x-raw,format=F32LE,layout=interleaved,rate=%3,channels=%4%5")
+                            .arg(buffers).arg(samplesPerBuffer).arg(c.in).arg(ch).arg(mask);
+      const qint64 base = runBenchPipeline(src + " ! fakesink sync=false", "default");
+      if (base < 0) return 1;
+      const double audioSec = double(buffers) * samplesPerBuffer / c.in;
+      QString line = QString("%1->%2 Hz %3ch:").arg(c.in).arg(c.out).arg(ch);
+      for (const char* profile : profiles) {
+        const qint64 cpu = runBenchPipeline(
+          src + QString(" ! audioresample name=r ! audio/x-raw,rate=%1 ! fakesink sync=false").arg(c.out), profile);
+        if (cpu < 0) return 1;
+        const double perChannel = double(std::max<qint64>(0, cpu - base)) / audioSec / ch;
+        line += QString("  %1=%2").arg(profile).arg(perChannel, 0, 'f', 2);
+      }
+      qInfo().noquote() << "[BENCH]" << line;
+    }
+  }
+  return 0;
+}
+
+// Full-file loudness report: decode audio unsynced (as fast as the CPU
+// allows) through the same meter the GUI uses. Video is never decoded.
+static gboolean onReportAutoplugContinue(GstElement*, GstPad*, GstCaps* caps, gpointer) {
+  return isDecodableVideo(caps) ? FALSE : TRUE;
+}
+
+static GstPadProbeReturn onReportProbe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer userData) {
+  auto* meter = static_cast<LoudnessMeter*>(userData);
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(ev) == GST_EVENT_CAPS) {
+      GstCaps* caps = nullptr;
+      gst_event_parse_caps(ev, &caps);
+      LoudnessMeter::SampleFormat fmt;
+      int rate = 0, channels = 0;
+      if (meterFormatFromCaps(caps, fmt, rate, channels)) {
+        meter->configure(rate, channels);
+      }
+    }
+    return GST_PAD_PROBE_OK;
+  }
+  GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+  GstMapInfo map;
+  if (meter->configured() && buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+    // The capsfilter pins F32LE interleaved
+    meter->process(map.data, map.size / (size_t(meter->channels()) * sizeof(float)),
+                   LoudnessMeter::SampleFormat::F32);
+    gst_buffer_unmap(buf, &map);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+static int runLoudnessReport(const QString& path) {
+  gst_init(nullptr, nullptr);
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin name=dbin ! audioconvert ! "
+    "audio/x-raw,format=F32LE,layout=interleaved ! fakesink name=sink sync=false", &err);
+  if (!pipe) {
+    qCritical() << "[LOUDNESS] Failed to build pipeline:" << (err ? err->message : "unknown");
+    if (err) g_error_free(err);
+    return 1;
+  }
+  LoudnessMeter meter;
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* dbin = gst_bin_get_by_name(GST_BIN(pipe), "dbin");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  g_object_set(src, "location", path.toUtf8().constData(), NULL);
+  g_signal_connect(dbin, "autoplug-continue", G_CALLBACK(&onReportAutoplugContinue), nullptr);
+  GstPad* sinkpad = gst_element_get_static_pad(sink, "sink");
+  gst_pad_add_probe(sinkpad,
+                    (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                    &onReportProbe, &meter, nullptr);
+  gst_object_unref(sinkpad);
+  gst_object_unref(sink);
+  gst_object_unref(dbin);
+  gst_object_unref(src);
+
+  QElapsedTimer wall;
+  wall.start();
+  const qint64 cpu0 = processCpuMs();
+  GstBus* bus = gst_element_get_bus(pipe);
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                               (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  const qint64 wallMs = wall.elapsed();
+  const qint64 cpuMs = processCpuMs() - cpu0;
+  int rc = 0;
+  if (msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    GError* e = nullptr;
+    gst_message_parse_error(msg, &e, nullptr);
+    qCritical() << "[LOUDNESS][ERROR]" << (e ? e->message : "unknown");
+    if (e) g_error_free(e);
+    rc = 1;
+  }
+  if (msg) gst_message_unref(msg);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+  if (rc || !meter.configured()) {
+    if (!rc) qCritical() << "[LOUDNESS] No decodable audio stream";
+    return 1;
+  }
+
+  const double durSec = double(meter.frames()) / meter.rate();
+  qInfo().noquote() << "[LOUDNESS] file:" << path;
+  qInfo().noquote() << QString("[LOUDNESS] duration=%1 s rate=%2 channels=%3")
+                         .arg(durSec, 0, 'f', 2).arg(meter.rate()).arg(meter.channels());
+  qInfo().noquote() << QString("[LOUDNESS] integrated=%1 LUFS  LRA=%2 LU  max-momentary=%3 LUFS  max-short-term=%4 LUFS")
+                         .arg(meter.integratedLufs(), 0, 'f', 1).arg(meter.loudnessRangeLu(), 0, 'f', 1)
+                         .arg(meter.maxMomentaryLufs(), 0, 'f', 1).arg(meter.maxShortTermLufs(), 0, 'f', 1);
+  for (int ch = 0; ch < meter.channels(); ++ch) {
+    qInfo().noquote() << QString("[LOUDNESS] ch%1 peak=%2 dBFS rms=%3 dBFS")
+                           .arg(ch).arg(meter.channelPeakDb(ch), 0, 'f', 2).arg(meter.channelRmsDb(ch), 0, 'f', 2);
+  }
+  qInfo().noquote() << QString("[LOUDNESS] processed in %1 ms (cpu %2 ms) = %3x real time")
+                         .arg(wallMs).arg(cpuMs).arg(wallMs > 0 ? durSec * 1000.0 / wallMs : 0.0, 0, 'f', 1);
+  return 0;
+}
+
+// Render jitter under CPU load: the same file is played synced into a
+// fakesink twice while one busy thread per core competes for the CPU, first
+// with default scheduling, then with streaming threads started from pinned
+// pools. Lateness = clock time at render minus the buffer's running time.
+struct JitterContext {
+  ThreadPolicy* policy{nullptr};
+  GstElement*   dbin{nullptr};
+  GstElement*   queue{nullptr};
+  std::vector<int> lateUs;
+};
+
+static GstBusSyncReply onJitterSync(GstBus*, GstMessage* msg, gpointer userData) {
+  auto* ctx = static_cast<JitterContext*>(userData);
+  if (ctx->policy && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+    GstStreamStatusType type;
+    GstElement* owner = nullptr;
+    gst_message_parse_stream_status(msg, &type, &owner);
+    ctx->policy->install(msg, classifyTaskOwner(owner, ctx->dbin, ctx->queue, nullptr));
+  }
+  return GST_BUS_PASS;
+}
+
+static void onJitterHandoff(GstElement* sink, GstBuffer* buf, GstPad* pad, gpointer userData) {
+  auto* ctx = static_cast<JitterContext*>(userData);
+  if (!GST_BUFFER_PTS_IS_VALID(buf)) return;
+  GstEvent* ev = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+  if (!ev) return;
+  const GstSegment* seg = nullptr;
+  gst_event_parse_segment(ev, &seg);
+  const guint64 rt = gst_segment_to_running_time(seg, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+  gst_event_unref(ev);
+  GstClock* clock = gst_element_get_clock(sink);
+  if (!clock || !GST_CLOCK_TIME_IS_VALID(rt)) {
+    if (clock) gst_object_unref(clock);
+    return;
+  }
+  const gint64 now = gint64(gst_clock_get_time(clock) - gst_element_get_base_time(sink));
+  gst_object_unref(clock);
+  ctx->lateUs.push_back(int((now - gint64(rt)) / 1000));
+}
+
+static bool runJitterPass(const QString& path, int seconds, ThreadPolicy* policy, std::vector<int>& lateUs) {
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin name=dbin ! videoconvert ! queue name=q ! "
+    "fakesink name=sink sync=true signal-handoffs=true", &err);
+  if (!pipe) {
+    qCritical() << "[JITTER] Failed to build pipeline:" << (err ? err->message : "unknown");
+    if (err) g_error_free(err);
+    return false;
+  }
+  JitterContext ctx;
+  ctx.policy = policy;
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  ctx.dbin = gst_bin_get_by_name(GST_BIN(pipe), "dbin");
+  ctx.queue = gst_bin_get_by_name(GST_BIN(pipe), "q");
+  g_object_set(src, "location", path.toUtf8().constData(), NULL);
+  g_signal_connect(sink, "handoff", G_CALLBACK(&onJitterHandoff), &ctx);
+  GstBus* bus = gst_element_get_bus(pipe);
+  gst_bus_set_sync_handler(bus, &onJitterSync, &ctx, nullptr);
+
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GstClockTime(seconds) * GST_SECOND,
+                                               (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  bool ok = true;
+  if (msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    GError* e = nullptr;
+    gst_message_parse_error(msg, &e, nullptr);
+    qCritical() << "[JITTER][ERROR]" << (e ? e->message : "unknown");
+    if (e) g_error_free(e);
+    ok = false;
+  }
+  if (msg) gst_message_unref(msg);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
+  gst_object_unref(bus);
+  gst_object_unref(ctx.queue);
+  gst_object_unref(ctx.dbin);
+  gst_object_unref(sink);
+  gst_object_unref(src);
+  gst_object_unref(pipe);
+  lateUs.swap(ctx.lateUs);
+  return ok && !lateUs.empty();
+}
+
+static int runJitterBenchmark(const QString& path, const QString& policySpec, int seconds) {
+  gst_init(nullptr, nullptr);
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  // Default comparison policy: demux on the first core, render alone on the
+  // last one with SCHED_FIFO, decoders on the rest
+  QString spec = policySpec;
+  if (spec.isEmpty()) {
+    const unsigned last = cores - 1;
+    spec = QString("demux:0;vrender:%1@fifo10").arg(last);
+    if (cores > 2) spec += QString(";decode:1-%1").arg(last - 1);
+  }
+  ThreadPolicy policy;
+  std::string perr;
+  if (!policy.parse(spec.toStdString(), perr)) {
+    qCritical().noquote() << "[JITTER] bad thread policy:" << QString::fromStdString(perr);
+    return 1;
+  }
+
+  std::atomic<bool> stopLoad{false};
+  std::vector<std::thread> load;
+  for (unsigned i = 0; i < cores; ++i) {
+    load.emplace_back([&stopLoad] {
+      volatile double x = 1.0;
+      while (!stopLoad.load(std::memory_order_relaxed)) {
+        for (int k = 0; k < 10000; ++k) x = x * 1.0000001 + 1e-9;
+      }
+    });
+  }
+  qInfo().noquote() << QString("[JITTER] %1 busy threads on %2 cores, %3 s per pass").arg(cores).arg(cores).arg(seconds);
+
+  int rc = 0;
+  ThreadPolicy* passes[] = {nullptr, &policy};
+  for (ThreadPolicy* p : passes) {
+    std::vector<int> lateUs;
+    if (!runJitterPass(path, seconds, p, lateUs)) {
+      rc = 1;
+      break;
+    }
+    const int n = int(lateUs.size());
+    const int over = int(std::count_if(lateUs.begin(), lateUs.end(), [](int us) { return us > 20000; }));
+    const int maxUs = *std::max_element(lateUs.begin(), lateUs.end());
+    std::vector<int> tmp = lateUs;
+    const int q50 = percentile(tmp, 50.0);
+    tmp = lateUs;
+    const int q95 = percentile(tmp, 95.0);
+    qInfo().noquote() << QString("[JITTER] %1: frames=%2 lateness-ms q50=%3 q95=%4 max=%5 late>20ms=%6")
+                           .arg(p ? QString::fromStdString(p->describe()) : QString("default"))
+                           .arg(n).arg(q50 / 1000.0, 0, 'f', 2).arg(q95 / 1000.0, 0, 'f', 2)
+                           .arg(maxUs / 1000.0, 0, 'f', 2).arg(over);
+  }
+  const ThreadPolicyStats& st = policy.stats();
+  qInfo().noquote() << QString("[JITTER] policy threads=%1 pinned=%2 affinity-failed=%3 nice-failed=%4 fifo-denied=%5")
+                         .arg(st.threads.load()).arg(st.pinned.load()).arg(st.affinityFailed.load())
+                         .arg(st.niceFailed.load()).arg(st.fifoDenied.load());
+  stopLoad = true;
+  for (std::thread& t : load) t.join();
+  return rc;
+}
+
+// Aggregate throughput of N concurrent streams in one process, with every
+// decoder/converter at its own default thread count ("uncapped") and with
+// the process-wide DecodeScheduler splitting the cores between pipelines.
+// Streams run unsynced; per-stream frame intervals feed the q95.
+struct MultiStream {
+  GstElement* pipe{nullptr};
+  GstBus*     bus{nullptr};
+  quint64     frames{0};
+  gint64      lastUs{0};
+  std::vector<int> intervalsUs;
+  bool        done{false};
+};
+
+static GstPadProbeReturn onMultiBuffer(GstPad*, GstPadProbeInfo*, gpointer userData) {
+  auto* st = static_cast<MultiStream*>(userData);
+  const gint64 now = g_get_monotonic_time();
+  if (st->lastUs) st->intervalsUs.push_back(int(now - st->lastUs));
+  st->lastUs = now;
+  st->frames++;
+  return GST_PAD_PROBE_OK;
+}
+
+static bool runMultiPass(const QString& path, int streams, bool shared, int seconds) {
+  DecodeScheduler& sched = DecodeScheduler::instance();
+  sched.setTotalThreads(shared ? std::max(1u, std::thread::hardware_concurrency()) : 0);
+  // The scheduler's counter is process-wide; report only this pass's elements
+  const uint64_t capped0 = sched.elementsCapped();
+  std::vector<std::unique_ptr<MultiStream>> all;
+  for (int i = 0; i < streams; ++i) {
+    GError* err = nullptr;
+    GstElement* pipe = gst_parse_launch(
+      "filesrc name=src ! decodebin ! videoconvert ! fakesink name=sink sync=false", &err);
+    if (!pipe) {
+      qCritical() << "[MULTI] Failed to build pipeline:" << (err ? err->message : "unknown");
+      if (err) g_error_free(err);
+      break;
+    }
+    auto st = std::make_unique<MultiStream>();
+    st->pipe = pipe;
+    st->bus = gst_element_get_bus(pipe);
+    // Attach before PLAYING so decodebin's decoders are capped as they appear
+    sched.attach(pipe);
+    GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+    g_object_set(src, "location", path.toUtf8().constData(), NULL);
+    GstPad* pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &onMultiBuffer, st.get(), nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(sink);
+    gst_object_unref(src);
+    all.push_back(std::move(st));
+  }
+  const bool built = int(all.size()) == streams;
+  QElapsedTimer wall;
+  wall.start();
+  const qint64 cpu0 = processCpuMs();
+  int peakThreads = 0;
+  bool failed = !built;
+  if (built) {
+    for (auto& st : all) gst_element_set_state(st->pipe, GST_STATE_PLAYING);
+    int running = streams;
+    while (running > 0 && wall.elapsed() < qint64(seconds) * 1000) {
+      g_usleep(100000);
+      peakThreads = std::max(peakThreads, processThreadCount());
+      for (auto& st : all) {
+        if (st->done) continue;
+        while (GstMessage* msg = gst_bus_pop_filtered(st->bus, (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) {
+          if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) failed = true;
+          if (!st->done) running--;
+          st->done = true;
+          gst_message_unref(msg);
+        }
+      }
+    }
+  }
+  const qint64 wallMs = std::max<qint64>(1, wall.elapsed());
+  const qint64 cpuMs = processCpuMs() - cpu0;
+  // Stop every pipeline before reading the per-stream counters
+  for (auto& st : all) gst_element_set_state(st->pipe, GST_STATE_NULL);
+
+  quint64 frames = 0;
+  double minFps = -1.0;
+  std::vector<int> intervals;
+  for (auto& st : all) {
+    frames += st->frames;
+    const double fps = st->frames * 1000.0 / wallMs;
+    minFps = minFps < 0 ? fps : std::min(minFps, fps);
+    intervals.insert(intervals.end(), st->intervalsUs.begin(), st->intervalsUs.end());
+  }
+  const int q95 = percentile(intervals, 95.0);
+  if (built) {
+    qInfo().noquote() << QString("[MULTI] streams=%1 %2: aggregate-fps=%3 min-stream-fps=%4 interval-q95-ms=%5 "
+                                 "cpu=%6% peak-threads=%7 capped-elements=%8")
+                           .arg(streams).arg(shared ? "shared" : "uncapped")
+                           .arg(frames * 1000.0 / wallMs, 0, 'f', 1).arg(std::max(0.0, minFps), 0, 'f', 1)
+                           .arg(q95 / 1000.0, 0, 'f', 2).arg(100.0 * double(cpuMs) / wallMs, 0, 'f', 0)
+                           .arg(peakThreads).arg(sched.elementsCapped() - capped0);
+  }
+  for (auto& st : all) {
+    sched.detach(st->pipe);
+    gst_object_unref(st->bus);
+    gst_object_unref(st->pipe);
+  }
+  return !failed;
+}
+
+static int runMultiStreamBenchmark(const QString& path, int seconds) {
+  gst_init(nullptr, nullptr);
+  qInfo().noquote() << QString("[MULTI] %1 cores, %2 s per pass").arg(std::thread::hardware_concurrency()).arg(seconds);
+  for (int streams : {4, 8, 16}) {
+    for (bool shared : {false, true}) {
+      if (!runMultiPass(path, streams, shared, seconds)) return 1;
+    }
+  }
+  return 0;
+}
+
+// Decoding cost of process isolation: the same file decoded unsynced to
+// I420 in-process, then by a decode worker into the shared frame ring
+// drained by this process. CPU counts both processes; transit is worker
+// commit → consumer wake-up.
+static GstPadProbeReturn onIsolateCount(GstPad*, GstPadProbeInfo*, gpointer userData) {
+  static_cast<std::atomic<quint64>*>(userData)->fetch_add(1, std::memory_order_relaxed);
+  return GST_PAD_PROBE_OK;
+}
+
+static int runIsolateBenchmark(const QString& path, int seconds) {
+  gst_init(nullptr, nullptr);
+  const qint64 limitMs = qint64(seconds) * 1000;
+
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin ! videoconvert ! video/x-raw,format=I420 ! fakesink name=sink sync=false", &err);
+  if (!pipe) {
+    qCritical() << "[ISOLATE] Failed to build pipeline:" << (err ? err->message : "unknown");
+    if (err) g_error_free(err);
+    return 1;
+  }
+  std::atomic<quint64> inFrames{0};
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  g_object_set(src, "location", path.toUtf8().constData(), NULL);
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &onIsolateCount, &inFrames, nullptr);
+  gst_object_unref(pad);
+  gst_object_unref(sink);
+  gst_object_unref(src);
+  GstBus* bus = gst_element_get_bus(pipe);
+  QElapsedTimer wall;
+  wall.start();
+  qint64 cpu0 = processCpuMs();
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  GstMessage* msg = gst_bus_timed_pop_filtered(bus, GstClockTime(limitMs) * GST_MSECOND,
+                                               (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  const qint64 inWallMs = std::max<qint64>(1, wall.elapsed());
+  const qint64 inCpuMs = processCpuMs() - cpu0;
+  if (msg) gst_message_unref(msg);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+
+  DecodeWorker worker;
+  if (!worker.start(QCoreApplication::applicationFilePath().toStdString(), path.toStdString(), 0,
+                    6, 3840 * 2160 * 3 / 2)) {
+    qCritical() << "[ISOLATE] Cannot start decode worker";
+    return 1;
+  }
+  std::shared_ptr<SharedFrameRing> ring = worker.ring();
+  std::vector<int> transitUs;
+  quint64 outFrames = 0;
+  wall.restart();
+  cpu0 = processCpuMs();
+  while (wall.elapsed() < limitMs) {
+    SharedFrameRing::Frame frame;
+    const int slot = ring->beginRead(frame, 100);
+    if (slot < 0) {
+      if (!worker.alive() || ring->state() == SharedFrameRing::Failed ||
+          (ring->state() == SharedFrameRing::Eos && !ring->queued())) {
+        break;
+      }
+      continue;
+    }
+    transitUs.push_back(int((monotonicNs() - frame.producedNs) / 1000));
+    outFrames++;
+    ring->release(slot);
+  }
+  const qint64 outWallMs = std::max<qint64>(1, wall.elapsed());
+  const qint64 outCpuMs = processCpuMs() - cpu0;
+  const double workerCpuMs = worker.cpuMs();
+  const std::string exitReason = worker.alive() ? std::string() : worker.exitReason();
+  worker.stop();
+  if (!outFrames) {
+    qCritical().noquote() << "[ISOLATE] decode worker produced no frames" << QString::fromStdString(exitReason);
+    return 1;
+  }
+
+  std::vector<int> tmp = transitUs;
+  const int q50 = percentile(tmp, 50.0);
+  tmp = transitUs;
+  const int q95 = percentile(tmp, 95.0);
+  const int maxUs = *std::max_element(transitUs.begin(), transitUs.end());
+  qInfo().noquote() << QString("[ISOLATE] in-process: fps=%1 cpu-ms-per-frame=%2")
+                         .arg(inFrames * 1000.0 / inWallMs, 0, 'f', 1)
+                         .arg(inFrames ? double(inCpuMs) / inFrames : 0.0, 0, 'f', 2);
+  qInfo().noquote() << QString("[ISOLATE] isolated:   fps=%1 cpu-ms-per-frame=%2 (player %3 + worker %4) "
+                               "transit-ms q50=%5 q95=%6 max=%7")
+                         .arg(outFrames * 1000.0 / outWallMs, 0, 'f', 1)
+                         .arg((outCpuMs + workerCpuMs) / outFrames, 0, 'f', 2)
+                         .arg(double(outCpuMs) / outFrames, 0, 'f', 2).arg(workerCpuMs / outFrames, 0, 'f', 2)
+                         .arg(q50 / 1000.0, 0, 'f', 3).arg(q95 / 1000.0, 0, 'f', 3).arg(maxUs / 1000.0, 0, 'f', 3);
+  return 0;
+}
+
+// Frame-memory cost at 4K: decode → videoscale → capsfilter → videoconvert
+// → fakesink, unsynced, with the output size flipped between 2160p and
+// 1080p every 2 s so every pool is renegotiated. Run once with system
+// memory and once with the hugepage allocator offered on both sides of
+// videoconvert; page faults and conversion time are compared.
+struct ConvertTiming {
+  gint64 startUs{0};
+  std::vector<int> us;
+};
+
+static GstPadProbeReturn onBenchConvertIn(GstPad*, GstPadProbeInfo*, gpointer userData) {
+  static_cast<ConvertTiming*>(userData)->startUs = g_get_monotonic_time();
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn onBenchConvertOut(GstPad*, GstPadProbeInfo*, gpointer userData) {
+  auto* t = static_cast<ConvertTiming*>(userData);
+  if (t->startUs) t->us.push_back(int(g_get_monotonic_time() - t->startUs));
+  t->startUs = 0;
+  return GST_PAD_PROBE_OK;
+}
+
+static bool runHugePagePass(const QString& path, int seconds, GstAllocator* allocator, const char* label) {
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin ! videoscale ! capsfilter name=size ! videoconvert name=conv ! "
+    "video/x-raw,format=BGRx ! fakesink name=sink sync=false", &err);
+  if (!pipe) {
+    qCritical() << "[MEMORY] Failed to build pipeline:" << (err ? err->message : "unknown");
+    if (err) g_error_free(err);
+    return false;
+  }
+  ConvertTiming timing;
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* size = gst_bin_get_by_name(GST_BIN(pipe), "size");
+  GstElement* conv = gst_bin_get_by_name(GST_BIN(pipe), "conv");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  g_object_set(src, "location", path.toUtf8().constData(), NULL);
+  GstPad* in = gst_element_get_static_pad(conv, "sink");
+  GstPad* out = gst_element_get_static_pad(conv, "src");
+  GstPad* sinkPad = gst_element_get_static_pad(sink, "sink");
+  gst_pad_add_probe(in, GST_PAD_PROBE_TYPE_BUFFER, &onBenchConvertIn, &timing, nullptr);
+  gst_pad_add_probe(out, GST_PAD_PROBE_TYPE_BUFFER, &onBenchConvertOut, &timing, nullptr);
+  if (allocator) {
+    installAllocation(in, allocator, false);
+    installAllocation(sinkPad, allocator, true);
+  }
+  const char* sizes[] = {"video/x-raw,width=3840,height=2160", "video/x-raw,width=1920,height=1080"};
+  GstCaps* caps = gst_caps_from_string(sizes[0]);
+  g_object_set(size, "caps", caps, NULL);
+  gst_caps_unref(caps);
+
+  GstBus* bus = gst_element_get_bus(pipe);
+  qint64 minor0 = 0, major0 = 0;
+  processPageFaults(minor0, major0);
+  QElapsedTimer wall;
+  wall.start();
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  bool ok = true;
+  int switches = 0;
+  while (wall.elapsed() < qint64(seconds) * 1000) {
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, 2 * GST_SECOND,
+                                                 (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    if (msg) {
+      ok = GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+      gst_message_unref(msg);
+      break;
+    }
+    caps = gst_caps_from_string(sizes[++switches % 2]);
+    g_object_set(size, "caps", caps, NULL);
+    gst_caps_unref(caps);
+  }
+  const qint64 wallMs = std::max<qint64>(1, wall.elapsed());
+  qint64 minor = 0, major = 0;
+  processPageFaults(minor, major);
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(sinkPad);
+  gst_object_unref(out);
+  gst_object_unref(in);
+  gst_object_unref(sink);
+  gst_object_unref(conv);
+  gst_object_unref(size);
+  gst_object_unref(src);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+
+  double avg = 0.0;
+  for (int us : timing.us) avg += us;
+  avg = timing.us.empty() ? 0.0 : avg / timing.us.size();
+  const size_t frames = timing.us.size();
+  const int q95 = percentile(timing.us, 95.0);
+  qInfo().noquote() << QString("[MEMORY] %1: frames=%2 size-switches=%3 convert-ms avg=%4 q95=%5 "
+                               "minor-faults=%6 (%7/frame) major=%8")
+                         .arg(label).arg(frames).arg(switches)
+                         .arg(avg / 1000.0, 0, 'f', 2).arg(q95 / 1000.0, 0, 'f', 2)
+                         .arg(minor - minor0).arg(frames ? double(minor - minor0) / frames : 0.0, 0, 'f', 1)
+                         .arg(major - major0);
+  return ok;
+}
+
+static int runHugePageBenchmark(const QString& path, int seconds) {
+  gst_init(nullptr, nullptr);
+  GstAllocator* allocator = hugePageAllocatorNew();
+  if (!allocator) {
+    qCritical() << "[MEMORY] hugepage allocator is not supported on this platform";
+    return 1;
+  }
+  bool ok = runHugePagePass(path, seconds, nullptr, "system") &&
+            runHugePagePass(path, seconds, allocator, "hugepage");
+  const HugePageStats& st = hugePageStats();
+  qInfo().noquote() << QString("[MEMORY] hugepage allocations=%1 hugetlb=%2 thp=%3 prefault=%4 ms")
+                         .arg(st.allocations.load()).arg(st.hugetlb.load()).arg(st.transparent.load())
+                         .arg(st.prefaultNs.load() / 1e6, 0, 'f', 1);
+  gst_object_unref(allocator);
+  // Third pass: system memory kept across the switches by rendition pools
+  if (ok) {
+    RenditionPools pools;
+    pools.init(nullptr, 4, 0);
+    ok = runHugePagePass(path, seconds, pools.allocator(), "recycled");
+    const RecycleStats& rs = pools.stats();
+    qInfo().noquote() << QString("[POOLS] requests=%1 reused=%2 fresh=%3 dropped=%4")
+                           .arg(rs.requests.load()).arg(rs.hits.load()).arg(rs.misses.load())
+                           .arg(rs.dropped.load());
+  }
+  return ok ? 0 : 1;
+}
+
+// Modes that never open a window; they run under QCoreApplication
+static bool isHeadlessInvocation(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--resample-bench") == 0 ||
+        std::strcmp(argv[i], "--loudness-report") == 0 ||
+        std::strcmp(argv[i], "--jitter-bench") == 0 ||
+        std::strcmp(argv[i], "--multi-bench") == 0 ||
+        std::strcmp(argv[i], "--isolate-bench") == 0 ||
+        std::strcmp(argv[i], "--hugepage-bench") == 0 ||
+        std::strcmp(argv[i], "--decode-worker") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 int main(int argc, char** argv) {
-  QApplication app(argc, argv);
+  std::unique_ptr<QCoreApplication> appHolder(
+    isHeadlessInvocation(argc, argv) ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+  QCoreApplication& app = *appHolder;
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Qt + GStreamer PoC player");
+  parser.addHelpOption();
+  parser.addPositionalArgument("file", "Absolute path of the media file to play (or a URI with --timeshift)");
+  const QCommandLineOption audioOnlyOpt("audio-only", "Audio-only playback: video is demuxed and discarded, never decoded");
+  parser.addOption(audioOnlyOpt);
+  const QCommandLineOption passthroughOpt("audio-passthrough", "Send compressed audio straight to the sink when it accepts the format");
+  parser.addOption(passthroughOpt);
+  const QCommandLineOption audioSinkOpt("audio-sink", "Audio sink factory (e.g. fakesink for benchmarks)", "factory", "autoaudiosink");
+  parser.addOption(audioSinkOpt);
+  const QCommandLineOption resampleProfileOpt("resample-profile", "audioresample profile: low-cpu, low-latency, default, high-quality", "profile", "default");
+  parser.addOption(resampleProfileOpt);
+  const QCommandLineOption resampleBenchOpt("resample-bench", "Headless: benchmark resampling CPU per channel for every profile and exit");
+  parser.addOption(resampleBenchOpt);
+  const QCommandLineOption loudnessReportOpt("loudness-report", "Headless: print peak/RMS and EBU R128 loudness of <file> and exit");
+  parser.addOption(loudnessReportOpt);
+  const QCommandLineOption timeshiftOpt("timeshift", "Record a live byte-stream URI (udp://, tcp://, http://...) into a ring of <MB> and play from it; pause/seek stay inside the window (ignored for local files, refused for RTSP/RTP)", "MB");
+  parser.addOption(timeshiftOpt);
+  const QCommandLineOption timeshiftFileOpt("timeshift-file", "Memory-mapped file backing the timeshift ring (default: anonymous memory)", "path");
+  parser.addOption(timeshiftFileOpt);
+  const QCommandLineOption frameCacheOpt("frame-cache", "Decoded-frame cache budget for stepping / A-B loops; every decoded frame is copied while it is on (default 0 = off, e.g. 256)", "MB");
+  parser.addOption(frameCacheOpt);
+  const QCommandLineOption reverseWorkersOpt("reverse-workers", "Parallel GOP decoders for reverse playback (default: half the cores, max 4)", "N");
+  parser.addOption(reverseWorkersOpt);
+  const QCommandLineOption loopOpt("loop", "Loop the clip seamlessly (segment seeks, no flush at the boundary)");
+  parser.addOption(loopOpt);
+  const QCommandLineOption noRecoverOpt("no-recover", "Stop at the first pipeline error instead of rebuilding and resuming");
+  parser.addOption(noRecoverOpt);
+  const QCommandLineOption stallFramesOpt("stall-frames", "Stall watchdog threshold in frame durations without a buffer at the sink (default 15, 0 disables)", "N");
+  parser.addOption(stallFramesOpt);
+  const QCommandLineOption stallRecoverOpt("stall-recover", "Let the stall watchdog trigger error recovery after its diagnostics dump");
+  parser.addOption(stallRecoverOpt);
+  const QCommandLineOption threadPolicyOpt("thread-policy", "Streaming-thread pools: \"role:cpus@prio;...\" with role demux|decode|vrender|arender, prio niceN|fifoN (\"names\" only names threads)", "spec");
+  parser.addOption(threadPolicyOpt);
+  const QCommandLineOption jitterBenchOpt("jitter-bench", "Headless: render lateness of <file> under full CPU load, default scheduling vs --thread-policy (or a built-in pinning), and exit");
+  parser.addOption(jitterBenchOpt);
+  const QCommandLineOption instancesOpt("instances", "Open N players on the same media in this process (default 1)", "N");
+  parser.addOption(instancesOpt);
+  const QCommandLineOption decodeThreadsOpt("decode-threads", "Process-wide cap on decoder/converter threads shared between players (default: core count with --instances > 1, else uncapped)", "N");
+  parser.addOption(decodeThreadsOpt);
+  const QCommandLineOption multiBenchOpt("multi-bench", "Headless: aggregate fps and frame-interval q95 of <file> at 4/8/16 concurrent streams, uncapped vs shared decode threads, and exit");
+  parser.addOption(multiBenchOpt);
+  const QCommandLineOption isolatedOpt("isolated-decode", "Decode video in a child process and present it from a shared-memory frame ring (video only)");
+  parser.addOption(isolatedOpt);
+  const QCommandLineOption isolateBenchOpt("isolate-bench", "Headless: decode <file> in-process and through a decode worker, compare fps, CPU and ring transit latency, and exit");
+  parser.addOption(isolateBenchOpt);
+  const QCommandLineOption hugePagesOpt("hugepages", "Back the video branch's frame pools with 2 MB pages (hugetlb or THP), pre-faulted at allocation");
+  parser.addOption(hugePagesOpt);
+  const QCommandLineOption hugePageBenchOpt("hugepage-bench", "Headless: page faults and videoconvert time of <file> at 2160p/1080p switches, system vs hugepage memory, and exit");
+  parser.addOption(hugePageBenchOpt);
+  const QCommandLineOption renditionFramesOpt("rendition-frames", "Frames of memory kept per rendition size across quality switches, pre-sized at first caps (0 = off)", "n", "4");
+  parser.addOption(renditionFramesOpt);
+  const QCommandLineOption renditionCacheOpt("rendition-cache", "Cap on frame memory kept across all rendition sizes; least recently used sizes go first (default 64)", "MB", "64");
+  parser.addOption(renditionCacheOpt);
+  const QCommandLineOption memoryBudgetOpt("memory-budget", "Per-player memory budget: sizes queues, decoder threads, frame cache and rendition pools to fit, and lowers the output resolution while resident memory stays above it", "MB");
+  parser.addOption(memoryBudgetOpt);
+  const QCommandLineOption allocTraceOpt("alloc-trace", "Count buffer/memory allocations, pool hits/misses and fresh bytes per element (GStreamer tracing hooks) in the session metrics");
+  parser.addOption(allocTraceOpt);
+  const QCommandLineOption controlSocketOpt("control-socket", "JSON-RPC 2.0 control socket (play, pause, seek, rate, quality, open, metrics), one request per line; with --instances N, player i listens on <path>.<i>", "path");
+  parser.addOption(controlSocketOpt);
+  const QCommandLineOption scenarioOpt("scenario", "Replay a scenario file (timed play/pause/seek/quality/rate/open actions), record per-action latency and exit", "file");
+  parser.addOption(scenarioOpt);
+  const QCommandLineOption scenarioOutOpt("scenario-out", "Scenario results, one JSON object per action plus a summary (default <scenario>.results.jsonl; .<i> per instance)", "file");
+  parser.addOption(scenarioOutOpt);
+  const QCommandLineOption soakOpt("soak", "Soak test: loop the clip and sample RSS, fds, threads, frame-interval q95 and A/V drift into a CSV time series, flagging steady growth (.<i> per instance)", "file");
+  parser.addOption(soakOpt);
+  const QCommandLineOption soakHoursOpt("soak-hours", "End the soak after this many hours and exit non-zero if anything was flagged (default: run until closed)", "hours");
+  parser.addOption(soakHoursOpt);
+  const QCommandLineOption soakIntervalOpt("soak-interval", "Seconds between soak samples (default 60)", "s", "60");
+  parser.addOption(soakIntervalOpt);
+  // Internal: the child side of --isolated-decode
+  QCommandLineOption decodeWorkerOpt("decode-worker");
+  decodeWorkerOpt.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOption(decodeWorkerOpt);
+  QCommandLineOption workerFdOpt("worker-fd", "", "fd");
+  workerFdOpt.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOption(workerFdOpt);
+  QCommandLineOption workerStartOpt("worker-start", "", "ns");
+  workerStartOpt.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOption(workerStartOpt);
+  parser.process(app);
+
+  if (parser.isSet(resampleBenchOpt)) {
+    return runResampleBenchmark(10);
+  }
 
-  if (argc < 2) {
-    qCritical() << "Usage: gst_qt_poc <absolute-file-path>";
+  const QStringList positional = parser.positionalArguments();
+  if (positional.isEmpty()) {
+    qCritical() << "Usage: gst_qt_poc [options] <absolute-file-path>";
     return 1;
   }
+  if (parser.isSet(loudnessReportOpt)) {
+    return runLoudnessReport(positional.first());
+  }
+  if (parser.isSet(jitterBenchOpt)) {
+    return runJitterBenchmark(positional.first(), parser.value(threadPolicyOpt), 20);
+  }
+  if (parser.isSet(multiBenchOpt)) {
+    return runMultiStreamBenchmark(positional.first(), 10);
+  }
+  if (parser.isSet(decodeWorkerOpt)) {
+    return runDecodeWorkerProcess(parser.value(workerFdOpt).toInt(), positional.first().toStdString(),
+                                  parser.value(workerStartOpt).toLongLong());
+  }
+  if (parser.isSet(isolateBenchOpt)) {
+    return runIsolateBenchmark(positional.first(), 10);
+  }
+  if (parser.isSet(hugePageBenchOpt)) {
+    return runHugePageBenchmark(positional.first(), 10);
+  }
+
+  PlayerOptions opts;
+  opts.audioOnly = parser.isSet(audioOnlyOpt);
+  opts.audioPassthrough = parser.isSet(passthroughOpt);
+  opts.audioSink = parser.value(audioSinkOpt);
+  opts.resampleProfile = parser.value(resampleProfileOpt);
+  if (parser.isSet(timeshiftOpt)) {
+    bool ok = false;
+    const qint64 mb = parser.value(timeshiftOpt).toLongLong(&ok);
+    if (ok && mb > 0) {
+      opts.timeshiftBytes = mb * 1024 * 1024;
+    } else {
+      qWarning() << "[TIMESHIFT] ignoring --timeshift: invalid ring size" << parser.value(timeshiftOpt);
+    }
+  }
+  opts.timeshiftFile = parser.value(timeshiftFileOpt);
+  opts.reverseWorkers = parser.value(reverseWorkersOpt).toUInt();
+  opts.loopClip = parser.isSet(loopOpt) || parser.isSet(soakOpt);
+  opts.recover = !parser.isSet(noRecoverOpt);
+  if (parser.isSet(stallFramesOpt)) {
+    opts.stallFrames = parser.value(stallFramesOpt).toInt();
+  }
+  opts.stallRecover = parser.isSet(stallRecoverOpt);
+  opts.threadPolicy = parser.value(threadPolicyOpt);
+  opts.isolatedDecode = parser.isSet(isolatedOpt);
+  opts.hugePages = parser.isSet(hugePagesOpt);
+  opts.renditionFrames = parser.value(renditionFramesOpt).toUInt();
+  opts.renditionCacheBytes = parser.value(renditionCacheOpt).toLongLong() * 1024 * 1024;
+  opts.memoryBudgetBytes = parser.value(memoryBudgetOpt).toLongLong() * 1024 * 1024;
+  opts.allocTrace = parser.isSet(allocTraceOpt);
+  opts.controlSocket = parser.value(controlSocketOpt);
+  if (parser.isSet(scenarioOpt)) {
+    QFile file(parser.value(scenarioOpt));
+    std::string error;
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+      qCritical() << "[SCENARIO] cannot read" << file.fileName();
+      return 2;
+    }
+    if (!parseScenario(file.readAll().toStdString(), opts.scenario, error)) {
+      qCritical().noquote() << "[SCENARIO]" << file.fileName() << QString::fromStdString(error);
+      return 2;
+    }
+    opts.scenarioOut = parser.isSet(scenarioOutOpt) ? parser.value(scenarioOutOpt)
+                                                    : file.fileName() + ".results.jsonl";
+  }
+  opts.soakFile = parser.value(soakOpt);
+  opts.soakHours = parser.value(soakHoursOpt).toDouble();
+  opts.soakIntervalS = parser.value(soakIntervalOpt).toInt();
+  if (parser.isSet(frameCacheOpt)) {
+    opts.frameCacheBytes = parser.value(frameCacheOpt).toLongLong() * 1024 * 1024;
+  }
 
-  const QString originalPath = QString::fromLocal8Bit(argv[1]);
+  const QString originalPath = positional.first();
   if (originalPath.isEmpty()) {
     qCritical() << "Invalid path.";
     return 1;
@@ -726,7 +4802,27 @@ int main(int argc, char** argv) {
     qInfo() << "[MAIN] No companion keys file found near media; skipping /tmp/<KID>.key provisioning";
   }
 
-  GstQtPlayer w(originalPath);
-  w.show();
+  const int instances = std::max(1, parser.value(instancesOpt).toInt());
+  if (parser.isSet(decodeThreadsOpt)) {
+    DecodeScheduler::instance().setTotalThreads(parser.value(decodeThreadsOpt).toUInt());
+  } else if (instances > 1) {
+    DecodeScheduler::instance().setTotalThreads(std::max(1u, std::thread::hardware_concurrency()));
+  }
+  std::vector<std::unique_ptr<GstQtPlayer>> players;
+  for (int i = 0; i < instances; ++i) {
+    PlayerOptions instanceOpts = opts;
+    if (instances > 1 && !opts.controlSocket.isEmpty()) {
+      instanceOpts.controlSocket = QString("%1.%2").arg(opts.controlSocket).arg(i + 1);
+    }
+    if (instances > 1 && !opts.scenario.empty()) {
+      instanceOpts.scenarioOut = QString("%1.%2").arg(opts.scenarioOut).arg(i + 1);
+    }
+    if (instances > 1 && !opts.soakFile.isEmpty()) {
+      instanceOpts.soakFile = QString("%1.%2").arg(opts.soakFile).arg(i + 1);
+    }
+    players.push_back(std::make_unique<GstQtPlayer>(originalPath, instanceOpts));
+    if (instances > 1) players.back()->setWindowTitle(players.back()->windowTitle() + QString(" #%1").arg(i + 1));
+    players.back()->show();
+  }
   return app.exec();
 }
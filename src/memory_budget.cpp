@@ -0,0 +1,68 @@
+// File: src/memory_budget.cpp
+#include "memory_budget.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t kMB = 1024 * 1024;
+constexpr int kMaxHeights[MemoryBudget::kLevels] = {0, 1080, 720, 480, 360};
+
+// Consecutive 1 s samples before stepping down / up, and the settle time
+// after a change (pools are rebuilt and freed memory returned meanwhile)
+constexpr int kOverSamples = 3;
+constexpr int kUnderSamples = 30;
+constexpr int kHoldOffSamples = 5;
+// Step back up only while usage stays below this share of the budget
+constexpr double kRestoreRatio = 0.7;
+
+}  // namespace
+
+bool MemoryBudget::configure(uint64_t budgetBytes, size_t frameCacheBytes, unsigned renditionFrames, unsigned cores) {
+  budget_ = budgetBytes;
+  plan_ = BudgetPlan();
+  level_ = 0;
+  overStreak_ = underStreak_ = holdOff_ = 0;
+  if (!budget_) return false;
+  // Compressed data is small: a few MB of demuxed stream covers seconds
+  plan_.demuxQueueBytes = std::clamp<uint64_t>(budget_ / 32, 2 * kMB, 32 * kMB);
+  // Raw frames: room for a handful of 1080p frames in a 256 MB budget
+  plan_.videoQueueBytes = std::clamp<uint64_t>(budget_ / 16, 4 * kMB, 64 * kMB);
+  plan_.audioQueueBytes = std::clamp<uint64_t>(budget_ / 128, 1 * kMB, 8 * kMB);
+  plan_.frameCacheBytes = std::min<size_t>(frameCacheBytes, size_t(budget_ / 4));
+  plan_.renditionFrames = budget_ < 256 * kMB ? 0 : std::min(renditionFrames, budget_ < 512 * kMB ? 2u : renditionFrames);
+  // Every frame thread keeps a frame (and its context) in flight
+  plan_.decoderThreads = unsigned(std::clamp<uint64_t>(budget_ / (64 * kMB), 1, std::max(1u, cores)));
+  return true;
+}
+
+int MemoryBudget::maxHeight() const {
+  return kMaxHeights[level_];
+}
+
+bool MemoryBudget::sample(uint64_t usedBytes) {
+  if (!budget_) return false;
+  samples_++;
+  last_ = usedBytes;
+  peak_ = std::max(peak_, usedBytes);
+  const bool over = usedBytes > budget_;
+  if (over) over_++;
+  overStreak_ = over ? overStreak_ + 1 : 0;
+  underStreak_ = usedBytes < uint64_t(budget_ * kRestoreRatio) ? underStreak_ + 1 : 0;
+  if (holdOff_ > 0) {
+    holdOff_--;
+    return false;
+  }
+  if (overStreak_ >= kOverSamples && level_ + 1 < kLevels) {
+    level_++;
+    degradations_++;
+  } else if (underStreak_ >= kUnderSamples && level_ > 0) {
+    level_--;
+    restorations_++;
+  } else {
+    return false;
+  }
+  overStreak_ = underStreak_ = 0;
+  holdOff_ = kHoldOffSamples;
+  return true;
+}
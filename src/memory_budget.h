@@ -0,0 +1,61 @@
+// File: src/memory_budget.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// How a player's memory budget is split between the buffers it controls.
+// Whatever is not handed out here is left for decoder reference frames,
+// sink pools and the player's share of the process baseline.
+struct BudgetPlan {
+  uint64_t demuxQueueBytes{0};   // decodebin's multiqueue (max-size-bytes)
+  uint64_t videoQueueBytes{0};   // raw frames between decodebin and videoscale
+  uint64_t audioQueueBytes{0};
+  size_t   frameCacheBytes{0};   // decoded-frame cache at full quality
+  unsigned renditionFrames{0};   // frame memory kept per rendition size
+  unsigned decoderThreads{0};    // per-pipeline cap on decoder/converter threads
+};
+
+// Per-player memory budget. configure() sizes the buffers to fit; sample()
+// is fed the player's resident memory about once a second and walks a
+// degradation ladder (max output height) when usage stays above the budget,
+// stepping back up once it has stayed well below it for a while.
+class MemoryBudget {
+public:
+  static constexpr int kLevels = 5;   // native, 1080p, 720p, 480p, 360p
+
+  // frameCacheBytes / renditionFrames are what the player would use without
+  // a budget; the plan never exceeds them. Returns false for budget 0.
+  bool configure(uint64_t budgetBytes, size_t frameCacheBytes, unsigned renditionFrames, unsigned cores);
+  bool active() const { return budget_ > 0; }
+  uint64_t budget() const { return budget_; }
+  const BudgetPlan& plan() const { return plan_; }
+
+  // True when the level changed with this sample
+  bool sample(uint64_t usedBytes);
+  int level() const { return level_; }
+  int maxHeight() const;   // 0 = not capped
+  // Frame cache for the current level (halved per step down)
+  size_t frameCacheBytes() const { return plan_.frameCacheBytes >> level_; }
+
+  uint64_t lastBytes() const { return last_; }
+  uint64_t peakBytes() const { return peak_; }
+  uint64_t samples() const { return samples_; }
+  uint64_t overSamples() const { return over_; }
+  uint64_t degradations() const { return degradations_; }
+  uint64_t restorations() const { return restorations_; }
+
+private:
+  uint64_t   budget_{0};
+  BudgetPlan plan_;
+  int      level_{0};
+  int      overStreak_{0};
+  int      underStreak_{0};
+  int      holdOff_{0};     // samples to wait after a change before judging again
+  uint64_t last_{0};
+  uint64_t peak_{0};
+  uint64_t samples_{0};
+  uint64_t over_{0};
+  uint64_t degradations_{0};
+  uint64_t restorations_{0};
+};
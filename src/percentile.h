@@ -0,0 +1,16 @@
+// File: src/percentile.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Nearest-rank percentile (p in 0..100); reorders v. 0 when v is empty.
+template <typename T>
+T percentile(std::vector<T>& v, double p) {
+  if (v.empty()) return T(0);
+  const size_t idx = static_cast<size_t>(std::floor((p / 100.0) * double(v.size() - 1)));
+  std::nth_element(v.begin(), v.begin() + idx, v.end());
+  return v[idx];
+}
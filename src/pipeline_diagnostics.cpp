@@ -0,0 +1,143 @@
+// File: src/pipeline_diagnostics.cpp
+#include "pipeline_diagnostics.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__linux__)
+#include <dirent.h>
+#endif
+
+namespace {
+
+std::string format(const char* fmt, ...) G_GNUC_PRINTF(1, 2);
+std::string format(const char* fmt, ...) {
+  char line[512];
+  va_list args;
+  va_start(args, fmt);
+  std::vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  return line;
+}
+
+bool hasProperty(gpointer obj, const char* name) {
+  return g_object_class_find_property(G_OBJECT_GET_CLASS(obj), name) != nullptr;
+}
+
+// queue / queue2 expose levels on the element, multiqueue on its pads
+void appendLevels(gpointer obj, const std::string& label, std::vector<std::string>& out) {
+  if (!hasProperty(obj, "current-level-time")) return;
+  guint buffers = 0, bytes = 0;
+  guint64 time = 0;
+  g_object_get(obj, "current-level-buffers", &buffers, "current-level-bytes", &bytes,
+               "current-level-time", &time, NULL);
+  std::string line = format("queue %s: %u buffers, %u bytes, %.1f ms", label.c_str(), buffers, bytes,
+                            double(time) / GST_MSECOND);
+  if (hasProperty(obj, "max-size-time")) {
+    guint64 maxTime = 0;
+    g_object_get(obj, "max-size-time", &maxTime, NULL);
+    if (maxTime) line += format(" (max %.0f ms)", double(maxTime) / GST_MSECOND);
+  }
+  out.push_back(line);
+}
+
+void appendElement(GstElement* element, GstState pipelineState, std::vector<std::string>& out) {
+  gchar* name = gst_object_get_name(GST_OBJECT(element));
+  GstElementFactory* factory = gst_element_get_factory(element);
+  const char* factoryName = factory ? gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)) : "?";
+  GstState cur = GST_STATE_VOID_PENDING, pend = GST_STATE_VOID_PENDING;
+  const GstStateChangeReturn ret = gst_element_get_state(element, &cur, &pend, 0);
+  if (cur != pipelineState || pend != GST_STATE_VOID_PENDING || ret == GST_STATE_CHANGE_FAILURE) {
+    out.push_back(format("element %s (%s): %s pending %s (%s)", name, factoryName,
+                         gst_element_state_get_name(cur), gst_element_state_get_name(pend),
+                         gst_element_state_change_return_get_name(ret)));
+  }
+  appendLevels(element, name, out);
+  if (!hasProperty(element, "current-level-time")) {
+    // Multiqueue levels live on its sink pads (1.18+)
+    GValue item = G_VALUE_INIT;
+    GstIterator* sinks = gst_element_iterate_sink_pads(element);
+    while (gst_iterator_next(sinks, &item) == GST_ITERATOR_OK) {
+      GstPad* pad = GST_PAD(g_value_get_object(&item));
+      gchar* padName = gst_object_get_name(GST_OBJECT(pad));
+      appendLevels(pad, std::string(name) + ":" + padName, out);
+      g_free(padName);
+      g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(sinks);
+  }
+  g_free(name);
+}
+
+#if defined(__linux__)
+std::string readFirstLine(const std::string& path) {
+  std::ifstream f(path);
+  std::string line;
+  std::getline(f, line);
+  return line;
+}
+
+void appendThreads(std::vector<std::string>& out) {
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir) return;
+  while (dirent* ent = readdir(dir)) {
+    if (ent->d_name[0] == '.') continue;
+    const std::string base = std::string("/proc/self/task/") + ent->d_name;
+    const std::string comm = readFirstLine(base + "/comm");
+    // Field 3 of stat is the scheduler state; comm may contain spaces, so
+    // look after the closing parenthesis
+    const std::string stat = readFirstLine(base + "/stat");
+    const size_t paren = stat.rfind(')');
+    const char state = paren != std::string::npos && paren + 2 < stat.size() ? stat[paren + 2] : '?';
+    const std::string wchan = readFirstLine(base + "/wchan");
+    out.push_back(format("thread %s %-16s state=%c wchan=%s", ent->d_name, comm.c_str(), state,
+                         wchan.empty() ? "-" : wchan.c_str()));
+  }
+  closedir(dir);
+}
+#endif
+
+}  // namespace
+
+std::vector<std::string> collectPipelineDiagnostics(GstElement* pipeline, const char* dotName) {
+  std::vector<std::string> out;
+  GstState cur = GST_STATE_VOID_PENDING, pend = GST_STATE_VOID_PENDING;
+  const GstStateChangeReturn ret = gst_element_get_state(pipeline, &cur, &pend, 0);
+  out.push_back(format("pipeline: %s pending %s (%s)%s", gst_element_state_get_name(cur),
+                       gst_element_state_get_name(pend), gst_element_state_change_return_get_name(ret),
+                       ret == GST_STATE_CHANGE_ASYNC ? " - preroll or flushing seek still in flight" : ""));
+
+  GstIterator* it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+  GValue item = G_VALUE_INIT;
+  bool done = false;
+  while (!done) {
+    switch (gst_iterator_next(it, &item)) {
+      case GST_ITERATOR_OK:
+        appendElement(GST_ELEMENT(g_value_get_object(&item)), cur, out);
+        g_value_reset(&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync(it);
+        break;
+      default:
+        done = true;
+        break;
+    }
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+
+  if (std::getenv("GST_DEBUG_DUMP_DOT_DIR")) {
+    GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS(GST_BIN(pipeline), GST_DEBUG_GRAPH_SHOW_ALL, dotName);
+    out.push_back(format("dot graph written to %s (*%s.dot)", std::getenv("GST_DEBUG_DUMP_DOT_DIR"), dotName));
+  } else {
+    out.push_back("dot graph skipped (set GST_DEBUG_DUMP_DOT_DIR)");
+  }
+#if defined(__linux__)
+  appendThreads(out);
+#endif
+  return out;
+}
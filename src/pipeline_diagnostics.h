@@ -0,0 +1,16 @@
+// File: src/pipeline_diagnostics.h
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Snapshot of a pipeline for post-mortem of stalls:
+//  - pipeline state and pending state (ASYNC = preroll/seek in flight)
+//  - every element not settled in the pipeline's state
+//  - fill level of every queue / queue2 / multiqueue pad
+//  - a dot graph (when GST_DEBUG_DUMP_DOT_DIR is set)
+//  - on Linux, each thread's name, scheduler state and kernel wait channel
+// One human-readable line per entry.
+std::vector<std::string> collectPipelineDiagnostics(GstElement* pipeline, const char* dotName);
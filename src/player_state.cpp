@@ -0,0 +1,153 @@
+// File: src/player_state.cpp
+#include "player_state.h"
+#include "percentile.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+std::string key(GstState from, GstState to) {
+  return std::string(gst_element_state_get_name(from)) + "->" + gst_element_state_get_name(to);
+}
+}  // namespace
+
+const char* PlayerStateMachine::resultName(Result r) {
+  switch (r) {
+    case Result::Issued:   return "issued";
+    case Result::Queued:   return "queued";
+    case Result::Merged:   return "merged";
+    case Result::Rejected: return "rejected";
+  }
+  return "?";
+}
+
+void PlayerStateMachine::Latencies::add(double ms) {
+  if (recent.size() < kLatencyWindow) {
+    recent.push_back(ms);
+  } else {
+    recent[next] = ms;
+  }
+  next = (next + 1) % kLatencyWindow;
+  count++;
+  max = std::max(max, ms);
+}
+
+GstState PlayerStateMachine::target() const {
+  if (queued_ != GST_STATE_VOID_PENDING) return queued_;
+  if (inFlight_) return pendingTarget_;
+  return current_;
+}
+
+PlayerStateMachine::Result PlayerStateMachine::request(GstState target, const char* reason, bool afterError) {
+  if (!pipeline_) return Result::Rejected;
+  const bool teardown = target <= GST_STATE_READY;
+  if (errorTeardown_ && !teardown) {
+    rejected_++;
+    return Result::Rejected;
+  }
+  if (afterError && teardown) errorTeardown_ = true;
+  if (target == this->target() && !teardown) {
+    merged_++;
+    return Result::Merged;
+  }
+  if (inFlight_ && !teardown) {
+    // Latest intent wins; an earlier queued request is dropped
+    if (queued_ != GST_STATE_VOID_PENDING) merged_++;
+    queued_ = target;
+    queuedReason_ = reason;
+    return Result::Queued;
+  }
+  queued_ = GST_STATE_VOID_PENDING;
+  if (inFlight_) {
+    // Going down interrupts an async upward change; report it as superseded
+    settle(false);
+  }
+  return issue(target, reason);
+}
+
+PlayerStateMachine::Result PlayerStateMachine::issue(GstState target, const std::string& reason) {
+  inFlight_ = true;
+  from_ = current_;
+  pendingTarget_ = target;
+  pendingReason_ = reason;
+  startUs_ = g_get_monotonic_time();
+  const GstStateChangeReturn ret = gst_element_set_state(pipeline_, target);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    settle(false);
+  } else if (ret != GST_STATE_CHANGE_ASYNC) {
+    // SUCCESS / NO_PREROLL: already there
+    current_ = target;
+    settle(true);
+  }
+  return Result::Issued;
+}
+
+void PlayerStateMachine::settle(bool ok) {
+  if (!inFlight_) return;
+  inFlight_ = false;
+  Transition t{from_, pendingTarget_, double(g_get_monotonic_time() - startUs_) / 1000.0, ok, pendingReason_};
+  const std::string k = key(t.from, t.to);
+  if (ok) {
+    latencies_[k].add(t.ms);
+  } else {
+    failures_[k]++;
+  }
+  if (ok && t.to <= GST_STATE_READY) errorTeardown_ = false;
+  if (listener_) listener_(t);
+  if (queued_ != GST_STATE_VOID_PENDING) {
+    const GstState next = queued_;
+    queued_ = GST_STATE_VOID_PENDING;
+    if (next != current_) issue(next, queuedReason_);
+  }
+}
+
+void PlayerStateMachine::handleMessage(GstMessage* msg) {
+  if (!pipeline_ || GST_MESSAGE_SRC(msg) != GST_OBJECT(pipeline_)) return;
+  switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_STATE_CHANGED: {
+      GstState oldState, newState, pending;
+      gst_message_parse_state_changed(msg, &oldState, &newState, &pending);
+      // Outside a transition, intermediate steps of one that already
+      // returned SUCCESS are stale
+      if (inFlight_ || pending == GST_STATE_VOID_PENDING) current_ = newState;
+      if (inFlight_ && newState == pendingTarget_ && pending == GST_STATE_VOID_PENDING) {
+        settle(true);
+      }
+      break;
+    }
+    case GST_MESSAGE_ASYNC_DONE: {
+      // Also completes async changes whose STATE_CHANGED was already seen
+      GstState cur = GST_STATE_VOID_PENDING, pend = GST_STATE_VOID_PENDING;
+      gst_element_get_state(pipeline_, &cur, &pend, 0);
+      current_ = cur;
+      if (inFlight_ && cur == pendingTarget_) settle(true);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+std::vector<std::string> PlayerStateMachine::report() const {
+  std::vector<std::string> lines;
+  char line[256];
+  for (const auto& kv : latencies_) {
+    const Latencies& l = kv.second;
+    std::vector<double> recent = l.recent;   // percentile() reorders
+    const auto f = failures_.find(kv.first);
+    std::snprintf(line, sizeof(line), "%s n=%llu q50=%.1f ms q95=%.1f ms max=%.1f ms failed=%llu",
+                  kv.first.c_str(), (unsigned long long)l.count, percentile(recent, 50.0),
+                  percentile(recent, 95.0), l.max,
+                  (unsigned long long)(f == failures_.end() ? 0 : f->second));
+    lines.push_back(line);
+  }
+  for (const auto& kv : failures_) {
+    if (latencies_.count(kv.first)) continue;
+    std::snprintf(line, sizeof(line), "%s n=0 failed=%llu", kv.first.c_str(), (unsigned long long)kv.second);
+    lines.push_back(line);
+  }
+  std::snprintf(line, sizeof(line), "merged=%llu rejected=%llu",
+                (unsigned long long)merged_, (unsigned long long)rejected_);
+  lines.push_back(line);
+  return lines;
+}
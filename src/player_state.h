@@ -0,0 +1,84 @@
+// File: src/player_state.h
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Non-blocking owner of the pipeline's target state. Requests are issued
+// with gst_element_set_state() and never waited on; completion is taken
+// from STATE_CHANGED / ASYNC_DONE on the bus. While a transition is in
+// flight, a new request for a different state is queued (the latest request
+// replaces any earlier queued one) and issued when the transition settles.
+// Teardown (READY/NULL) preempts immediately. After an error teardown,
+// requests to play or pause are rejected until READY is reached.
+// All calls happen on the thread that pumps the bus.
+class PlayerStateMachine {
+public:
+  enum class Result { Issued, Queued, Merged, Rejected };
+
+  struct Transition {
+    GstState    from;
+    GstState    to;
+    double      ms;       // request → settled
+    bool        ok;
+    std::string reason;
+  };
+  using Listener = std::function<void(const Transition&)>;
+
+  void attach(GstElement* pipeline) { pipeline_ = pipeline; }
+  void setListener(Listener l) { listener_ = std::move(l); }
+
+  // afterError: teardown caused by an error; blocks play/pause until READY
+  Result request(GstState target, const char* reason, bool afterError = false);
+  void   handleMessage(GstMessage* msg);
+
+  GstState current() const { return current_; }
+  // Where the pipeline is headed once everything requested has settled
+  GstState target() const;
+  bool     busy() const { return inFlight_; }
+
+  uint64_t merged() const { return merged_; }
+  uint64_t rejected() const { return rejected_; }
+  // One line per transition kind: count, q50/q95 latency over the most
+  // recent kLatencyWindow transitions, max over all of them, failures
+  std::vector<std::string> report() const;
+
+  static constexpr size_t kLatencyWindow = 256;
+
+  static const char* resultName(Result r);
+
+private:
+  // Bounded per-kind latency history; long soaks and scenarios don't grow it
+  struct Latencies {
+    std::vector<double> recent;   // ring of the last kLatencyWindow samples
+    size_t   next{0};
+    uint64_t count{0};
+    double   max{0.0};
+    void add(double ms);
+  };
+
+  Result issue(GstState target, const std::string& reason);
+  void   settle(bool ok);
+
+  GstElement* pipeline_{nullptr};
+  Listener    listener_;
+  GstState    current_{GST_STATE_NULL};
+  bool        inFlight_{false};
+  GstState    from_{GST_STATE_NULL};
+  GstState    pendingTarget_{GST_STATE_VOID_PENDING};
+  std::string pendingReason_;
+  gint64      startUs_{0};
+  GstState    queued_{GST_STATE_VOID_PENDING};
+  std::string queuedReason_;
+  bool        errorTeardown_{false};
+
+  uint64_t merged_{0};
+  uint64_t rejected_{0};
+  std::map<std::string, Latencies> latencies_;
+  std::map<std::string, uint64_t> failures_;
+};
@@ -0,0 +1,129 @@
+// File: src/position_service.cpp
+#include "position_service.h"
+
+#include <algorithm>
+
+namespace {
+// Interpolation never runs further than two buffer intervals past the last
+// buffer (and never less than this), so a stalled pipeline shows a stalled
+// position instead of a drifting one
+constexpr GstClockTime kMinLead = 100 * GST_MSECOND;
+// While the duration is unknown (live, still prerolling) it is re-queried at
+// most this often instead of on every tick
+constexpr gint64 kDurationRetryUs = 500 * 1000;
+}  // namespace
+
+PositionService::~PositionService() {
+  detach();
+}
+
+void PositionService::attach(GstElement* pipeline, GstPad* sinkPad) {
+  detach();
+  pipeline_ = GST_ELEMENT(gst_object_ref(pipeline));
+  pad_ = GST_PAD(gst_object_ref(sinkPad));
+  probeId_ = gst_pad_add_probe(pad_,
+                               (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_FLUSH),
+                               &PositionService::onProbe, this, nullptr);
+}
+
+void PositionService::detach() {
+  if (pad_) {
+    if (probeId_) gst_pad_remove_probe(pad_, probeId_);
+    gst_object_unref(pad_);
+  }
+  if (pipeline_) gst_object_unref(pipeline_);
+  pad_ = nullptr;
+  pipeline_ = nullptr;
+  probeId_ = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  valid_ = false;
+}
+
+// Streaming thread
+GstPadProbeReturn PositionService::onProbe(GstPad* pad, GstPadProbeInfo* info, gpointer userData) {
+  auto* self = static_cast<PositionService*>(userData);
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_FLUSH) {
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_FLUSH_STOP) {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      self->valid_ = false;
+    }
+    return GST_PAD_PROBE_OK;
+  }
+  GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buf || !GST_BUFFER_PTS_IS_VALID(buf)) return GST_PAD_PROBE_OK;
+  GstEvent* ev = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+  if (!ev) return GST_PAD_PROBE_OK;
+  const GstSegment* seg = nullptr;
+  gst_event_parse_segment(ev, &seg);
+  if (seg->format == GST_FORMAT_TIME) {
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    const GstClockTime st = gst_segment_to_stream_time(seg, GST_FORMAT_TIME, pts);
+    const GstClockTime rt = gst_segment_to_running_time(seg, GST_FORMAT_TIME, pts);
+    if (GST_CLOCK_TIME_IS_VALID(st) && GST_CLOCK_TIME_IS_VALID(rt)) {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      if (self->valid_ && rt > self->runningTime_) self->interval_ = rt - self->runningTime_;
+      self->streamTime_ = st;
+      self->runningTime_ = rt;
+      self->rate_ = seg->rate * seg->applied_rate;
+      self->valid_ = true;
+    }
+  }
+  gst_event_unref(ev);
+  return GST_PAD_PROBE_OK;
+}
+
+void PositionService::setPlaying(bool playing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  playing_ = playing;
+}
+
+void PositionService::invalidateDuration() {
+  duration_ = GST_CLOCK_TIME_NONE;
+  lastDurationQueryUs_ = 0;
+}
+
+GstClockTime PositionService::position() {
+  if (!pipeline_) return GST_CLOCK_TIME_NONE;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (valid_ && !playing_) {
+      // Paused: the last buffer is what is on screen
+      return streamTime_;
+    }
+    if (valid_) {
+      GstClock* clock = gst_element_get_clock(pipeline_);
+      if (clock) {
+        const GstClockTimeDiff now = GstClockTimeDiff(gst_clock_get_time(clock)) -
+                                     GstClockTimeDiff(gst_element_get_base_time(pipeline_));
+        gst_object_unref(clock);
+        const GstClockTimeDiff lead = GstClockTimeDiff(std::max(kMinLead, 2 * interval_));
+        // Negative: the buffer is still waiting for its render time (audio
+        // sinks take data well ahead)
+        const GstClockTimeDiff delta = std::clamp<GstClockTimeDiff>(now - GstClockTimeDiff(runningTime_),
+                                                                     -GST_SECOND, lead);
+        const GstClockTimeDiff pos = GstClockTimeDiff(streamTime_) + GstClockTimeDiff(double(delta) * rate_);
+        interpolated_++;
+        return GstClockTime(std::max<GstClockTimeDiff>(0, pos));
+      }
+    }
+  }
+  gint64 pos = 0;
+  positionQueries_++;
+  return gst_element_query_position(pipeline_, GST_FORMAT_TIME, &pos) ? GstClockTime(pos) : GST_CLOCK_TIME_NONE;
+}
+
+GstClockTime PositionService::duration() {
+  GstClockTime cached = duration_;
+  if (GST_CLOCK_TIME_IS_VALID(cached) || !pipeline_) return cached;
+  const gint64 nowUs = g_get_monotonic_time();
+  const gint64 lastUs = lastDurationQueryUs_;
+  if (lastUs && nowUs - lastUs < kDurationRetryUs) return GST_CLOCK_TIME_NONE;
+  lastDurationQueryUs_ = nowUs;
+  gint64 dur = 0;
+  durationQueries_++;
+  if (gst_element_query_duration(pipeline_, GST_FORMAT_TIME, &dur) && dur > 0) {
+    duration_ = GstClockTime(dur);
+    return GstClockTime(dur);
+  }
+  return GST_CLOCK_TIME_NONE;
+}
@@ -0,0 +1,57 @@
+// File: src/position_service.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <gst/gst.h>
+
+// Playback position without per-tick pipeline queries. A probe on a sink pad
+// records the stream time and running time of the last buffer; position() is
+// that stream time advanced by how far the pipeline clock has moved past the
+// buffer's running time. Duration is queried once and cached until
+// DURATION_CHANGED; while it is unknown, the query is retried at most twice a
+// second. Falls back to a position query until the first buffer
+// after attach or a flush.
+class PositionService {
+public:
+  PositionService() = default;
+  ~PositionService();
+  PositionService(const PositionService&) = delete;
+  PositionService& operator=(const PositionService&) = delete;
+
+  void attach(GstElement* pipeline, GstPad* sinkPad);
+  void detach();
+
+  void setPlaying(bool playing);       // from STATE_CHANGED on the pipeline
+  void invalidateDuration();           // from DURATION_CHANGED
+
+  GstClockTime position();             // NONE when unknown
+  GstClockTime duration();             // NONE when unknown
+
+  uint64_t positionQueries() const { return positionQueries_; }
+  uint64_t durationQueries() const { return durationQueries_; }
+  uint64_t interpolated() const { return interpolated_; }
+
+private:
+  static GstPadProbeReturn onProbe(GstPad* pad, GstPadProbeInfo* info, gpointer userData);
+
+  GstElement* pipeline_{nullptr};
+  GstPad*     pad_{nullptr};
+  gulong      probeId_{0};
+
+  std::mutex   mutex_;
+  bool         valid_{false};
+  GstClockTime streamTime_{GST_CLOCK_TIME_NONE};
+  GstClockTime runningTime_{GST_CLOCK_TIME_NONE};
+  GstClockTime interval_{0};           // last inter-buffer running-time step
+  double       rate_{1.0};
+  bool         playing_{false};
+
+  std::atomic<GstClockTime> duration_{GST_CLOCK_TIME_NONE};
+  std::atomic<gint64> lastDurationQueryUs_{0};   // monotonic; 0 = query now
+  std::atomic<uint64_t> positionQueries_{0};
+  std::atomic<uint64_t> durationQueries_{0};
+  std::atomic<uint64_t> interpolated_{0};
+};
@@ -0,0 +1,255 @@
+// File: src/rendition_pools.cpp
+#include "rendition_pools.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+struct RenditionPools::Cache {
+  struct Size {
+    std::vector<GstMemory*> mems;   // retained memories, each holding the only reference
+    uint64_t lastUse{0};
+  };
+
+  std::mutex mutex;
+  bool closed{false};
+  unsigned perSize{4};
+  uint64_t maxBytes{0};   // across all sizes (0 = unbounded)
+  gsize ceiling{0};       // larger memories are not retained (0 = any size)
+  uint64_t tick{0};
+  GstAllocator* backing{nullptr};
+  std::map<gsize, Size> free;   // by maxsize
+  RecycleStats stats;
+
+  // Outlives RenditionPools while the allocator or frames in flight hold it
+  ~Cache() {
+    if (backing) gst_object_unref(backing);
+  }
+};
+
+using CacheRef = std::shared_ptr<RenditionPools::Cache>;
+
+struct RecyclingAllocator {
+  GstAllocator parent;
+  CacheRef* cache;
+};
+
+struct RecyclingAllocatorClass {
+  GstAllocatorClass parent_class;
+};
+
+G_DEFINE_TYPE(RecyclingAllocator, recycling_allocator, GST_TYPE_ALLOCATOR)
+
+namespace {
+
+GQuark cacheQuark() {
+  static const GQuark quark = g_quark_from_static_string("rendition-pools-cache");
+  return quark;
+}
+
+void dropCacheRef(gpointer data) {
+  delete static_cast<CacheRef*>(data);
+}
+
+// Takes memory out of the least recently used sizes other than keep until
+// bytes more fit under maxBytes; the caller unrefs what was evicted once the
+// lock is released. False when it can't be made to fit.
+bool makeRoomLocked(RenditionPools::Cache& cache, gsize keep, uint64_t bytes, std::vector<GstMemory*>& evicted) {
+  if (!cache.maxBytes) return true;
+  if (bytes > cache.maxBytes) return false;
+  while (cache.stats.cachedBytes + bytes > cache.maxBytes) {
+    auto victim = cache.free.end();
+    for (auto it = cache.free.begin(); it != cache.free.end(); ++it) {
+      if (it->first == keep || it->second.mems.empty()) continue;
+      if (victim == cache.free.end() || it->second.lastUse < victim->second.lastUse) victim = it;
+    }
+    if (victim == cache.free.end()) return false;
+    for (GstMemory* m : victim->second.mems) {
+      GST_MINI_OBJECT_CAST(m)->dispose = nullptr;
+      cache.stats.cachedBytes -= m->maxsize;
+      cache.stats.evicted++;
+      evicted.push_back(m);
+    }
+    cache.free.erase(victim);
+  }
+  return true;
+}
+
+// Mini-object dispose hook: returning FALSE after reviving the memory keeps
+// it alive (the same mechanism GstBufferPool uses for buffers)
+gboolean recycleMemory(GstMiniObject* obj) {
+  auto* ref = static_cast<CacheRef*>(gst_mini_object_get_qdata(obj, cacheQuark()));
+  if (!ref) return TRUE;
+  RenditionPools::Cache& cache = **ref;
+  GstMemory* mem = GST_MEMORY_CAST(obj);
+  std::vector<GstMemory*> evicted;
+  bool kept = false;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto& slot = cache.free[mem->maxsize];
+    slot.lastUse = ++cache.tick;
+    if (!cache.closed && slot.mems.size() < cache.perSize && (!cache.ceiling || mem->maxsize <= cache.ceiling) &&
+        makeRoomLocked(cache, mem->maxsize, mem->maxsize, evicted)) {
+      gst_mini_object_ref(obj);
+      slot.mems.push_back(mem);
+      cache.stats.cachedBytes += mem->maxsize;
+      kept = true;
+    } else {
+      obj->dispose = nullptr;
+      cache.stats.dropped++;
+    }
+  }
+  for (GstMemory* m : evicted) gst_memory_unref(m);
+  return kept ? FALSE : TRUE;
+}
+
+GstMemory* allocateTracked(const CacheRef& cache, gsize size, GstAllocationParams* params) {
+  GstMemory* mem = gst_allocator_alloc(cache->backing, size, params);
+  if (!mem) return nullptr;
+  gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(mem), cacheQuark(), new CacheRef(cache), &dropCacheRef);
+  GST_MINI_OBJECT_CAST(mem)->dispose = recycleMemory;
+  return mem;
+}
+
+GstMemory* recyclingAlloc(GstAllocator* allocator, gsize size, GstAllocationParams* params) {
+  const CacheRef& cache = *reinterpret_cast<RecyclingAllocator*>(allocator)->cache;
+  cache->stats.requests++;
+  const gsize maxsize = size + params->prefix + params->padding;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto it = cache->free.find(maxsize);
+    if (it != cache->free.end()) it->second.lastUse = ++cache->tick;
+    std::vector<GstMemory*>* list = it == cache->free.end() ? nullptr : &it->second.mems;
+    // Alignments are masks (2^n - 1): a larger one satisfies a smaller one
+    auto fit = list ? std::find_if(list->begin(), list->end(),
+                                   [params](GstMemory* m) { return m->align >= params->align; })
+                    : std::vector<GstMemory*>::iterator();
+    if (list && fit != list->end()) {
+      GstMemory* mem = *fit;
+      list->erase(fit);
+      cache->stats.cachedBytes -= mem->maxsize;
+      cache->stats.hits++;
+      // A previous user may have resized it
+      mem->offset = params->prefix;
+      mem->size = size;
+      GST_MEMORY_FLAG_UNSET(mem, GST_MEMORY_FLAG_READONLY);
+      return mem;
+    }
+  }
+  cache->stats.misses++;
+  return allocateTracked(cache, size, params);
+}
+
+// Never called: every memory is created (and freed) by the backing allocator
+void recyclingFree(GstAllocator*, GstMemory*) {}
+
+// Fault the pages in now rather than in the first frame after a switch
+void touchPages(GstMemory* mem) {
+  GstMapInfo map;
+  if (!gst_memory_map(mem, &map, GST_MAP_WRITE)) return;
+  for (gsize off = 0; off < map.size; off += 4096) map.data[off] = 0;
+  gst_memory_unmap(mem, &map);
+}
+
+void recyclingFinalize(GObject* object) {
+  delete reinterpret_cast<RecyclingAllocator*>(object)->cache;
+  G_OBJECT_CLASS(recycling_allocator_parent_class)->finalize(object);
+}
+
+}  // namespace
+
+static void recycling_allocator_class_init(RecyclingAllocatorClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = recyclingFinalize;
+  GstAllocatorClass* allocator = GST_ALLOCATOR_CLASS(klass);
+  allocator->alloc = recyclingAlloc;
+  allocator->free = recyclingFree;
+}
+
+static void recycling_allocator_init(RecyclingAllocator*) {}
+
+RenditionPools::~RenditionPools() {
+  if (!cache_) return;
+  std::vector<GstMemory*> retained;
+  {
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    cache_->closed = true;
+    for (auto& kv : cache_->free) retained.insert(retained.end(), kv.second.mems.begin(), kv.second.mems.end());
+    cache_->free.clear();
+    cache_->stats.cachedBytes = 0;
+  }
+  // Closed: the dispose hook lets them go now
+  for (GstMemory* mem : retained) gst_memory_unref(mem);
+  if (allocator_) gst_object_unref(allocator_);
+}
+
+void RenditionPools::init(GstAllocator* backing, unsigned perSize, uint64_t maxBytes) {
+  if (allocator_) return;
+  cache_ = std::make_shared<Cache>();
+  cache_->perSize = std::max(1u, perSize);
+  cache_->maxBytes = maxBytes;
+  cache_->backing = backing ? GST_ALLOCATOR(gst_object_ref(backing)) : gst_allocator_find(nullptr);
+  auto* alloc = static_cast<RecyclingAllocator*>(g_object_new(recycling_allocator_get_type(), nullptr));
+  gst_object_ref_sink(alloc);
+  alloc->cache = new CacheRef(cache_);
+  allocator_ = GST_ALLOCATOR_CAST(alloc);
+}
+
+void RenditionPools::prewarm(GstVideoFormat format, const std::vector<std::pair<int, int>>& sizes, unsigned count) {
+  if (!cache_) return;
+  GstAllocationParams params;
+  gst_allocation_params_init(&params);
+  params.align = 63;   // covers the alignments pools usually ask for
+  const unsigned want = std::min(count, cache_->perSize);
+  for (const auto& wh : sizes) {
+    GstVideoInfo info;
+    if (wh.first <= 0 || wh.second <= 0 || !gst_video_info_set_format(&info, format, guint(wh.first), guint(wh.second))) {
+      continue;
+    }
+    const gsize size = GST_VIDEO_INFO_SIZE(&info);
+    size_t need = 0;
+    {
+      std::lock_guard<std::mutex> lock(cache_->mutex);
+      const auto it = cache_->free.find(size);
+      const size_t have = it == cache_->free.end() ? 0 : it->second.mems.size();
+      need = have < want ? want - have : 0;
+    }
+    std::vector<GstMemory*> mems;
+    while (mems.size() < need) {
+      GstMemory* mem = allocateTracked(cache_, size, &params);
+      if (!mem) break;
+      touchPages(mem);
+      mems.push_back(mem);
+      cache_->stats.prewarmed++;
+    }
+    // Unref runs the dispose hook, which parks them in the cache
+    for (GstMemory* mem : mems) gst_memory_unref(mem);
+  }
+}
+
+void RenditionPools::setSizeCeiling(gsize maxFrameBytes) {
+  if (!cache_) return;
+  std::vector<GstMemory*> evicted;
+  {
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    cache_->ceiling = maxFrameBytes;
+    for (auto it = cache_->free.begin(); it != cache_->free.end();) {
+      if (!maxFrameBytes || it->first <= maxFrameBytes) {
+        ++it;
+        continue;
+      }
+      for (GstMemory* m : it->second.mems) {
+        GST_MINI_OBJECT_CAST(m)->dispose = nullptr;
+        cache_->stats.cachedBytes -= m->maxsize;
+        cache_->stats.evicted++;
+        evicted.push_back(m);
+      }
+      it = cache_->free.erase(it);
+    }
+  }
+  for (GstMemory* m : evicted) gst_memory_unref(m);
+}
+
+const RecycleStats& RenditionPools::stats() const {
+  static const RecycleStats none;
+  return cache_ ? cache_->stats : none;
+}
@@ -0,0 +1,57 @@
+// File: src/rendition_pools.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+struct RecycleStats {
+  std::atomic<uint64_t> requests{0};
+  std::atomic<uint64_t> hits{0};         // served from retained frame memory
+  std::atomic<uint64_t> misses{0};       // fresh allocations from the backing allocator
+  std::atomic<uint64_t> prewarmed{0};
+  std::atomic<uint64_t> dropped{0};      // released beyond the per-size or total bound
+  std::atomic<uint64_t> evicted{0};      // retained, then freed to make room for a more recent size
+  std::atomic<uint64_t> cachedBytes{0};
+};
+
+// Frame memory that survives renegotiation. A buffer pool is torn down on
+// every caps change (its buffers and their memory are freed), so switching
+// renditions re-allocates and re-faults every frame. The allocator offered
+// here keeps the memory of freed frames per size (up to perSize blocks) and
+// hands it back when a pool for the same size starts again; prewarm() fills
+// it ahead of time for every rendition the player can switch to. Retained
+// memory is bounded in total by maxBytes: the least recently used sizes (a
+// window resize passing through) are evicted first. Misses go to the backing
+// allocator (system memory when none is given).
+class RenditionPools {
+public:
+  RenditionPools() = default;
+  ~RenditionPools();
+  RenditionPools(const RenditionPools&) = delete;
+  RenditionPools& operator=(const RenditionPools&) = delete;
+
+  void init(GstAllocator* backing, unsigned perSize, uint64_t maxBytes);
+  GstAllocator* allocator() const { return allocator_; }   // offer in ALLOCATION queries
+  bool active() const { return allocator_ != nullptr; }
+
+  // Retains `count` frames of each size for format (default video strides)
+  void prewarm(GstVideoFormat format, const std::vector<std::pair<int, int>>& sizes, unsigned count);
+
+  // Frees retained memory larger than maxFrameBytes and stops retaining
+  // such memory from now on (0 lifts the ceiling)
+  void setSizeCeiling(gsize maxFrameBytes);
+
+  const RecycleStats& stats() const;
+
+  struct Cache;
+
+private:
+  std::shared_ptr<Cache> cache_;
+  GstAllocator* allocator_{nullptr};
+};
@@ -0,0 +1,370 @@
+// File: src/reverse_decoder.cpp
+#include "reverse_decoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace {
+
+constexpr int kPullTimeoutMs = 100;
+
+// Keep audio compressed: reverse playback presents video only
+gboolean skipAudio(GstElement*, GstPad*, GstCaps* caps, gpointer) {
+  const GstStructure* st = gst_caps_get_structure(caps, 0);
+  return g_str_has_prefix(gst_structure_get_name(st), "audio/") ? FALSE : TRUE;
+}
+
+// Split the cores between GOP workers instead of letting every decoder
+// spawn one thread per core
+void limitDecoderThreads(GstBin*, GstElement* element, gpointer userData) {
+  const guint threads = GPOINTER_TO_UINT(userData);
+  if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), "max-threads")) {
+    g_object_set(element, "max-threads", gint(threads), NULL);
+  } else if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), "n-threads")) {
+    g_object_set(element, "n-threads", threads, NULL);
+  }
+}
+
+void linkVideoPad(GstElement*, GstPad* pad, gpointer userData) {
+  GstElement* sink = static_cast<GstElement*>(userData);
+  GstPad* sinkpad = gst_element_get_static_pad(sink, "sink");
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  if (!caps) caps = gst_pad_query_caps(pad, nullptr);
+  const bool video = caps && !gst_caps_is_empty(caps) &&
+                     g_str_has_prefix(gst_structure_get_name(gst_caps_get_structure(caps, 0)), "video/");
+  if (video && !gst_pad_is_linked(sinkpad)) {
+    gst_pad_link(pad, sinkpad);
+  }
+  if (caps) gst_caps_unref(caps);
+  gst_object_unref(sinkpad);
+}
+
+// Pulls with a timeout so shutdown and errors are noticed; nullptr on
+// EOS (eos = true), error or timeout
+GstSample* pullSample(GstElement* appsink, GstBus* bus, bool& eos, bool& error) {
+  GstSample* sample = nullptr;
+  g_signal_emit_by_name(appsink, "try-pull-sample", GstClockTime(kPullTimeoutMs * GST_MSECOND), &sample);
+  if (sample) return sample;
+  gboolean isEos = FALSE;
+  g_object_get(appsink, "eos", &isEos, NULL);
+  eos = isEos;
+  if (GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) {
+    error = true;
+    gst_message_unref(msg);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+ReverseDecoder::~ReverseDecoder() {
+  stop();
+}
+
+bool ReverseDecoder::start(const std::string& location, GstCaps* outCaps, GstClockTime playhead,
+                           unsigned workers, size_t budgetBytes) {
+  stop();
+  if (location.empty() || !outCaps || !GST_CLOCK_TIME_IS_VALID(playhead)) return false;
+  location_ = location;
+  gst_caps_replace(&caps_, outCaps);
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  workerCount_ = workers ? workers : std::clamp(cores / 2, 1u, 4u);
+  decoderThreads_ = std::max(1u, cores / workerCount_);
+  maxAhead_ = workerCount_;
+  budget_ = budgetBytes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    indexDone_ = false;
+    failed_ = false;
+    playhead_ = playhead;
+    gops_ = 0;
+    decodedFrames_ = 0;
+    gopMsTotal_ = 0.0;
+  }
+  indexThread_ = std::thread(&ReverseDecoder::indexLoop, this);
+  for (unsigned i = 0; i < workerCount_; ++i) {
+    threads_.emplace_back(&ReverseDecoder::workerLoop, this, i);
+  }
+  return true;
+}
+
+void ReverseDecoder::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (indexThread_.joinable()) indexThread_.join();
+  for (std::thread& t : threads_) t.join();
+  threads_.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& kv : frames_) gst_sample_unref(kv.second);
+  frames_.clear();
+  bytes_ = 0;
+  keyframes_.clear();
+  scheduled_.clear();
+  done_.clear();
+  if (caps_) gst_caps_unref(caps_);
+  caps_ = nullptr;
+}
+
+// Parse-only pass (no decoding): every non-delta video buffer is a keyframe
+void ReverseDecoder::indexLoop() {
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch("filesrc name=src ! parsebin name=p", &err);
+  GstElement* sink = gst_element_factory_make("appsink", "idx");
+  if (!pipe || !sink) {
+    if (err) g_error_free(err);
+    if (pipe) gst_object_unref(pipe);
+    if (sink) gst_object_unref(sink);
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexDone_ = true;
+    failed_ = true;
+    cv_.notify_all();
+    return;
+  }
+  g_object_set(sink, "sync", FALSE, NULL);
+  gst_bin_add(GST_BIN(pipe), sink);
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* parse = gst_bin_get_by_name(GST_BIN(pipe), "p");
+  g_object_set(src, "location", location_.c_str(), NULL);
+  g_signal_connect(parse, "pad-added", G_CALLBACK(&linkVideoPad), sink);
+  gst_object_unref(parse);
+  gst_object_unref(src);
+
+  GstBus* bus = gst_element_get_bus(pipe);
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  bool eos = false, error = false;
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) break;
+    }
+    GstSample* sample = pullSample(sink, bus, eos, error);
+    if (!sample) {
+      if (eos || error) break;
+      continue;
+    }
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    if (buf && !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+      const GstClockTime ts = GST_BUFFER_PTS_IS_VALID(buf) ? GST_BUFFER_PTS(buf) : GST_BUFFER_DTS(buf);
+      if (GST_CLOCK_TIME_IS_VALID(ts)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::lower_bound(keyframes_.begin(), keyframes_.end(), ts);
+        if (it == keyframes_.end() || *it != ts) keyframes_.insert(it, ts);
+        cv_.notify_all();
+      }
+    }
+    gst_sample_unref(sample);
+  }
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+  std::lock_guard<std::mutex> lock(mutex_);
+  indexDone_ = true;
+  failed_ = failed_ || error;
+  cv_.notify_all();
+}
+
+bool ReverseDecoder::gopBelowLocked(GstClockTime pts, size_t& idx) const {
+  auto it = std::lower_bound(keyframes_.begin(), keyframes_.end(), pts);
+  // A later keyframe may still show up between the last known one and pts
+  if (it == keyframes_.end() && !indexDone_) return false;
+  if (it == keyframes_.begin()) return false;
+  idx = size_t(std::distance(keyframes_.begin(), it)) - 1;
+  return true;
+}
+
+bool ReverseDecoder::nextGop(GstClockTime& start, GstClockTime& stop) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    if (stopping_) return false;
+    size_t idx = 0;
+    if (gopBelowLocked(playhead_, idx)) {
+      // Walk down from the playhead: GOPs already handed out count as ahead
+      unsigned ahead = 0;
+      for (size_t i = idx + 1; i-- > 0;) {
+        const GstClockTime k = keyframes_[i];
+        if (scheduled_.count(k)) {
+          if (++ahead >= maxAhead_) break;
+          continue;
+        }
+        if (ahead > 0 && bytes_ >= budget_) break;
+        scheduled_.insert(k);
+        start = k;
+        stop = i + 1 < keyframes_.size() ? std::min(keyframes_[i + 1], playhead_) : playhead_;
+        return true;
+      }
+    }
+    cv_.wait(lock);
+  }
+}
+
+void ReverseDecoder::workerLoop(unsigned /*id*/) {
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(
+    "filesrc name=src ! decodebin name=dbin ! videoconvert ! videoscale ! "
+    "capsfilter name=cf ! appsink name=out sync=false", &err);
+  if (!pipe) {
+    if (err) g_error_free(err);
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = true;
+    cv_.notify_all();
+    return;
+  }
+  GstElement* src = gst_bin_get_by_name(GST_BIN(pipe), "src");
+  GstElement* dbin = gst_bin_get_by_name(GST_BIN(pipe), "dbin");
+  GstElement* cf = gst_bin_get_by_name(GST_BIN(pipe), "cf");
+  GstElement* out = gst_bin_get_by_name(GST_BIN(pipe), "out");
+  g_object_set(src, "location", location_.c_str(), NULL);
+  g_object_set(cf, "caps", caps_, NULL);
+  g_signal_connect(dbin, "autoplug-continue", G_CALLBACK(&skipAudio), nullptr);
+  g_signal_connect(dbin, "element-added", G_CALLBACK(&limitDecoderThreads), GUINT_TO_POINTER(decoderThreads_));
+  gst_object_unref(cf);
+  gst_object_unref(dbin);
+  gst_object_unref(src);
+
+  GstBus* bus = gst_element_get_bus(pipe);
+  gst_element_set_state(pipe, GST_STATE_PAUSED);
+  bool ok = gst_element_get_state(pipe, nullptr, nullptr, 10 * GST_SECOND) == GST_STATE_CHANGE_SUCCESS;
+  bool playing = false;
+  GstClockTime start = 0, stop = 0;
+  while (ok && nextGop(start, stop)) {
+    const auto t0 = std::chrono::steady_clock::now();
+    gst_element_seek(pipe, 1.0, GST_FORMAT_TIME, (GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                     GST_SEEK_TYPE_SET, gint64(start),
+                     GST_CLOCK_TIME_IS_VALID(stop) ? GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE, gint64(stop));
+    if (!playing) {
+      gst_element_set_state(pipe, GST_STATE_PLAYING);
+      playing = true;
+    }
+    bool eos = false, error = false, cancelled = false;
+    uint64_t count = 0;
+    while (!eos && !error) {
+      GstSample* sample = pullSample(out, bus, eos, error);
+      if (!sample) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !scheduled_.count(start)) {
+          cancelled = true;
+          break;
+        }
+        continue;
+      }
+      GstBuffer* buf = gst_sample_get_buffer(sample);
+      const GstClockTime pts = buf ? GST_BUFFER_PTS(buf) : GST_CLOCK_TIME_NONE;
+      if (GST_CLOCK_TIME_IS_VALID(pts)) {
+        // Deep copy: the decoder's pool is bounded and we hold frames for a while
+        GstBuffer* copy = gst_buffer_copy_deep(buf);
+        GstSample* kept = gst_sample_new(copy, gst_sample_get_caps(sample), nullptr, nullptr);
+        gst_buffer_unref(copy);
+        const size_t size = gst_buffer_get_size(buf);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pts < playhead_ && frames_.emplace(pts, kept).second) {
+          bytes_ += size;
+          count++;
+        } else {
+          gst_sample_unref(kept);
+        }
+      }
+      gst_sample_unref(sample);
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error) {
+      failed_ = true;
+      ok = false;
+    }
+    if (!cancelled && !error && scheduled_.count(start)) {
+      done_.insert(start);
+      gops_++;
+      decodedFrames_ += count;
+      gopMsTotal_ += ms;
+    }
+    cv_.notify_all();
+  }
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(out);
+  gst_object_unref(bus);
+  gst_object_unref(pipe);
+  if (!ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = true;
+    cv_.notify_all();
+  }
+}
+
+GstSample* ReverseDecoder::frameBefore(GstClockTime pts) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t idx = 0;
+  // Only serve from a finished GOP; a later GOP finishing first must not
+  // make us skip frames
+  if (!gopBelowLocked(pts, idx) || !done_.count(keyframes_[idx])) return nullptr;
+  auto it = frames_.lower_bound(pts);
+  if (it == frames_.begin()) return nullptr;
+  --it;
+  return gst_sample_ref(it->second);
+}
+
+void ReverseDecoder::dropFromLocked(GstClockTime pts) {
+  for (auto it = frames_.lower_bound(pts); it != frames_.end();) {
+    bytes_ -= gst_buffer_get_size(gst_sample_get_buffer(it->second));
+    gst_sample_unref(it->second);
+    it = frames_.erase(it);
+  }
+  scheduled_.erase(scheduled_.lower_bound(pts), scheduled_.end());
+  done_.erase(done_.lower_bound(pts), done_.end());
+}
+
+void ReverseDecoder::setPlayhead(GstClockTime pts) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    playhead_ = pts;
+    dropFromLocked(pts);
+  }
+  cv_.notify_all();
+}
+
+bool ReverseDecoder::exhausted(GstClockTime pts) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (failed_) return true;
+  if (!indexDone_) return false;
+  return keyframes_.empty() || keyframes_.front() >= pts ||
+         (done_.count(keyframes_.front()) && frames_.lower_bound(pts) == frames_.begin());
+}
+
+size_t ReverseDecoder::keyframes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keyframes_.size();
+}
+
+bool ReverseDecoder::indexComplete() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return indexDone_;
+}
+
+bool ReverseDecoder::failed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+uint64_t ReverseDecoder::gopsDecoded() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return gops_;
+}
+
+uint64_t ReverseDecoder::framesDecoded() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return decodedFrames_;
+}
+
+double ReverseDecoder::avgGopDecodeMs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return gops_ ? gopMsTotal_ / double(gops_) : 0.0;
+}
+
+size_t ReverseDecoder::bufferedFrames() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frames_.size();
+}
@@ -0,0 +1,85 @@
+// File: src/reverse_decoder.h
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Reverse playback without negative-rate seeks. A parse-only pass builds a
+// keyframe index; worker threads, each owning a private decode pipeline,
+// decode whole GOPs forward (seek to keyframe, stop at the next one) into a
+// frame store, scheduling the GOPs just below the playhead first. The caller
+// walks the store backwards at display rate.
+class ReverseDecoder {
+public:
+  ReverseDecoder() = default;
+  ~ReverseDecoder();
+  ReverseDecoder(const ReverseDecoder&) = delete;
+  ReverseDecoder& operator=(const ReverseDecoder&) = delete;
+
+  // outCaps pins the raw format/size so frames can be presented as-is.
+  // workers == 0 picks from the core count; budgetBytes bounds decoded-ahead
+  // frames (the GOP under the playhead is always decoded).
+  bool start(const std::string& location, GstCaps* outCaps, GstClockTime playhead,
+             unsigned workers, size_t budgetBytes);
+  void stop();
+  bool running() const { return !threads_.empty(); }
+
+  // Closest decoded frame strictly before pts (ref'd), nullptr if not ready
+  GstSample* frameBefore(GstClockTime pts);
+  // Frames at or after pts were shown: release them and schedule further back
+  void setPlayhead(GstClockTime pts);
+  // True once everything down to the first keyframe has been handed out
+  bool exhausted(GstClockTime pts) const;
+
+  unsigned workers() const { return workerCount_; }
+  size_t   keyframes() const;
+  bool     indexComplete() const;
+  bool     failed() const;
+  uint64_t gopsDecoded() const;
+  uint64_t framesDecoded() const;
+  double   avgGopDecodeMs() const;
+  size_t   bufferedFrames() const;
+
+private:
+  void indexLoop();
+  void workerLoop(unsigned id);
+  // Picks the next GOP to decode; false on shutdown
+  bool nextGop(GstClockTime& start, GstClockTime& stop);
+  // Keyframe starting the GOP that holds the frames just below pts; false
+  // while the index does not reach pts yet
+  bool gopBelowLocked(GstClockTime pts, size_t& idx) const;
+  void dropFromLocked(GstClockTime pts);
+
+  std::string location_;
+  GstCaps*    caps_{nullptr};
+  unsigned    workerCount_{0};
+  unsigned    maxAhead_{0};
+  unsigned    decoderThreads_{1};
+  size_t      budget_{0};
+  std::vector<std::thread> threads_;
+  std::thread indexThread_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_{false};
+  bool indexDone_{false};
+  std::vector<GstClockTime> keyframes_;          // ascending
+  std::set<GstClockTime> scheduled_;             // GOP starts handed to workers
+  std::set<GstClockTime> done_;                  // GOP starts fully decoded
+  std::map<GstClockTime, GstSample*> frames_;    // decoded, pts → sample
+  size_t   bytes_{0};
+  bool     failed_{false};
+  GstClockTime playhead_{GST_CLOCK_TIME_NONE};
+  uint64_t gops_{0};
+  uint64_t decodedFrames_{0};
+  double   gopMsTotal_{0.0};
+};
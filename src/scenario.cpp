@@ -0,0 +1,144 @@
+// File: src/scenario.cpp
+#include "scenario.h"
+#include "percentile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+bool parseTime(const std::string& token, int64_t& ms, bool& relative) {
+  std::string t = token;
+  relative = !t.empty() && t[0] == '+';
+  if (relative) t.erase(0, 1);
+  double scale = 1.0;
+  if (t.size() > 2 && t.compare(t.size() - 2, 2, "ms") == 0) {
+    t.resize(t.size() - 2);
+  } else if (t.size() > 1 && t.back() == 's') {
+    t.pop_back();
+    scale = 1000.0;
+  }
+  if (t.empty()) return false;
+  char* end = nullptr;
+  const double v = std::strtod(t.c_str(), &end);
+  if (*end || !std::isfinite(v) || v < 0) return false;
+  ms = int64_t(std::llround(v * scale));
+  return true;
+}
+
+bool parseNumber(const std::string& token, double& value) {
+  char* end = nullptr;
+  value = std::strtod(token.c_str(), &end);
+  return !token.empty() && !*end && std::isfinite(value);
+}
+
+}  // namespace
+
+const char* scenarioOpName(ScenarioOp op) {
+  switch (op) {
+    case ScenarioOp::Play:    return "play";
+    case ScenarioOp::Pause:   return "pause";
+    case ScenarioOp::Seek:    return "seek";
+    case ScenarioOp::Quality: return "quality";
+    case ScenarioOp::Rate:    return "rate";
+    case ScenarioOp::Open:    return "open";
+    case ScenarioOp::End:     return "end";
+  }
+  return "?";
+}
+
+bool parseScenario(const std::string& text, std::vector<ScenarioAction>& actions, std::string& error) {
+  actions.clear();
+  std::istringstream in(text);
+  std::string raw;
+  int lineNo = 0;
+  int64_t lastAbsolute = 0;
+  const auto fail = [&error, &lineNo](const std::string& what) {
+    error = "line " + std::to_string(lineNo) + ": " + what;
+    return false;
+  };
+  while (std::getline(in, raw)) {
+    lineNo++;
+    const size_t hash = raw.find('#');
+    if (hash != std::string::npos) raw.resize(hash);
+    std::istringstream fields(raw);
+    std::vector<std::string> tok;
+    for (std::string f; fields >> f;) tok.push_back(f);
+    if (tok.empty()) continue;
+    if (tok.size() < 2) return fail("expected '<time> <action> [args]'");
+    ScenarioAction a;
+    a.line = lineNo;
+    if (!parseTime(tok[0], a.atMs, a.relative)) return fail("bad time '" + tok[0] + "'");
+    if (!a.relative) {
+      if (a.atMs < lastAbsolute) return fail("time goes backwards");
+      lastAbsolute = a.atMs;
+    }
+    const std::string& op = tok[1];
+    const size_t args = tok.size() - 2;
+    if (op == "play" && args == 0) {
+      a.op = ScenarioOp::Play;
+    } else if (op == "pause" && args <= 1) {
+      a.op = ScenarioOp::Pause;
+      double hold = 0.0;
+      if (args == 1 && (!parseNumber(tok[2], hold) || hold < 0)) return fail("pause hold must be >= 0 ms");
+      a.holdMs = int(hold);
+    } else if (op == "seek" && (args == 1 || args == 2)) {
+      a.op = ScenarioOp::Seek;
+      if (!parseNumber(tok[2], a.value) || a.value < 0) return fail("seek needs a position >= 0 (seconds)");
+      if (args == 2 && tok[3] != "accurate") return fail("seek takes only 'accurate' after the position");
+      a.flag = args == 2;
+    } else if (op == "quality" && args == 1 && (tok[2] == "low" || tok[2] == "high" || tok[2] == "toggle")) {
+      a.op = ScenarioOp::Quality;
+      a.arg = tok[2];
+    } else if (op == "rate" && args == 1) {
+      a.op = ScenarioOp::Rate;
+      if (!parseNumber(tok[2], a.value) || a.value <= 0) return fail("rate must be > 0");
+    } else if (op == "open" && args >= 1) {
+      a.op = ScenarioOp::Open;
+      // Paths may contain spaces: everything after the action
+      const size_t at = raw.find(tok[2], raw.find(tok[1]) + tok[1].size());
+      a.arg = raw.substr(at);
+      a.arg.erase(a.arg.find_last_not_of(" \t\r") + 1);
+    } else if (op == "end" && args == 0) {
+      a.op = ScenarioOp::End;
+    } else {
+      return fail("unknown action or wrong arguments: '" + op + "'");
+    }
+    actions.push_back(a);
+  }
+  if (actions.empty()) {
+    error = "no actions";
+    return false;
+  }
+  return true;
+}
+
+std::vector<ScenarioSummary> summarizeScenario(const std::vector<ScenarioResult>& results) {
+  std::vector<ScenarioSummary> out;
+  for (int op = int(ScenarioOp::Play); op < int(ScenarioOp::End); ++op) {
+    ScenarioSummary s{ScenarioOp(op)};
+    std::vector<double> latencies;
+    for (const ScenarioResult& r : results) {
+      if (r.action.op != s.op) continue;
+      s.count++;
+      if (r.status == "same-size") {
+        s.sameSize++;
+        continue;
+      }
+      if (r.status != "ok") {
+        s.failed++;
+        continue;
+      }
+      latencies.push_back(r.latencyMs);
+      s.maxGap = std::max(s.maxGap, r.maxGapMs);
+    }
+    if (!s.count) continue;
+    s.q50 = percentile(latencies, 50.0);
+    s.q95 = percentile(latencies, 95.0);
+    s.max = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+    out.push_back(s);
+  }
+  return out;
+}
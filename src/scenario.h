@@ -0,0 +1,69 @@
+// File: src/scenario.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scenario files: one timed action per line, '#' starts a comment.
+//
+//   <time> <action> [args]
+//
+// <time> is milliseconds from the start of the run ("1500", "2s") or, with a
+// leading '+', after the previous action's measurement completed ("+500").
+// Absolute times must not go backwards. Actions run strictly one after
+// another; one that comes due while the previous is still being measured
+// waits, and its lateness is recorded.
+//
+//   play                      latency: first frame at the sink (TTFF)
+//   pause [hold-ms]           pause settled; with hold-ms, resumes after the
+//                             hold and measures request → first frame
+//   seek <seconds> [accurate] request → first frame of the new segment
+//   quality low|high|toggle   request → first frame at the new size, plus
+//                             the longest frame gap meanwhile ("same-size",
+//                             left out of the latency quantiles, when the
+//                             output size doesn't change)
+//   rate <r>                  request → first frame of the new segment
+//   open <path>               request → first frame of the new file
+//   end                       stops the run (optional)
+enum class ScenarioOp { Play, Pause, Seek, Quality, Rate, Open, End };
+const char* scenarioOpName(ScenarioOp op);
+
+struct ScenarioAction {
+  int64_t     atMs{0};
+  bool        relative{false};
+  ScenarioOp  op{ScenarioOp::Play};
+  double      value{0.0};    // seek seconds, rate
+  int         holdMs{0};     // pause hold
+  bool        flag{false};   // seek: accurate
+  std::string arg;           // quality level, open path
+  int         line{0};
+};
+
+// False with "line N: ..." in error on the first malformed line
+bool parseScenario(const std::string& text, std::vector<ScenarioAction>& actions, std::string& error);
+
+struct ScenarioResult {
+  size_t         index{0};
+  ScenarioAction action;
+  int64_t        scheduledMs{0};
+  int64_t        issuedMs{0};
+  double         latencyMs{-1.0};
+  double         maxGapMs{0.0};    // quality: longest time without a frame
+  std::string    status;           // ok, same-size, timeout, error: ...
+};
+
+struct ScenarioSummary {
+  ScenarioOp op;
+  size_t count{0};
+  size_t failed{0};     // anything but ok / same-size
+  size_t sameSize{0};   // quality switches that kept the output size: not timed
+  double q50{0.0};
+  double q95{0.0};
+  double max{0.0};
+  double maxGap{0.0};
+};
+
+// Per action kind, in ScenarioOp order; kinds that never ran are left out
+std::vector<ScenarioSummary> summarizeScenario(const std::vector<ScenarioResult>& results);
@@ -0,0 +1,125 @@
+// File: src/soak_monitor.cpp
+#include "soak_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// NaN when the sample has no value for the series
+double valueOf(const SoakSample& s, SoakSeries series) {
+  switch (series) {
+    case SoakSeries::Rss:         return double(s.rssBytes) / (1024.0 * 1024.0);
+    case SoakSeries::Fds:         return s.fds > 0 ? double(s.fds) : NAN;
+    case SoakSeries::Threads:     return s.threads > 0 ? double(s.threads) : NAN;
+    case SoakSeries::IntervalQ95: return s.intervalQ95Ms > 0.0 ? s.intervalQ95Ms : NAN;
+    case SoakSeries::Drift:       return std::fabs(s.driftMs);
+    case SoakSeries::Count:       break;
+  }
+  return NAN;
+}
+
+// Growth below this is noise: allocator slack, a pool thread coming and
+// going, one slow frame, a frame of drift
+double thresholdFor(SoakSeries series, double first) {
+  switch (series) {
+    case SoakSeries::Rss:         return std::max(16.0, first * 0.05);   // MB
+    case SoakSeries::Fds:         return 8.0;
+    case SoakSeries::Threads:     return 4.0;
+    case SoakSeries::IntervalQ95: return std::max(4.0, first * 0.25);    // ms
+    case SoakSeries::Drift:       return 40.0;                            // ms
+    case SoakSeries::Count:       break;
+  }
+  return 0.0;
+}
+
+}  // namespace
+
+const char* soakSeriesName(SoakSeries series) {
+  switch (series) {
+    case SoakSeries::Rss:         return "rss-mb";
+    case SoakSeries::Fds:         return "fds";
+    case SoakSeries::Threads:     return "threads";
+    case SoakSeries::IntervalQ95: return "interval-q95-ms";
+    case SoakSeries::Drift:       return "av-drift-ms";
+    case SoakSeries::Count:       break;
+  }
+  return "?";
+}
+
+std::vector<SoakSeries> SoakMonitor::add(const SoakSample& sample) {
+  samples_.push_back(sample);
+  std::vector<SoakSeries> raised;
+  for (size_t i = 0; i < size_t(SoakSeries::Count); ++i) {
+    if (flagged_[i]) continue;
+    if (trend(SoakSeries(i)).flagged) {
+      flagged_[i] = true;
+      raised.push_back(SoakSeries(i));
+    }
+  }
+  return raised;
+}
+
+SoakTrend SoakMonitor::trend(SoakSeries series) const {
+  SoakTrend t;
+  t.series = series;
+  std::vector<double> xs, ys;
+  for (size_t i = std::min(kWarmupSamples, samples_.size()); i < samples_.size(); ++i) {
+    const double y = valueOf(samples_[i], series);
+    if (std::isnan(y)) continue;
+    xs.push_back(samples_[i].elapsedS);
+    ys.push_back(y);
+  }
+  t.samples = ys.size();
+  t.flagged = flagged_[size_t(series)];
+  if (ys.empty()) return t;
+  t.first = ys.front();
+  t.last = ys.back();
+  if (ys.size() < 2) return t;
+
+  // Kendall's tau-a against sample order (the x values are increasing)
+  const size_t n = ys.size();
+  long long concordance = 0;
+  for (size_t i = 0; i + 1 < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      concordance += (ys[j] > ys[i]) - (ys[j] < ys[i]);
+    }
+  }
+  t.tau = double(concordance) / (double(n) * double(n - 1) / 2.0);
+
+  double mx = 0.0, my = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    mx += xs[i];
+    my += ys[i];
+  }
+  mx /= double(n);
+  my /= double(n);
+  double sxy = 0.0, sxx = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    sxy += (xs[i] - mx) * (ys[i] - my);
+    sxx += (xs[i] - mx) * (xs[i] - mx);
+  }
+  t.growth = sxx > 0.0 ? sxy / sxx * (xs.back() - xs.front()) : 0.0;
+  t.flagged = t.flagged ||
+              (n >= kMinSamples && t.tau > 0.5 && t.growth > thresholdFor(series, t.first));
+  return t;
+}
+
+bool SoakMonitor::anyFlagged() const {
+  return std::any_of(std::begin(flagged_), std::end(flagged_), [](bool f) { return f; });
+}
+
+std::string SoakMonitor::csvHeader() {
+  return "elapsed_s,rss_mb,fds,threads,interval_q95_ms,av_drift_ms,frames,loops";
+}
+
+std::string SoakMonitor::csvLine(const SoakSample& s) {
+  char drift[32] = "";
+  if (!std::isnan(s.driftMs)) std::snprintf(drift, sizeof(drift), "%.1f", s.driftMs);
+  char line[256];
+  std::snprintf(line, sizeof(line), "%.0f,%.1f,%d,%d,%.1f,%s,%llu,%llu", s.elapsedS,
+                double(s.rssBytes) / (1024.0 * 1024.0), s.fds, s.threads, s.intervalQ95Ms, drift,
+                static_cast<unsigned long long>(s.frames), static_cast<unsigned long long>(s.loops));
+  return line;
+}
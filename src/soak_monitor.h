@@ -0,0 +1,57 @@
+// File: src/soak_monitor.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One soak-mode sample, taken about once a minute while the clip loops
+struct SoakSample {
+  double   elapsedS{0.0};
+  uint64_t rssBytes{0};
+  int      fds{0};
+  int      threads{0};
+  double   intervalQ95Ms{0.0};   // wall-clock gap between sink frames this interval
+  double   driftMs{0.0};         // video behind the pipeline (audio) clock; NaN when unknown
+  uint64_t frames{0};            // sink frames since the soak started
+  uint64_t loops{0};             // completed clip passes
+};
+
+enum class SoakSeries { Rss, Fds, Threads, IntervalQ95, Drift, Count };
+const char* soakSeriesName(SoakSeries series);
+
+struct SoakTrend {
+  SoakSeries series{SoakSeries::Rss};
+  size_t samples{0};        // after the warm-up
+  double tau{0.0};          // Kendall rank correlation with time, -1..1
+  double growth{0.0};       // least-squares slope times the span, in series units
+  double first{0.0};
+  double last{0.0};
+  bool   flagged{false};
+};
+
+// Collects soak samples and looks for steady growth: a series is flagged when
+// it rises with time (Kendall tau above 0.5) by more than its noise
+// threshold over the samples after the warm-up. Resident memory, descriptors
+// and threads flag leaks; frame-interval q95 and |A/V drift| flag gradual
+// degradation. Flags latch for the rest of the run.
+class SoakMonitor {
+public:
+  static constexpr size_t kWarmupSamples = 5;   // caches and pools fill up first
+  static constexpr size_t kMinSamples = 10;
+
+  // Returns the series flagged for the first time by this sample
+  std::vector<SoakSeries> add(const SoakSample& sample);
+  SoakTrend trend(SoakSeries series) const;
+  bool anyFlagged() const;
+  const std::vector<SoakSample>& samples() const { return samples_; }
+
+  // Time-series file: a header line, then one CSV line per sample
+  static std::string csvHeader();
+  static std::string csvLine(const SoakSample& sample);
+
+private:
+  std::vector<SoakSample> samples_;
+  bool flagged_[size_t(SoakSeries::Count)]{};
+};
@@ -0,0 +1,272 @@
+// File: src/thread_policy.cpp
+#include "thread_policy.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define THREAD_POLICY_PTHREAD 1
+#endif
+
+namespace {
+constexpr long kMaxCpus = 1024;
+const char* const kRoleNames[kThreadRoleCount] = {"demux", "decode", "vrender", "arender"};
+
+bool parseCpus(const std::string& text, std::vector<int>& cpus) {
+  std::stringstream ss(text);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) return false;
+    char* end = nullptr;
+    const long first = std::strtol(item.c_str(), &end, 10);
+    long last = first;
+    if (*end == '-') last = std::strtol(end + 1, &end, 10);
+    if (*end || first < 0 || last < first || last >= kMaxCpus) return false;
+    for (long c = first; c <= last; c++) cpus.push_back(int(c));
+  }
+  return !cpus.empty();
+}
+
+bool parsePriority(const std::string& text, RolePolicy& policy) {
+  char* end = nullptr;
+  if (text.rfind("nice", 0) == 0) {
+    const long v = std::strtol(text.c_str() + 4, &end, 10);
+    if (*end || v < -20 || v > 19) return false;
+    policy.hasNice = true;
+    policy.nice = int(v);
+    return true;
+  }
+  if (text.rfind("fifo", 0) == 0) {
+    const long v = std::strtol(text.c_str() + 4, &end, 10);
+    if (*end || v < 1 || v > 99) return false;
+    policy.fifo = int(v);
+    return true;
+  }
+  return false;
+}
+}  // namespace
+
+const char* threadRoleName(ThreadRole role) {
+  return role == ThreadRole::Other ? "other" : kRoleNames[int(role)];
+}
+
+#ifdef THREAD_POLICY_PTHREAD
+// GstTaskPool that runs every pushed task on its own pthread, configured
+// from inside the thread before the task function starts.
+struct PinnedTaskPool {
+  GstTaskPool parent;
+  RolePolicy* policy;
+  ThreadPolicyStats* stats;
+  const char* role;
+  gint counter;
+};
+
+struct PinnedTaskPoolClass {
+  GstTaskPoolClass parent_class;
+};
+
+G_DEFINE_TYPE(PinnedTaskPool, pinned_task_pool, GST_TYPE_TASK_POOL)
+
+namespace {
+struct PinnedJob {
+  PinnedTaskPool* pool;
+  GstTaskPoolFunction func;
+  gpointer data;
+};
+
+void configureThread(PinnedTaskPool* pool) {
+  const RolePolicy& policy = *pool->policy;
+  ThreadPolicyStats& stats = *pool->stats;
+  stats.threads++;
+  char name[16];
+  std::snprintf(name, sizeof(name), "%s:%d", pool->role, g_atomic_int_add(&pool->counter, 1));
+  pthread_setname_np(pthread_self(), name);
+  if (!policy.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : policy.cpus) CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) stats.pinned++;
+    else stats.affinityFailed++;
+  }
+  if (policy.fifo > 0) {
+    sched_param param{};
+    param.sched_priority = policy.fifo;
+    // Needs CAP_SYS_NICE or an RLIMIT_RTPRIO grant; stay SCHED_OTHER otherwise
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) stats.fifoDenied++;
+  }
+  if (policy.hasNice) {
+    // Linux nice values are per thread
+    const id_t tid = id_t(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, policy.nice) != 0) stats.niceFailed++;
+  }
+}
+
+void* runPinnedJob(void* arg) {
+  auto* job = static_cast<PinnedJob*>(arg);
+  configureThread(job->pool);
+  job->func(job->data);
+  gst_object_unref(job->pool);
+  delete job;
+  return nullptr;
+}
+
+void pinnedPrepare(GstTaskPool*, GError**) {}
+void pinnedCleanup(GstTaskPool*) {}
+
+gpointer pinnedPush(GstTaskPool* pool, GstTaskPoolFunction func, gpointer data, GError** error) {
+  auto* job = new PinnedJob{reinterpret_cast<PinnedTaskPool*>(gst_object_ref(pool)), func, data};
+  auto* tid = g_new0(pthread_t, 1);
+  const int rc = pthread_create(tid, nullptr, runPinnedJob, job);
+  if (rc != 0) {
+    g_set_error(error, G_THREAD_ERROR, G_THREAD_ERROR_AGAIN, "pthread_create: %s", g_strerror(rc));
+    gst_object_unref(pool);
+    delete job;
+    g_free(tid);
+    return nullptr;
+  }
+  return tid;
+}
+
+void pinnedJoin(GstTaskPool*, gpointer id) {
+  auto* tid = static_cast<pthread_t*>(id);
+  pthread_join(*tid, nullptr);
+  g_free(tid);
+}
+
+void pinnedFinalize(GObject* object) {
+  delete reinterpret_cast<PinnedTaskPool*>(object)->policy;
+  G_OBJECT_CLASS(pinned_task_pool_parent_class)->finalize(object);
+}
+}  // namespace
+
+static void pinned_task_pool_class_init(PinnedTaskPoolClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = pinnedFinalize;
+  GstTaskPoolClass* pool = GST_TASK_POOL_CLASS(klass);
+  pool->prepare = pinnedPrepare;
+  pool->cleanup = pinnedCleanup;
+  pool->push = pinnedPush;
+  pool->join = pinnedJoin;
+}
+
+static void pinned_task_pool_init(PinnedTaskPool*) {}
+#endif
+
+ThreadPolicy::~ThreadPolicy() {
+  for (auto*& pool : pools_) {
+    if (pool) gst_object_unref(pool);
+    pool = nullptr;
+  }
+}
+
+bool ThreadPolicy::parse(const std::string& spec, std::string& error) {
+  for (auto& role : roles_) role = RolePolicy{};
+  active_ = false;
+  if (spec.empty()) return true;
+  if (spec == "names") {
+    active_ = true;
+    return true;
+  }
+  std::stringstream ss(spec);
+  std::string entry;
+  while (std::getline(ss, entry, ';')) {
+    if (entry.empty()) continue;
+    const size_t colon = entry.find(':');
+    const std::string role = entry.substr(0, colon);
+    int idx = -1;
+    for (int i = 0; i < kThreadRoleCount; i++) {
+      if (role == kRoleNames[i]) idx = i;
+    }
+    if (idx < 0) {
+      error = "unknown thread role '" + role + "'";
+      return false;
+    }
+    if (colon == std::string::npos) continue;   // named only
+    const std::string rest = entry.substr(colon + 1);
+    const size_t at = rest.find('@');
+    RolePolicy policy;
+    const std::string cpus = rest.substr(0, at);
+    if (!cpus.empty() && !parseCpus(cpus, policy.cpus)) {
+      error = "bad cpu list '" + cpus + "' for " + role;
+      return false;
+    }
+    if (at != std::string::npos && !parsePriority(rest.substr(at + 1), policy)) {
+      error = "bad priority '" + rest.substr(at + 1) + "' for " + role + " (niceN or fifoN)";
+      return false;
+    }
+    roles_[idx] = policy;
+  }
+  active_ = true;
+  return true;
+}
+
+std::string ThreadPolicy::describe() const {
+  if (!active_) return "default";
+  std::ostringstream out;
+  for (int i = 0; i < kThreadRoleCount; i++) {
+    const RolePolicy& p = roles_[i];
+    if (i) out << ' ';
+    out << kRoleNames[i] << '=';
+    if (p.cpus.empty()) {
+      out << '*';
+    } else {
+      for (size_t c = 0; c < p.cpus.size(); c++) out << (c ? "," : "") << p.cpus[c];
+    }
+    if (p.fifo) out << "@fifo" << p.fifo;
+    else if (p.hasNice) out << "@nice" << p.nice;
+  }
+  return out.str();
+}
+
+GstTaskPool* ThreadPolicy::poolFor(ThreadRole role) {
+#ifdef THREAD_POLICY_PTHREAD
+  if (role == ThreadRole::Other) return nullptr;
+  GstTaskPool*& pool = pools_[int(role)];
+  if (!pool) {
+    auto* pinned = static_cast<PinnedTaskPool*>(g_object_new(pinned_task_pool_get_type(), nullptr));
+    gst_object_ref_sink(pinned);
+    pinned->policy = new RolePolicy(roles_[int(role)]);
+    pinned->stats = &stats_;
+    pinned->role = kRoleNames[int(role)];
+    pool = GST_TASK_POOL(pinned);
+  }
+  return pool;
+#else
+  (void)role;
+  return nullptr;
+#endif
+}
+
+bool ThreadPolicy::install(GstMessage* msg, ThreadRole role) {
+  if (!active_ || GST_MESSAGE_TYPE(msg) != GST_MESSAGE_STREAM_STATUS) return false;
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(msg, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_CREATE) return false;
+  const GValue* value = gst_message_get_stream_status_object(msg);
+  if (!value || G_VALUE_TYPE(value) != GST_TYPE_TASK) return false;
+  GstTaskPool* pool = poolFor(role);
+  if (!pool) return false;
+  gst_task_set_pool(GST_TASK(g_value_get_object(value)), pool);
+  return true;
+}
+
+ThreadRole classifyTaskOwner(GstElement* owner, GstElement* decodebin,
+                             GstElement* videoQueue, GstElement* audioQueue) {
+  if (!owner) return ThreadRole::Other;
+  if (owner == videoQueue) return ThreadRole::VideoRender;
+  if (owner == audioQueue) return ThreadRole::AudioRender;
+  if (decodebin && gst_object_has_as_ancestor(GST_OBJECT(owner), GST_OBJECT(decodebin))) {
+    GstElementFactory* factory = gst_element_get_factory(owner);
+    const char* name = factory ? GST_OBJECT_NAME(factory) : "";
+    return g_str_equal(name, "multiqueue") ? ThreadRole::Decode : ThreadRole::Demux;
+  }
+  if (GST_OBJECT_FLAG_IS_SET(owner, GST_ELEMENT_FLAG_SOURCE)) return ThreadRole::Demux;
+  return ThreadRole::Other;
+}
@@ -0,0 +1,68 @@
+// File: src/thread_policy.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+
+// Streaming-thread roles as seen from STREAM_STATUS task owners
+enum class ThreadRole { Demux, Decode, VideoRender, AudioRender, Other };
+constexpr int kThreadRoleCount = 4;   // roles that get a pool (Other keeps the default)
+const char* threadRoleName(ThreadRole role);
+
+struct RolePolicy {
+  std::vector<int> cpus;   // empty: no pinning
+  bool hasNice{false};
+  int  nice{0};
+  int  fifo{0};            // SCHED_FIFO priority, 0 = keep SCHED_OTHER
+};
+
+struct ThreadPolicyStats {
+  std::atomic<uint64_t> threads{0};
+  std::atomic<uint64_t> pinned{0};
+  std::atomic<uint64_t> affinityFailed{0};
+  std::atomic<uint64_t> niceFailed{0};
+  std::atomic<uint64_t> fifoDenied{0};
+};
+
+// Per-role GstTaskPools that start streaming threads pinned, with the
+// requested nice/SCHED_FIFO (falling back silently when not permitted) and
+// named "<role>:<n>" for profilers. Installed from a synchronous
+// STREAM_STATUS (CREATE) handler. Linux only; elsewhere install() is a no-op.
+//
+// Spec: "role:cpus@prio;..." with role demux|decode|vrender|arender,
+// cpus like "0,2-3", prio like "nice-5" or "fifo10". "names" alone only
+// names threads. Example: "demux:0;decode:2-5@nice-5;vrender:1@fifo10".
+class ThreadPolicy {
+public:
+  ThreadPolicy() = default;
+  ~ThreadPolicy();
+  ThreadPolicy(const ThreadPolicy&) = delete;
+  ThreadPolicy& operator=(const ThreadPolicy&) = delete;
+
+  bool parse(const std::string& spec, std::string& error);
+  bool active() const { return active_; }
+  std::string describe() const;
+
+  // Call from a sync bus handler; returns true when a pool was installed
+  bool install(GstMessage* msg, ThreadRole role);
+
+  const ThreadPolicyStats& stats() const { return stats_; }
+
+private:
+  GstTaskPool* poolFor(ThreadRole role);
+
+  bool active_{false};
+  RolePolicy roles_[kThreadRoleCount];
+  GstTaskPool* pools_[kThreadRoleCount]{};
+  ThreadPolicyStats stats_;
+};
+
+// Maps a task owner to a role: the given queues are render threads,
+// multiqueue inside decodebin runs parsers + decoders, any other task
+// inside decodebin (demuxer, typefind) or a source element is demux.
+ThreadRole classifyTaskOwner(GstElement* owner, GstElement* decodebin,
+                             GstElement* videoQueue, GstElement* audioQueue);
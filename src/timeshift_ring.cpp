@@ -0,0 +1,200 @@
+// File: src/timeshift_ring.cpp
+#include "timeshift_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define TIMESHIFT_MMAP 1
+#endif
+
+namespace {
+// One index entry per write is plenty for ms-accurate seeks, but cap the
+// density so tiny UDP packets don't bloat the index.
+constexpr size_t kMinIndexStride = 16 * 1024;
+}  // namespace
+
+TimeshiftRing::~TimeshiftRing() {
+  close();
+}
+
+bool TimeshiftRing::open(size_t capacity, const std::string& path) {
+  close();
+  if (capacity == 0) return false;
+#ifdef TIMESHIFT_MMAP
+  void* mem = MAP_FAILED;
+  if (path.empty()) {
+    mem = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    anonymous_ = true;
+  } else {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd_ < 0) return false;
+    if (ftruncate(fd_, off_t(capacity)) != 0) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    mem = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    anonymous_ = false;
+  }
+  if (mem == MAP_FAILED) {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  base_ = static_cast<uint8_t*>(mem);
+#else
+  (void)path;
+  base_ = new (std::nothrow) uint8_t[capacity];
+  if (!base_) return false;
+#endif
+  capacity_ = capacity;
+  std::lock_guard<std::mutex> lock(mutex_);
+  head_ = 0;
+  eos_ = false;
+  cancelled_ = false;
+  overruns_ = 0;
+  index_.clear();
+  return true;
+}
+
+void TimeshiftRing::close() {
+  cancelReads();
+  if (!base_) return;
+#ifdef TIMESHIFT_MMAP
+  munmap(base_, capacity_);
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+#else
+  delete[] base_;
+#endif
+  base_ = nullptr;
+  capacity_ = 0;
+}
+
+void TimeshiftRing::write(const uint8_t* data, size_t len, int64_t arrivalNs) {
+  if (!base_ || !len) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (len > capacity_) {
+    // Only the tail of an oversized write survives
+    data += len - capacity_;
+    head_ += len - capacity_;
+    len = capacity_;
+  }
+  const size_t off = size_t(head_ % capacity_);
+  const size_t first = std::min(len, capacity_ - off);
+  std::memcpy(base_ + off, data, first);
+  if (first < len) std::memcpy(base_, data + first, len - first);
+  if (index_.empty() || head_ - index_.back().pos >= kMinIndexStride) {
+    index_.push_back({arrivalNs, head_});
+  }
+  head_ += len;
+  pruneIndexLocked();
+  dataCv_.notify_all();
+}
+
+void TimeshiftRing::markEos() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  eos_ = true;
+  dataCv_.notify_all();
+}
+
+size_t TimeshiftRing::read(uint64_t& pos, uint8_t* out, size_t max, int timeoutMs) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!base_) return 0;
+  const auto ready = [&] { return cancelled_ || eos_ || pos < head_; };
+  if (!ready()) {
+    dataCv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+  }
+  if (cancelled_ || pos >= head_) return 0;
+  const uint64_t oldest = head_ > capacity_ ? head_ - capacity_ : 0;
+  if (pos < oldest) {
+    pos = oldest;
+    overruns_++;
+  }
+  const size_t len = size_t(std::min<uint64_t>(max, head_ - pos));
+  const size_t off = size_t(pos % capacity_);
+  const size_t first = std::min(len, capacity_ - off);
+  std::memcpy(out, base_ + off, first);
+  if (first < len) std::memcpy(out + first, base_, len - first);
+  pos += len;
+  return len;
+}
+
+void TimeshiftRing::cancelReads() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = true;
+  dataCv_.notify_all();
+}
+
+void TimeshiftRing::resumeReads() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = false;
+}
+
+bool TimeshiftRing::readsCancelled() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cancelled_;
+}
+
+uint64_t TimeshiftRing::oldest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return head_ > capacity_ ? head_ - capacity_ : 0;
+}
+
+uint64_t TimeshiftRing::head() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return head_;
+}
+
+bool TimeshiftRing::eos() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return eos_;
+}
+
+uint64_t TimeshiftRing::overruns() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return overruns_;
+}
+
+void TimeshiftRing::pruneIndexLocked() {
+  const uint64_t oldest = head_ > capacity_ ? head_ - capacity_ : 0;
+  // Keep one entry at or before oldest so early times still resolve
+  while (index_.size() > 1 && index_[1].pos <= oldest) {
+    index_.pop_front();
+  }
+}
+
+uint64_t TimeshiftRing::positionForTime(int64_t timeNs) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t oldest = head_ > capacity_ ? head_ - capacity_ : 0;
+  if (index_.empty()) return oldest;
+  const auto it = std::lower_bound(index_.begin(), index_.end(), timeNs,
+                                   [](const IndexEntry& e, int64_t t) { return e.timeNs < t; });
+  if (it == index_.end()) return head_;
+  return std::max(it->pos, oldest);
+}
+
+int64_t TimeshiftRing::timeForPosition(uint64_t pos) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.empty()) return 0;
+  const auto it = std::upper_bound(index_.begin(), index_.end(), pos,
+                                   [](uint64_t p, const IndexEntry& e) { return p < e.pos; });
+  return it == index_.begin() ? index_.front().timeNs : std::prev(it)->timeNs;
+}
+
+int64_t TimeshiftRing::oldestTime() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.empty() ? 0 : index_.front().timeNs;
+}
+
+int64_t TimeshiftRing::headTime() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.empty() ? 0 : index_.back().timeNs;
+}
@@ -0,0 +1,72 @@
+// File: src/timeshift_ring.h
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Bounded byte ring for timeshifting a compressed stream.
+// Positions are absolute byte counts since open(); the ring keeps the last
+// `capacity` bytes. Backed by a memory-mapped file (or anonymous memory when
+// no path is given). One writer thread, one reader thread.
+class TimeshiftRing {
+public:
+  TimeshiftRing() = default;
+  ~TimeshiftRing();
+  TimeshiftRing(const TimeshiftRing&) = delete;
+  TimeshiftRing& operator=(const TimeshiftRing&) = delete;
+
+  bool open(size_t capacity, const std::string& path = std::string());
+  void close();
+  bool isOpen() const { return base_ != nullptr; }
+
+  // Appends data received at arrivalNs (monotonic), overwriting the oldest bytes
+  void write(const uint8_t* data, size_t len, int64_t arrivalNs);
+  void markEos();
+
+  // Copies up to max bytes starting at pos. Waits up to timeoutMs for data
+  // when pos is at the head. Returns 0 on timeout/EOS/cancel; pos is moved
+  // forward to oldest() if it was overwritten.
+  size_t read(uint64_t& pos, uint8_t* out, size_t max, int timeoutMs);
+  void cancelReads();   // wake blocked readers (flush / shutdown)
+  void resumeReads();
+  bool readsCancelled() const;
+
+  uint64_t oldest() const;
+  uint64_t head() const;
+  bool     eos() const;
+  size_t   capacity() const { return capacity_; }
+
+  // Arrival-time index: first byte received at or after timeNs
+  uint64_t positionForTime(int64_t timeNs) const;
+  int64_t  timeForPosition(uint64_t pos) const;
+  int64_t  oldestTime() const;
+  int64_t  headTime() const;
+
+  uint64_t bytesWritten() const { return head(); }
+  uint64_t overruns() const;   // reads that lost data to the writer
+
+private:
+  struct IndexEntry {
+    int64_t  timeNs;
+    uint64_t pos;
+  };
+
+  void pruneIndexLocked();
+
+  uint8_t* base_{nullptr};
+  size_t   capacity_{0};
+  int      fd_{-1};
+  bool     anonymous_{true};
+
+  mutable std::mutex mutex_;
+  std::condition_variable dataCv_;
+  uint64_t head_{0};
+  bool     eos_{false};
+  bool     cancelled_{false};
+  uint64_t overruns_{0};
+  std::deque<IndexEntry> index_;
+};